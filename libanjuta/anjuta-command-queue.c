@@ -19,6 +19,8 @@
 
 #include "anjuta-command-queue.h"
 
+#include <unistd.h>
+
 enum
 {
 	FINISHED,
@@ -35,6 +37,10 @@ static guint anjuta_command_queue_signals[LAST_SIGNAL] = { 0 };
  *
  * #AnjutaCommandQueue always starts the next command in the queue when
  * the previous command finishes. That also works for asyncronous commands
+ *
+ * By default only one command is running at a time. Independent
+ * asynchronous commands can be run in parallel using
+ * anjuta_command_queue_set_max_running().
  */
 
 struct _AnjutaCommandQueuePriv
@@ -42,16 +48,25 @@ struct _AnjutaCommandQueuePriv
 	GQueue *queue;
 	gboolean busy;
 	AnjutaCommandQueueExecuteMode mode;
+
+	/* Running commands, a reference is kept on each one */
+	GList *running;
+	guint n_running;
+	guint max_running;
 };
 
 G_DEFINE_TYPE (AnjutaCommandQueue, anjuta_command_queue, G_TYPE_OBJECT);
 
+static void on_command_finished (AnjutaCommand *command, guint return_code,
+                                 AnjutaCommandQueue *self);
+
 static void
 anjuta_command_queue_init (AnjutaCommandQueue *self)
 {
 	self->priv = g_new0 (AnjutaCommandQueuePriv, 1);
 
 	self->priv->queue = g_queue_new ();
+	self->priv->max_running = 1;
 }
 
 static void
@@ -70,6 +85,16 @@ anjuta_command_queue_finalize (GObject *object)
 		current_command = g_list_next (current_command);
 	}
 
+	for (current_command = self->priv->running; current_command != NULL;
+	     current_command = g_list_next (current_command))
+	{
+		g_signal_handlers_disconnect_by_func (current_command->data,
+		                                      on_command_finished,
+		                                      self);
+		g_object_unref (current_command->data);
+	}
+	g_list_free (self->priv->running);
+
 	g_queue_free (self->priv->queue);
 	g_free (self->priv);
 
@@ -103,24 +128,60 @@ anjuta_command_queue_class_init (AnjutaCommandQueueClass *klass)
 }
 
 static void
-on_command_finished (AnjutaCommand *command, guint return_code,
-                     AnjutaCommandQueue *self)
+start_command (AnjutaCommandQueue *self, AnjutaCommand *command)
 {
-	AnjutaCommand *next_command;
+	g_signal_connect (G_OBJECT (command), "command-finished",
+	                  G_CALLBACK (on_command_finished),
+	                  self);
 
-	next_command = g_queue_pop_head (self->priv->queue);
+	self->priv->running = g_list_prepend (self->priv->running,
+	                                      g_object_ref (command));
+	self->priv->n_running++;
+	self->priv->busy = TRUE;
+
+	anjuta_command_start (command);
+}
 
-	if (next_command)
+/* Start waiting commands up to the maximum number of running commands */
+static gboolean
+start_next_commands (AnjutaCommandQueue *self)
+{
+	gboolean started = FALSE;
+
+	while (self->priv->n_running < self->priv->max_running)
 	{
-		g_signal_connect (G_OBJECT (next_command), "command-finished",
-		                  G_CALLBACK (on_command_finished),
-		                  self);
+		AnjutaCommand *next_command;
 
-		anjuta_command_start (next_command);
+		next_command = g_queue_pop_head (self->priv->queue);
+		if (next_command == NULL) break;
 
+		start_command (self, next_command);
 		g_object_unref (next_command);
+		started = TRUE;
 	}
-	else
+
+	return started;
+}
+
+static void
+on_command_finished (AnjutaCommand *command, guint return_code,
+                     AnjutaCommandQueue *self)
+{
+	GList *link;
+
+	g_signal_handlers_disconnect_by_func (command, on_command_finished, self);
+
+	link = g_list_find (self->priv->running, command);
+	if (link != NULL)
+	{
+		self->priv->running = g_list_delete_link (self->priv->running, link);
+		self->priv->n_running--;
+		g_object_unref (command);
+	}
+
+	start_next_commands (self);
+
+	if (self->priv->n_running == 0)
 	{
 		self->priv->busy = FALSE;
 
@@ -153,22 +214,10 @@ anjuta_command_queue_new (AnjutaCommandQueueExecuteMode mode)
 void
 anjuta_command_queue_push (AnjutaCommandQueue *self, AnjutaCommand *command)
 {
-	if (self->priv->mode == ANJUTA_COMMAND_QUEUE_EXECUTE_AUTOMATIC)
+	if ((self->priv->mode == ANJUTA_COMMAND_QUEUE_EXECUTE_AUTOMATIC) &&
+	    (self->priv->n_running < self->priv->max_running))
 	{
-		if (!self->priv->busy)
-		{
-			g_signal_connect (G_OBJECT (command), "command-finished",
-			                  G_CALLBACK (on_command_finished),
-			                  self);
-
-			if (self->priv->mode == ANJUTA_COMMAND_QUEUE_EXECUTE_AUTOMATIC)
-			{
-				self->priv->busy = TRUE;
-				anjuta_command_start (command);
-			}
-		}
-		else
-			g_queue_push_tail (self->priv->queue, g_object_ref (command));
+		start_command (self, command);
 	}
 	else
 		g_queue_push_tail (self->priv->queue, g_object_ref (command));
@@ -178,28 +227,79 @@ gboolean
 anjuta_command_queue_start (AnjutaCommandQueue *self)
 {
 	gboolean ret;
-	AnjutaCommand *first_command;
 
 	ret = FALSE;
 
 	if ((self->priv->mode == ANJUTA_COMMAND_QUEUE_EXECUTE_MANUAL) &&
 	    (!self->priv->busy))
 	{
-		first_command = g_queue_pop_head (self->priv->queue);
+		ret = start_next_commands (self);
+	}
 
-		if (first_command)
-		{
-			g_signal_connect (G_OBJECT (first_command), "command-finished",
-			                  G_CALLBACK (on_command_finished),
-			                  self);
+	return ret;
+		
+}
 
-			self->priv->busy = TRUE;
-			ret = TRUE;
+/**
+ * anjuta_command_queue_set_max_running:
+ * @self: AnjutaCommandQueue object
+ * @max_running: Maximum number of commands running at the same time or 0
+ * to use the number of processors
+ *
+ * Allows to run several commands at the same time. The commands have to be
+ * asynchronous and independent, they can finish in any order.
+ */
+void
+anjuta_command_queue_set_max_running (AnjutaCommandQueue *self,
+                                      guint max_running)
+{
+	g_return_if_fail (ANJUTA_IS_COMMAND_QUEUE (self));
 
-			anjuta_command_start (first_command);
+	if (max_running == 0)
+	{
+		max_running = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+		{
+			glong n_processors = sysconf (_SC_NPROCESSORS_ONLN);
+
+			if (n_processors > 1) max_running = n_processors;
 		}
+#endif
 	}
+	self->priv->max_running = max_running;
 
-	return ret;
-		
+	if (self->priv->busy || (self->priv->mode == ANJUTA_COMMAND_QUEUE_EXECUTE_AUTOMATIC))
+		start_next_commands (self);
+}
+
+/**
+ * anjuta_command_queue_cancel:
+ * @self: AnjutaCommandQueue object
+ *
+ * Removes all waiting commands and cancels the running ones if they
+ * support it. The ::finished signal is emitted as usual when the last
+ * running command finishes.
+ */
+void
+anjuta_command_queue_cancel (AnjutaCommandQueue *self)
+{
+	AnjutaCommand *command;
+	GList *running;
+	GList *item;
+
+	g_return_if_fail (ANJUTA_IS_COMMAND_QUEUE (self));
+
+	while ((command = g_queue_pop_head (self->priv->queue)) != NULL)
+		g_object_unref (command);
+
+	/* The list can change while commands are cancelled */
+	running = g_list_copy (self->priv->running);
+	g_list_foreach (running, (GFunc) g_object_ref, NULL);
+	for (item = running; item != NULL; item = g_list_next (item))
+	{
+		if (ANJUTA_COMMAND_GET_CLASS (item->data)->cancel != NULL)
+			anjuta_command_cancel (ANJUTA_COMMAND (item->data));
+		g_object_unref (item->data);
+	}
+	g_list_free (running);
 }
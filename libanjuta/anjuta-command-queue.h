@@ -62,6 +62,9 @@ AnjutaCommandQueue * anjuta_command_queue_new (AnjutaCommandQueueExecuteMode mod
 void anjuta_command_queue_push (AnjutaCommandQueue *self, 
                                 AnjutaCommand *command);
 gboolean anjuta_command_queue_start (AnjutaCommandQueue *self);
+void anjuta_command_queue_set_max_running (AnjutaCommandQueue *self,
+                                           guint max_running);
+void anjuta_command_queue_cancel (AnjutaCommandQueue *self);
 
 G_END_DECLS
 
@@ -66,6 +66,8 @@
 
 #define ANJUTA_PIXMAP_PASSWORD "password.png"
 #define FILE_BUFFER_SIZE 1024
+#define FILE_READ_SIZE (16 * 1024)
+#define LINES_MAX_LATENCY 100
 #define FILE_INPUT_BUFFER_SIZE  (1024 * 1024 * 4)
 #ifndef __MAX_BAUD
 #  if defined(B460800)
@@ -79,6 +81,19 @@
 #  endif
 #endif
 
+/* Buffer used to split the output of the child in lines. Data are read
+ * directly at the end of the buffer, complete lines are delivered in place
+ * and only the last incomplete line is moved at the beginning. */
+typedef struct _AnjutaLauncherBuffer AnjutaLauncherBuffer;
+
+struct _AnjutaLauncherBuffer
+{
+	gchar *data;
+	gsize size;			/* Allocated size */
+	gsize length;		/* Length of the incomplete line */
+	gsize line_start;	/* Start of the last line not terminated */
+};
+
 /*
 static gboolean
 anjuta_launcher_pty_check_child_exit_code (AnjutaLauncher *launcher,
@@ -108,8 +123,23 @@ struct _AnjutaLauncherPriv
 	guint pty_watch;
 	
 	/* Output line buffers */
-	gchar *stdout_buffer;
-	gchar *stderr_buffer;
+	AnjutaLauncherBuffer stdout_buffer;
+	AnjutaLauncherBuffer stderr_buffer;
+
+	/* Maximum size read at once */
+	gsize read_size;
+
+	/* Maximum time in ms spent reading before delivering lines */
+	guint max_latency;
+
+	/* Array of lines delivered at once */
+	GPtrArray *lines;
+
+	/* Flow control, stop reading outputs above the high water mark */
+	gsize high_water_mark;
+	gsize pending_output;
+	gint64 pause_time;
+	gint64 blocked_time;
 	
 	/* Output of the pty is constantly stored here.*/
 	gchar *pty_output_buffer;
@@ -140,6 +170,9 @@ struct _AnjutaLauncherPriv
 	
 	/* Output callback */
 	AnjutaLauncherOutputCallback output_callback;
+
+	/* Lines callback, used instead of the output callback */
+	AnjutaLauncherLinesCallback lines_callback;
 	
 	/* Callback data */
 	gpointer callback_data;
@@ -166,6 +199,13 @@ static gboolean anjuta_launcher_call_execution_done (gpointer data);
 static gboolean anjuta_launcher_check_for_execution_done (gpointer data);
 static void anjuta_launcher_execution_done_cleanup (AnjutaLauncher *launcher,
 													gboolean emit_signal);
+static gboolean anjuta_launcher_scan_output (GIOChannel *channel,
+											 GIOCondition condition,
+											 AnjutaLauncher *launcher);
+static gboolean anjuta_launcher_scan_error (GIOChannel *channel,
+											GIOCondition condition,
+											AnjutaLauncher *launcher);
+static void anjuta_launcher_resume_output (AnjutaLauncher *launcher);
 
 static gboolean is_password_prompt(const gchar* line);
 
@@ -186,10 +226,15 @@ anjuta_launcher_initialize (AnjutaLauncher *obj)
 	obj->priv->stdout_channel = NULL;
 	obj->priv->stderr_channel = NULL;
 	obj->priv->pty_channel = NULL;
+
+	/* GIO watch handles */
+	obj->priv->stdout_watch = 0;
+	obj->priv->stderr_watch = 0;
+	obj->priv->pty_watch = 0;
 	
 	/* Output line buffers */
-	obj->priv->stdout_buffer = NULL;
-	obj->priv->stderr_buffer = NULL;
+	memset (&obj->priv->stdout_buffer, 0, sizeof (AnjutaLauncherBuffer));
+	memset (&obj->priv->stderr_buffer, 0, sizeof (AnjutaLauncherBuffer));
 	
 	/* Pty buffer */
 	obj->priv->pty_output_buffer = NULL;
@@ -216,6 +261,7 @@ anjuta_launcher_initialize (AnjutaLauncher *obj)
 	
 	/* Output callback */
 	obj->priv->output_callback = NULL;
+	obj->priv->lines_callback = NULL;
 	obj->priv->callback_data = NULL;
 	
 	/* Encoding */
@@ -278,6 +324,7 @@ anjuta_launcher_finalize (GObject *obj)
 		g_free (launcher->priv->encoding);
 	
 	g_hash_table_destroy (launcher->priv->env);
+	g_ptr_array_free (launcher->priv->lines, TRUE);
 	
 	g_free (launcher->priv);
 	G_OBJECT_CLASS (parent_class)->finalize (obj);
@@ -346,6 +393,9 @@ anjuta_launcher_init (AnjutaLauncher * obj)
 {
 	g_return_if_fail (obj != NULL);
 	obj->priv = g_new0 (AnjutaLauncherPriv, 1);
+	obj->priv->read_size = FILE_READ_SIZE;
+	obj->priv->max_latency = LINES_MAX_LATENCY;
+	obj->priv->lines = g_ptr_array_new ();
 	anjuta_launcher_initialize (obj);
 }
 
@@ -461,9 +511,15 @@ anjuta_launcher_send_ptyin (AnjutaLauncher *launcher, const gchar * input_str)
 void
 anjuta_launcher_reset (AnjutaLauncher *launcher)
 {
-	if (anjuta_launcher_is_busy (launcher) &&
-	    launcher->priv->child_pid)
-		kill (launcher->priv->child_pid, SIGTERM);
+	if (anjuta_launcher_is_busy (launcher))
+	{
+		/* The remaining output is not needed anymore, read it without
+		 * waiting for its release so the end of the outputs is seen */
+		launcher->priv->pending_output = 0;
+		anjuta_launcher_resume_output (launcher);
+		if (launcher->priv->child_pid)
+			kill (launcher->priv->child_pid, SIGTERM);
+	}
 }
 
 /**
@@ -681,153 +737,327 @@ is_password_prompt (const gchar* line)
 	return FALSE;
 }
 
+/* Get space for size more bytes at the end of the buffer */
+static gchar *
+anjuta_launcher_buffer_reserve (AnjutaLauncherBuffer *buffer, gsize size)
+{
+	/* Keep one byte for the terminating null character */
+	if (buffer->length + size + 1 > buffer->size)
+	{
+		buffer->size = MAX (buffer->size * 2, buffer->length + size + 1);
+		buffer->data = g_realloc (buffer->data, buffer->size);
+	}
+
+	return buffer->data + buffer->length;
+}
+
+static void
+anjuta_launcher_buffer_free (AnjutaLauncherBuffer *buffer)
+{
+	g_free (buffer->data);
+	buffer->data = NULL;
+	buffer->size = 0;
+	buffer->length = 0;
+	buffer->line_start = 0;
+}
+
+static void
+anjuta_launcher_deliver_output (AnjutaLauncher *launcher,
+								AnjutaLauncherOutputType output_type,
+								const gchar *chars,
+								gboolean convert)
+{
+	/* Channels already convert data using the process encoding, only
+	 * invalid UTF-8 data need a copy */
+	if (convert && !g_utf8_validate (chars, -1, NULL))
+	{
+		gchar *utf8_chars;
+
+		utf8_chars = anjuta_util_convert_to_utf8 (chars);
+		if (utf8_chars != NULL)
+		{
+			launcher->priv->pending_output += strlen (utf8_chars);
+			(launcher->priv->output_callback)(launcher, output_type, utf8_chars,
+											  launcher->priv->callback_data);
+			g_free (utf8_chars);
+		}
+	}
+	else
+	{
+		launcher->priv->pending_output += strlen (chars);
+		(launcher->priv->output_callback)(launcher, output_type, chars,
+										  launcher->priv->callback_data);
+	}
+}
+
+/* Deliver all complete lines of the buffer at once, or all lines including
+ * the last incomplete one if flush is TRUE */
+static void
+anjuta_launcher_deliver_lines (AnjutaLauncher *launcher,
+							   AnjutaLauncherOutputType output_type,
+							   AnjutaLauncherBuffer *buffer,
+							   gboolean convert,
+							   gboolean flush)
+{
+	GPtrArray *lines = launcher->priv->lines;
+	gchar *end;
+	gchar *eol;
+	gchar next;
+	gchar *utf8_chars = NULL;
+	gchar *line;
+
+	if (buffer->length == 0) return;
+
+	end = buffer->data + buffer->length;
+	if (flush)
+	{
+		eol = end;
+	}
+	else
+	{
+		for (eol = end; (eol > buffer->data) && (eol[-1] != '\n'); eol--);
+		if (eol == buffer->data) return;
+	}
+	next = *eol;
+	*eol = '\0';
+
+	line = buffer->data;
+	if (convert && !g_utf8_validate (line, -1, NULL))
+	{
+		line = utf8_chars = anjuta_util_convert_to_utf8 (line);
+	}
+
+	if (line != NULL)
+	{
+		/* Split lines in place */
+		g_ptr_array_set_size (lines, 0);
+		while (*line != '\0')
+		{
+			gchar *next_line = strchr (line, '\n');
+
+			g_ptr_array_add (lines, line);
+			if (next_line == NULL) break;
+			*next_line = '\0';
+			/* Remove carriage return of DOS end of line */
+			if ((next_line > line) && (next_line[-1] == '\r')) next_line[-1] = '\0';
+			line = next_line + 1;
+		}
+		if (lines->len > 0)
+		{
+			guint n_lines = lines->len;
+
+			/* Count all delivered bytes including end of lines */
+			launcher->priv->pending_output += (line - (gchar *)lines->pdata[0]) + strlen (line);
+
+			g_ptr_array_add (lines, NULL);
+			(launcher->priv->lines_callback)(launcher, output_type,
+											 (const gchar * const *)lines->pdata,
+											 n_lines,
+											 launcher->priv->callback_data);
+		}
+		g_free (utf8_chars);
+	}
+
+	/* Buffer the last incomplete line */
+	*eol = next;
+	buffer->length = end - eol;
+	buffer->line_start = 0;
+	memmove (buffer->data, eol, buffer->length + 1);
+}
+
+/* Process length bytes just read at the end of buffer */
 static void
 anjuta_launcher_buffered_output (AnjutaLauncher *launcher,
 								 AnjutaLauncherOutputType output_type,
-								 const gchar *chars)
+								 AnjutaLauncherBuffer *buffer,
+								 gsize length,
+								 gboolean convert)
 {
-	gchar *all_lines;
-	gchar *incomplete_line;
-	gchar **buffer;
+	gchar *start;
+	gchar *end;
+	gchar *eol;
 
-	g_return_if_fail (chars != NULL);
-	g_return_if_fail (strlen (chars) > 0);
+	start = buffer->data + buffer->length;
+	end = start + length;
+	*end = '\0';
+	buffer->length += length;
 
+	if (launcher->priv->lines_callback != NULL)
+	{
+		/* Lines are delivered once all data has been read, look for a
+		 * password prompt in the last line only */
+		for (eol = end; (eol > start) && (eol[-1] != '\n'); eol--);
+		if (eol > start) buffer->line_start = eol - buffer->data;
+		if (launcher->priv->check_for_passwd_prompt && (eol != end))
+			anjuta_launcher_check_password (launcher, buffer->data + buffer->line_start);
+		return;
+	}
 	if (launcher->priv->output_callback == NULL)
+	{
+		buffer->length = 0;
 		return;
+	}
 	if (launcher->priv->buffered_output == FALSE)
 	{
-		(launcher->priv->output_callback)(launcher, output_type, chars,
-										  launcher->priv->callback_data);
+		buffer->length = 0;
+		anjuta_launcher_deliver_output (launcher, output_type, buffer->data, convert);
 		return;
 	}
-	switch (output_type)
+
+	/* Look for the last end of line in the new data only, the previous data
+	 * are an incomplete line. '\n' cannot be a part of a multibyte UTF-8
+	 * character so the search can be done on bytes. */
+	for (eol = end; (eol > start) && (eol[-1] != '\n'); eol--);
+
+	/* Deliver complete lines */
+	if (eol > buffer->data)
 	{
-	case ANJUTA_LAUNCHER_OUTPUT_STDOUT:
-		buffer = &launcher->priv->stdout_buffer;
-		break;
-	case ANJUTA_LAUNCHER_OUTPUT_STDERR:
-		buffer = &launcher->priv->stderr_buffer;
-		break;
-	default:
-		g_warning ("Should not reach here");
-		return;
+		gchar next = *eol;
+
+		*eol = '\0';
+		anjuta_launcher_deliver_output (launcher, output_type, buffer->data, convert);
+		*eol = next;
+
+		/* Buffer the last incomplete line */
+		buffer->length = end - eol;
+		memmove (buffer->data, eol, buffer->length + 1);
 	}
-	if (*buffer) 
-		all_lines = g_strconcat (*buffer, chars, NULL);
-	else
-		all_lines = g_strdup (chars);
-	
-	/* Buffer the last incomplete line */
-	incomplete_line = all_lines + strlen (all_lines);
-	while (incomplete_line > all_lines &&
-		   *incomplete_line != '\n')
+
+	/* Check for password prompt */
+	if (launcher->priv->check_for_passwd_prompt && (buffer->length > 0))
+		anjuta_launcher_check_password (launcher, buffer->data);
+}
+
+/* Send remaining data if last line is not terminated with EOL */
+static void
+anjuta_launcher_flush_output (AnjutaLauncher *launcher,
+							  AnjutaLauncherOutputType output_type,
+							  AnjutaLauncherBuffer *buffer,
+							  gboolean convert)
+{
+	if (launcher->priv->lines_callback != NULL)
 	{
-		incomplete_line = g_utf8_prev_char (incomplete_line);
+		anjuta_launcher_deliver_lines (launcher, output_type, buffer, convert, TRUE);
 	}
-	if (*incomplete_line == '\n')
-		incomplete_line++;
-	
-	/* Update line buffer */
-	g_free(*buffer);
-	*buffer = NULL;
-	if (strlen(incomplete_line))
+	else if ((buffer->length > 0) && (launcher->priv->output_callback != NULL))
 	{
-		*buffer = g_strdup (incomplete_line);
-		/* DEBUG_PRINT ("Line buffer for %d: %s", output_type, incomplete_line); */
+		anjuta_launcher_deliver_output (launcher, output_type, buffer->data, convert);
 	}
-	/* Check for password prompt */
-	if (launcher->priv->check_for_passwd_prompt)
-		anjuta_launcher_check_password (launcher, incomplete_line);
-	
-	/* Deliver complete lines */
-	*incomplete_line = '\0';
-	if (strlen (all_lines) > 0)
-		(launcher->priv->output_callback)(launcher, output_type, all_lines,
-										  launcher->priv->callback_data);
-	g_free (all_lines);
+	anjuta_launcher_buffer_free (buffer);
 }
 
 static gboolean
-anjuta_launcher_scan_output (GIOChannel *channel, GIOCondition condition,
-							 AnjutaLauncher *launcher)
+anjuta_launcher_output_is_full (AnjutaLauncher *launcher)
 {
-	gsize n;
-	gchar buffer[FILE_BUFFER_SIZE];
-	gboolean ret = TRUE;
+	/* Once the child has exited, read all remaining data to get the end
+	 * of the outputs */
+	return (launcher->priv->high_water_mark != 0) &&
+		!launcher->priv->child_has_terminated &&
+		(launcher->priv->pending_output >= launcher->priv->high_water_mark);
+}
 
-	if (condition & G_IO_IN)
+static void
+anjuta_launcher_pause_output (AnjutaLauncher *launcher)
+{
+	if (launcher->priv->stdout_watch != 0)
 	{
-		GError *err = NULL;
-		do
-		{
-			g_io_channel_read_chars (channel, buffer, FILE_BUFFER_SIZE-1, &n, &err);
-			if (n > 0) /* There is output */
-			{
-				gchar *utf8_chars = NULL;
-				buffer[n] = '\0';
-				if (!launcher->priv->custom_encoding)
-					utf8_chars = anjuta_util_convert_to_utf8 (buffer);
-				else
-					utf8_chars = g_strdup(buffer);
-				anjuta_launcher_buffered_output (launcher,
-												 ANJUTA_LAUNCHER_OUTPUT_STDOUT,
-												 utf8_chars);
-				g_free (utf8_chars);
-			}
-			/* Ignore illegal characters */
-			if (err && err->domain == G_CONVERT_ERROR)
-			{
-				g_error_free (err);
-				err = NULL;
-			}
-			/* The pipe is closed on the other side */
-			/* if not related to non blocking read or interrupted syscall */
-			else if (err && errno != EAGAIN && errno != EINTR)
-			{
-				launcher->priv->stdout_is_done = TRUE;
-				anjuta_launcher_synchronize (launcher);
-				ret = FALSE;
-			}
-		/* Read next chars if buffer was too small
-		 * (the maximum length of one character is 6 bytes) */
-		} while (!err && (n > FILE_BUFFER_SIZE - 7));
-		if (err)
-			g_error_free (err);
+		g_source_remove (launcher->priv->stdout_watch);
+		launcher->priv->stdout_watch = 0;
 	}
-	if ((condition & G_IO_ERR) || (condition & G_IO_HUP))
+	if (launcher->priv->stderr_watch != 0)
 	{
-		DEBUG_PRINT ("%s", "launcher.c: STDOUT pipe closed");
-		launcher->priv->stdout_is_done = TRUE;
-		anjuta_launcher_synchronize (launcher);
-		ret = FALSE;
+		g_source_remove (launcher->priv->stderr_watch);
+		launcher->priv->stderr_watch = 0;
+	}
+	if (launcher->priv->pause_time == 0)
+		launcher->priv->pause_time = g_get_monotonic_time ();
+}
+
+static void
+anjuta_launcher_end_pause (AnjutaLauncher *launcher)
+{
+	if (launcher->priv->pause_time != 0)
+	{
+		launcher->priv->blocked_time += g_get_monotonic_time () - launcher->priv->pause_time;
+		launcher->priv->pause_time = 0;
+	}
+}
+
+/* Watch standard and error outputs not already closed */
+static void
+anjuta_launcher_watch_output (AnjutaLauncher *launcher)
+{
+	if ((launcher->priv->stderr_watch == 0) && !launcher->priv->stderr_is_done)
+	{
+		launcher->priv->stderr_watch = 
+			g_io_add_watch (launcher->priv->stderr_channel,
+							G_IO_IN | G_IO_ERR | G_IO_HUP,
+							(GIOFunc)anjuta_launcher_scan_error, launcher);
+	}
+	if ((launcher->priv->stdout_watch == 0) && !launcher->priv->stdout_is_done)
+	{
+		launcher->priv->stdout_watch = 
+			g_io_add_watch (launcher->priv->stdout_channel,
+							G_IO_IN | G_IO_ERR | G_IO_HUP,
+							(GIOFunc)anjuta_launcher_scan_output, launcher);
+	}
+}
+
+/* Read the outputs again if they have been stopped by the high water mark */
+static void
+anjuta_launcher_resume_output (AnjutaLauncher *launcher)
+{
+	if (launcher->priv->pause_time != 0)
+	{
+		anjuta_launcher_end_pause (launcher);
+		anjuta_launcher_watch_output (launcher);
 	}
-	return ret;
 }
 
 static gboolean
-anjuta_launcher_scan_error (GIOChannel *channel, GIOCondition condition,
-							AnjutaLauncher *launcher)
+anjuta_launcher_scan_channel (GIOChannel *channel, GIOCondition condition,
+							  AnjutaLauncher *launcher,
+							  AnjutaLauncherOutputType output_type)
 {
+	AnjutaLauncherBuffer *buffer;
+	gboolean *is_done;
+	guint *watch;
+	gboolean convert;
+	gsize read_size = launcher->priv->read_size;
+	gint64 deadline;
 	gsize n;
-	gchar buffer[FILE_BUFFER_SIZE];
 	gboolean ret = TRUE;
-	
+
+	if (output_type == ANJUTA_LAUNCHER_OUTPUT_STDOUT)
+	{
+		buffer = &launcher->priv->stdout_buffer;
+		is_done = &launcher->priv->stdout_is_done;
+		watch = &launcher->priv->stdout_watch;
+		convert = !launcher->priv->custom_encoding;
+	}
+	else
+	{
+		buffer = &launcher->priv->stderr_buffer;
+		is_done = &launcher->priv->stderr_is_done;
+		watch = &launcher->priv->stderr_watch;
+		convert = TRUE;
+	}
+
 	if (condition & G_IO_IN)
 	{
 		GError *err = NULL;
+
+		deadline = g_get_monotonic_time () + launcher->priv->max_latency * 1000;
 		do
 		{
-			g_io_channel_read_chars (channel, buffer, FILE_BUFFER_SIZE-1, &n, &err);
-			if (n > 0) /* There is stderr output */
+			gchar *chars;
+
+			chars = anjuta_launcher_buffer_reserve (buffer, read_size);
+			g_io_channel_read_chars (channel, chars, read_size, &n, &err);
+			if (n > 0) /* There is output */
 			{
-				gchar *utf8_chars;
-				buffer[n] = '\0';
-				utf8_chars = anjuta_util_convert_to_utf8 (buffer);
-				anjuta_launcher_buffered_output (launcher,
-												 ANJUTA_LAUNCHER_OUTPUT_STDERR,
-												 utf8_chars);
-				g_free (utf8_chars);
+				anjuta_launcher_buffered_output (launcher, output_type,
+												 buffer, n, convert);
 			}
 			/* Ignore illegal characters */
 			if (err && err->domain == G_CONVERT_ERROR)
@@ -839,27 +1069,60 @@ anjuta_launcher_scan_error (GIOChannel *channel, GIOCondition condition,
 			/* if not related to non blocking read or interrupted syscall */
 			else if (err && errno != EAGAIN && errno != EINTR)
 			{
-				
-				launcher->priv->stderr_is_done = TRUE;
+				*is_done = TRUE;
 				anjuta_launcher_synchronize (launcher);
 				ret = FALSE;
 			}
 		/* Read next chars if buffer was too small
 		 * (the maximum length of one character is 6 bytes) */
-		} while (!err && (n > FILE_BUFFER_SIZE - 7));
+		} while (!err && (n + 6 > read_size) &&
+				 !anjuta_launcher_output_is_full (launcher) &&
+				 ((launcher->priv->lines_callback == NULL) ||
+				  (g_get_monotonic_time () < deadline)));
 		if (err)
 			g_error_free (err);
+
+		/* Deliver all lines read during this dispatch, remaining data if any
+		 * will be read in the next one */
+		if (launcher->priv->lines_callback != NULL)
+			anjuta_launcher_deliver_lines (launcher, output_type, buffer,
+										   convert, FALSE);
 	}
 	if ((condition & G_IO_ERR) || (condition & G_IO_HUP))
 	{
-		DEBUG_PRINT ("%s", "launcher.c: STDERR pipe closed");
-		launcher->priv->stderr_is_done = TRUE;
+		DEBUG_PRINT ("launcher.c: %s pipe closed",
+					 output_type == ANJUTA_LAUNCHER_OUTPUT_STDOUT ? "STDOUT" : "STDERR");
+		*is_done = TRUE;
 		anjuta_launcher_synchronize (launcher);
 		ret = FALSE;
 	}
+	if (ret && anjuta_launcher_output_is_full (launcher))
+	{
+		/* Stop reading, the child will block when the pipe is full */
+		anjuta_launcher_pause_output (launcher);
+		ret = FALSE;
+	}
+	if (!ret) *watch = 0;
+
 	return ret;
 }
 
+static gboolean
+anjuta_launcher_scan_output (GIOChannel *channel, GIOCondition condition,
+							 AnjutaLauncher *launcher)
+{
+	return anjuta_launcher_scan_channel (channel, condition, launcher,
+										 ANJUTA_LAUNCHER_OUTPUT_STDOUT);
+}
+
+static gboolean
+anjuta_launcher_scan_error (GIOChannel *channel, GIOCondition condition,
+							AnjutaLauncher *launcher)
+{
+	return anjuta_launcher_scan_channel (channel, condition, launcher,
+										 ANJUTA_LAUNCHER_OUTPUT_STDERR);
+}
+
 static gboolean
 anjuta_launcher_scan_pty (GIOChannel *channel, GIOCondition condition,
 						  AnjutaLauncher *launcher)
@@ -940,14 +1203,16 @@ anjuta_launcher_execution_done_cleanup (AnjutaLauncher *launcher,
 	{	
 		g_io_channel_shutdown (launcher->priv->stdout_channel, emit_signal, NULL);
 		g_io_channel_unref (launcher->priv->stdout_channel);
-		g_source_remove (launcher->priv->stdout_watch);
+		if (launcher->priv->stdout_watch != 0)
+			g_source_remove (launcher->priv->stdout_watch);
 	}
 
 	if (launcher->priv->stderr_channel)
 	{
 		g_io_channel_shutdown (launcher->priv->stderr_channel, emit_signal, NULL);
 		g_io_channel_unref (launcher->priv->stderr_channel);
-		g_source_remove (launcher->priv->stderr_watch);
+		if (launcher->priv->stderr_watch != 0)
+			g_source_remove (launcher->priv->stderr_watch);
 	}
 
 	if (launcher->priv->pty_channel)
@@ -960,24 +1225,13 @@ anjuta_launcher_execution_done_cleanup (AnjutaLauncher *launcher,
 
 	if (launcher->priv->pty_output_buffer)
 		g_free (launcher->priv->pty_output_buffer);
-	if (launcher->priv->stdout_buffer)
-	{
-		/* Send remaining data if last line is not terminated with EOL */
-		(launcher->priv->output_callback)(launcher,
-			       ANJUTA_LAUNCHER_OUTPUT_STDOUT,
-			       launcher->priv->stdout_buffer,
-			       launcher->priv->callback_data);
-		g_free (launcher->priv->stdout_buffer);
-	}
-	if (launcher->priv->stderr_buffer)
-	{
-		/* Send remaining data if last line is not terminated with EOL */
-		(launcher->priv->output_callback)(launcher,
-			       ANJUTA_LAUNCHER_OUTPUT_STDERR,
-			       launcher->priv->stderr_buffer,
-			       launcher->priv->callback_data);
-		g_free (launcher->priv->stdout_buffer);
-	}
+	anjuta_launcher_end_pause (launcher);
+	anjuta_launcher_flush_output (launcher, ANJUTA_LAUNCHER_OUTPUT_STDOUT,
+								  &launcher->priv->stdout_buffer,
+								  !launcher->priv->custom_encoding);
+	anjuta_launcher_flush_output (launcher, ANJUTA_LAUNCHER_OUTPUT_STDERR,
+								  &launcher->priv->stderr_buffer,
+								  TRUE);
 	
 	/* Save them before we re-initialize */
 	child_status = launcher->priv->child_status;
@@ -1046,6 +1300,8 @@ anjuta_launcher_child_terminated (GPid pid, gint status, gpointer data)
 	/* Save child exit code */
 	launcher->priv->child_status = status;
 	launcher->priv->child_has_terminated = TRUE;
+	/* The outputs have to be watched to know when they are closed */
+	anjuta_launcher_resume_output (launcher);
 	anjuta_launcher_synchronize (launcher);
 }
 
@@ -1225,14 +1481,7 @@ anjuta_launcher_fork (AnjutaLauncher *launcher, const gchar *dir, gchar *const a
 	cfsetospeed(&termios_flags, __MAX_BAUD);
 	tcsetattr(pty_master_fd, TCSANOW, &termios_flags);
 
-	launcher->priv->stderr_watch = 
-		g_io_add_watch (launcher->priv->stderr_channel,
-						G_IO_IN | G_IO_ERR | G_IO_HUP,
-						(GIOFunc)anjuta_launcher_scan_error, launcher);
-	launcher->priv->stdout_watch = 
-		g_io_add_watch (launcher->priv->stdout_channel,
-						G_IO_IN | G_IO_ERR | G_IO_HUP,
-						(GIOFunc)anjuta_launcher_scan_output, launcher);
+	anjuta_launcher_watch_output (launcher);
 	launcher->priv->pty_watch = 
 		g_io_add_watch (launcher->priv->pty_channel,
 						G_IO_IN | G_IO_ERR, /* Do not hook up for G_IO_HUP */
@@ -1244,6 +1493,40 @@ anjuta_launcher_fork (AnjutaLauncher *launcher, const gchar *dir, gchar *const a
 	return child_pid;
 }
 
+static gboolean
+anjuta_launcher_execute_real (AnjutaLauncher *launcher, gchar *const dir,
+							  gchar *const argv[],
+							  gchar *const envp[],
+							  AnjutaLauncherOutputCallback output_callback,
+							  AnjutaLauncherLinesCallback lines_callback,
+							  gpointer callback_data)
+{
+	if (anjuta_launcher_is_busy (launcher))
+		return FALSE;
+	
+	anjuta_launcher_set_busy (launcher, TRUE);
+	
+	launcher->priv->start_time = time (NULL);
+	launcher->priv->child_status = 0;
+	launcher->priv->stdout_is_done = FALSE;
+	launcher->priv->stderr_is_done = FALSE;
+	launcher->priv->child_has_terminated = FALSE;
+	launcher->priv->output_callback = output_callback;
+	launcher->priv->lines_callback = lines_callback;
+	launcher->priv->callback_data = callback_data;
+	launcher->priv->pending_output = 0;
+	launcher->priv->pause_time = 0;
+	launcher->priv->blocked_time = 0;
+	
+	/* On a fork error perform a cleanup and return */
+	if (anjuta_launcher_fork (launcher, dir, argv, envp) < 0)
+	{
+		anjuta_launcher_initialize (launcher);
+		return FALSE;
+	}
+	return TRUE;
+}
+
 /**
  * anjuta_launcher_execute_v:
  * @launcher: a #AnjutaLancher object.
@@ -1265,26 +1548,59 @@ anjuta_launcher_execute_v (AnjutaLauncher *launcher, gchar *const dir,
 	       	AnjutaLauncherOutputCallback callback,
 	       	gpointer callback_data)
 {
-	if (anjuta_launcher_is_busy (launcher))
-		return FALSE;
-	
-	anjuta_launcher_set_busy (launcher, TRUE);
-	
-	launcher->priv->start_time = time (NULL);
-	launcher->priv->child_status = 0;
-	launcher->priv->stdout_is_done = FALSE;
-	launcher->priv->stderr_is_done = FALSE;
-	launcher->priv->child_has_terminated = FALSE;
-	launcher->priv->output_callback = callback;
-	launcher->priv->callback_data = callback_data;
-	
-	/* On a fork error perform a cleanup and return */
-	if (anjuta_launcher_fork (launcher, dir, argv, envp) < 0)
+	return anjuta_launcher_execute_real (launcher, dir, argv, envp,
+										 callback, NULL, callback_data);
+}
+
+/**
+ * anjuta_launcher_execute_lines_v:
+ * @launcher: a #AnjutaLancher object.
+ * @dir: Working directory or NULL.
+ * @argv: Command args.
+ * @envp: Additional environment variable.
+ * @callback: The callback for delivering output lines from the process.
+ * @callback_data: Callback data for the above callback.
+ *
+ * Same function than anjuta_launcher_execute_v() but the output is delivered
+ * as arrays of complete lines without the end of line characters. All lines
+ * read from one output during a main loop iteration are delivered in one
+ * call. The time spent reading is bounded, see
+ * anjuta_launcher_set_max_latency().
+ *
+ * Return value: TRUE if successfully launched, otherwise FALSE.
+ */
+gboolean
+anjuta_launcher_execute_lines_v (AnjutaLauncher *launcher, gchar *const dir,
+								 gchar *const argv[],
+								 gchar *const envp[],
+								 AnjutaLauncherLinesCallback callback,
+								 gpointer callback_data)
+{
+	return anjuta_launcher_execute_real (launcher, dir, argv, envp,
+										 NULL, callback, callback_data);
+}
+
+/* Split a command line in a NULL terminated array of arguments */
+static gchar **
+anjuta_launcher_parse_command (const gchar *command_str)
+{
+	GList *args_list, *args_list_ptr;
+	gchar **args, **args_ptr;
+
+	args_list = anjuta_util_parse_args_from_string (command_str);
+	args = g_new (char*, g_list_length (args_list) + 1);
+	args_list_ptr = args_list;
+	args_ptr = args;
+	while (args_list_ptr)
 	{
-		anjuta_launcher_initialize (launcher);
-		return FALSE;
+		*args_ptr = (char*) args_list_ptr->data;
+		args_list_ptr = g_list_next (args_list_ptr);
+		args_ptr++;
 	}
-	return TRUE;
+	*args_ptr = NULL;
+	g_list_free (args_list);
+
+	return args;
 }
 
 /**
@@ -1308,27 +1624,43 @@ anjuta_launcher_execute (AnjutaLauncher *launcher, const gchar *command_str,
 						 AnjutaLauncherOutputCallback callback,
 						 gpointer callback_data)
 {
-	GList *args_list, *args_list_ptr;
-	gchar **args, **args_ptr;
+	gchar **args;
 	gboolean ret;
 	
 	/* Prepare command args */
-	args_list = anjuta_util_parse_args_from_string (command_str);
-	args = g_new (char*, g_list_length (args_list) + 1);
-	args_list_ptr = args_list;
-	args_ptr = args;
-	while (args_list_ptr)
-	{
-		*args_ptr = (char*) args_list_ptr->data;
-		args_list_ptr = g_list_next (args_list_ptr);
-		args_ptr++;
-	}
-	*args_ptr = NULL;
+	args = anjuta_launcher_parse_command (command_str);
 
 	ret = anjuta_launcher_execute_v (launcher, NULL, args, NULL,
 		callback, callback_data);
-	g_free (args);
-	anjuta_util_glist_strings_free (args_list);
+	g_strfreev (args);
+	return ret;
+}
+
+/**
+ * anjuta_launcher_execute_lines:
+ * @launcher: a #AnjutaLancher object.
+ * @command_str: The command to execute.
+ * @callback: The callback for delivering output lines from the process.
+ * @callback_data: Callback data for the above callback.
+ *
+ * Same function than anjuta_launcher_execute() but the output is delivered
+ * as arrays of complete lines, see anjuta_launcher_execute_lines_v().
+ *
+ * Return value: TRUE if successfully launched, otherwise FALSE.
+ */
+gboolean
+anjuta_launcher_execute_lines (AnjutaLauncher *launcher,
+							   const gchar *command_str,
+							   AnjutaLauncherLinesCallback callback,
+							   gpointer callback_data)
+{
+	gchar **args;
+	gboolean ret;
+
+	args = anjuta_launcher_parse_command (command_str);
+	ret = anjuta_launcher_execute_lines_v (launcher, NULL, args, NULL,
+										   callback, callback_data);
+	g_strfreev (args);
 	return ret;
 }
 
@@ -1349,6 +1681,110 @@ anjuta_launcher_set_buffered_output (AnjutaLauncher *launcher, gboolean buffered
 	return past_value;
 }
 
+/**
+ * anjuta_launcher_set_read_size:
+ * @launcher: a #AnjutaLancher object.
+ * @size: Maximum number of bytes read at once.
+ *
+ * Sets the size of the blocks read from the standard and error outputs of
+ * the child. A bigger size reduces the number of output callbacks when the
+ * child writes a lot of data. By default, it is 16 KiB.
+ *
+ * Return value: Previous size
+ */
+gsize
+anjuta_launcher_set_read_size (AnjutaLauncher *launcher, gsize size)
+{
+	gsize past_value = launcher->priv->read_size;
+	/* Read at least a complete character */
+	launcher->priv->read_size = MAX (size, 16);
+	return past_value;
+}
+
+/**
+ * anjuta_launcher_set_max_latency:
+ * @launcher: a #AnjutaLancher object.
+ * @latency: Maximum time in milliseconds.
+ *
+ * Sets the maximum time spent reading the output of the child before
+ * delivering the lines read when the launcher has been started with
+ * anjuta_launcher_execute_lines(). By default, it is 100 ms.
+ *
+ * Return value: Previous latency
+ */
+guint
+anjuta_launcher_set_max_latency (AnjutaLauncher *launcher, guint latency)
+{
+	guint past_value = launcher->priv->max_latency;
+	launcher->priv->max_latency = latency;
+	return past_value;
+}
+
+/**
+ * anjuta_launcher_set_high_water_mark:
+ * @launcher: a #AnjutaLancher object.
+ * @size: Maximum number of delivered bytes not released or 0.
+ *
+ * Enables flow control on the standard and error outputs of the child. When
+ * the number of bytes delivered and not released yet with
+ * anjuta_launcher_release_output() reaches @size, the launcher stops reading
+ * the outputs, so the child blocks when writing, until half of them have
+ * been released. A @size of 0 disables the flow control, it is the default.
+ *
+ * Return value: Previous high water mark
+ */
+gsize
+anjuta_launcher_set_high_water_mark (AnjutaLauncher *launcher, gsize size)
+{
+	gsize past_value = launcher->priv->high_water_mark;
+	launcher->priv->high_water_mark = size;
+	return past_value;
+}
+
+/**
+ * anjuta_launcher_release_output:
+ * @launcher: a #AnjutaLancher object.
+ * @length: Number of bytes processed.
+ *
+ * Tells the launcher that @length bytes of the delivered output have been
+ * processed. For each line delivered by a #AnjutaLauncherLinesCallback, the
+ * end of line character has to be counted too. The launcher reads the
+ * outputs again if it was stopped by the high water mark.
+ */
+void
+anjuta_launcher_release_output (AnjutaLauncher *launcher, gsize length)
+{
+	AnjutaLauncherPriv *priv = launcher->priv;
+
+	priv->pending_output = length < priv->pending_output ? priv->pending_output - length : 0;
+	if (anjuta_launcher_is_busy (launcher) &&
+		(priv->pending_output <= priv->high_water_mark / 2))
+	{
+		anjuta_launcher_resume_output (launcher);
+	}
+}
+
+/**
+ * anjuta_launcher_get_blocked_time:
+ * @launcher: a #AnjutaLancher object.
+ *
+ * Gets how long the outputs of the child were not read because the delivered
+ * data were not released fast enough. It is still available in the
+ * child-exited signal handler.
+ *
+ * Return value: Time in seconds
+ */
+gdouble
+anjuta_launcher_get_blocked_time (AnjutaLauncher *launcher)
+{
+	gint64 blocked = launcher->priv->blocked_time;
+
+	if (launcher->priv->pause_time != 0)
+		blocked += g_get_monotonic_time () - launcher->priv->pause_time;
+
+	return blocked / (gdouble)G_USEC_PER_SEC;
+}
+
 /**
  * anjuta_launcher_set_check_passwd_prompt:
  * @launcher: a #AnjutaLancher object.
@@ -59,6 +59,24 @@ typedef void (*AnjutaLauncherOutputCallback) (AnjutaLauncher *launcher,
 											  const gchar *chars,
 											  gpointer user_data);
 
+/**
+* AnjutaLauncherLinesCallback:
+* @launcher: a #AnjutaLauncher object
+* @output_type: Type of the output
+* @lines: NULL terminated array of lines without end of line characters
+* @n_lines: Number of lines
+* @user_data: User data passed back to the user
+*
+* This callback is called with all complete lines read from one output of
+* the launcher execution. The last line could be incomplete when the process
+* ends. The lines are owned by the launcher and valid only during the call.
+*/
+typedef void (*AnjutaLauncherLinesCallback) (AnjutaLauncher *launcher,
+											 AnjutaLauncherOutputType output_type,
+											 const gchar * const *lines,
+											 guint n_lines,
+											 gpointer user_data);
+
 struct _AnjutaLauncher
 {
     GObject parent;
@@ -89,6 +107,16 @@ gboolean anjuta_launcher_execute_v (AnjutaLauncher *launcher,
 									gchar *const envp[],
 									AnjutaLauncherOutputCallback callback,
 									gpointer callback_data);
+gboolean anjuta_launcher_execute_lines (AnjutaLauncher *launcher,
+										const gchar *command_str,
+										AnjutaLauncherLinesCallback callback,
+										gpointer callback_data);
+gboolean anjuta_launcher_execute_lines_v (AnjutaLauncher *launcher,
+										  gchar *const dir,
+										  gchar *const argv[],
+										  gchar *const envp[],
+										  AnjutaLauncherLinesCallback callback,
+										  gpointer callback_data);
 void anjuta_launcher_set_encoding (AnjutaLauncher *launcher,
 									   const gchar *charset);
 
@@ -103,6 +131,14 @@ void anjuta_launcher_reset (AnjutaLauncher *launcher);
 void anjuta_launcher_signal (AnjutaLauncher *launcher, int sig);
 gboolean anjuta_launcher_set_buffered_output (AnjutaLauncher *launcher,
 										  gboolean buffered);
+gsize anjuta_launcher_set_read_size (AnjutaLauncher *launcher,
+									gsize size);
+guint anjuta_launcher_set_max_latency (AnjutaLauncher *launcher,
+									   guint latency);
+gsize anjuta_launcher_set_high_water_mark (AnjutaLauncher *launcher,
+										   gsize size);
+void anjuta_launcher_release_output (AnjutaLauncher *launcher, gsize length);
+gdouble anjuta_launcher_get_blocked_time (AnjutaLauncher *launcher);
 gboolean anjuta_launcher_set_check_passwd_prompt (AnjutaLauncher *launcher,
 											  gboolean check_passwd);
 /* Returns old value */
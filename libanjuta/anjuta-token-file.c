@@ -29,6 +29,31 @@
 /* Types declarations
  *---------------------------------------------------------------------------*/
 
+/* A memory block containing file data, with the offset of all new lines */
+typedef struct _AnjutaTokenFileBuffer AnjutaTokenFileBuffer;
+
+struct _AnjutaTokenFileBuffer
+{
+	const gchar *start;
+	gsize length;
+	GArray *newlines;
+};
+
+/* A content token with its position in the file */
+typedef struct _AnjutaTokenFileSegment AnjutaTokenFileSegment;
+
+struct _AnjutaTokenFileSegment
+{
+	const gchar *start;
+	gsize length;
+	gsize position;				/* Position counting all content tokens */
+	gsize offset;				/* Offset in the file without removed tokens */
+	gsize line;					/* Line of the first character */
+	gsize line_offset;			/* Offset of the start of this line */
+	gboolean removed;
+	AnjutaTokenFileBuffer *buffer;
+};
+
 struct _AnjutaTokenFile
 {
 	GObject parent;
@@ -39,6 +64,11 @@ struct _AnjutaTokenFile
 
 	AnjutaToken *save;			/* List of memory block used */
 
+	AnjutaTokenPool *pool;		/* Memory used by all tokens of the file */
+
+	GPtrArray *buffers;			/* Memory blocks sorted by address */
+	GArray *index;				/* Content segments sorted by address */
+
 	gboolean dirty;					/* Set when the file has been modified */
 };
 
@@ -55,6 +85,195 @@ static GObjectClass *parent_class = NULL;
 /* Private functions
  *---------------------------------------------------------------------------*/
 
+static void
+anjuta_token_file_buffer_free (AnjutaTokenFileBuffer *buffer)
+{
+	g_array_free (buffer->newlines, TRUE);
+	g_slice_free (AnjutaTokenFileBuffer, buffer);
+}
+
+static gint
+anjuta_token_file_compare_buffer (gconstpointer a, gconstpointer b)
+{
+	const AnjutaTokenFileBuffer *buffer_a = *(const AnjutaTokenFileBuffer **)a;
+	const AnjutaTokenFileBuffer *buffer_b = *(const AnjutaTokenFileBuffer **)b;
+
+	return buffer_a->start < buffer_b->start ? -1 : (buffer_a->start > buffer_b->start ? 1 : 0);
+}
+
+static gint
+anjuta_token_file_compare_segment (gconstpointer a, gconstpointer b)
+{
+	const AnjutaTokenFileSegment *segment_a = (const AnjutaTokenFileSegment *)a;
+	const AnjutaTokenFileSegment *segment_b = (const AnjutaTokenFileSegment *)b;
+
+	return segment_a->start < segment_b->start ? -1 : (segment_a->start > segment_b->start ? 1 : 0);
+}
+
+static AnjutaTokenFileBuffer *
+anjuta_token_file_add_buffer (AnjutaTokenFile *file, const gchar *start, gsize length)
+{
+	AnjutaTokenFileBuffer *buffer;
+	const gchar *ptr;
+	const gchar *end;
+
+	buffer = g_slice_new (AnjutaTokenFileBuffer);
+	buffer->start = start;
+	buffer->length = length;
+	buffer->newlines = g_array_new (FALSE, FALSE, sizeof (guint));
+	end = start + length;
+	for (ptr = start; (ptr = memchr (ptr, '\n', end - ptr)) != NULL; ptr++)
+	{
+		guint offset = ptr - start;
+
+		g_array_append_val (buffer->newlines, offset);
+	}
+
+	g_ptr_array_add (file->buffers, buffer);
+	g_ptr_array_sort (file->buffers, anjuta_token_file_compare_buffer);
+
+	return buffer;
+}
+
+static AnjutaTokenFileBuffer *
+anjuta_token_file_find_buffer (AnjutaTokenFile *file, const gchar *pos)
+{
+	guint low = 0;
+	guint high = file->buffers->len;
+	AnjutaTokenFileBuffer *buffer;
+
+	/* Find the last buffer starting before pos */
+	while (low < high)
+	{
+		guint mid = (low + high) / 2;
+
+		buffer = (AnjutaTokenFileBuffer *)g_ptr_array_index (file->buffers, mid);
+		if (buffer->start <= pos)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	if (low == 0) return NULL;
+
+	buffer = (AnjutaTokenFileBuffer *)g_ptr_array_index (file->buffers, low - 1);
+
+	return (pos < buffer->start + buffer->length) ? buffer : NULL;
+}
+
+/* Returns the number of new lines in buffer before offset */
+static guint
+anjuta_token_file_buffer_count_lines (AnjutaTokenFileBuffer *buffer, gsize offset)
+{
+	guint low = 0;
+	guint high = buffer->newlines->len;
+
+	while (low < high)
+	{
+		guint mid = (low + high) / 2;
+
+		if (g_array_index (buffer->newlines, guint, mid) < offset)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+/* Compute the position of all content tokens. It doesn't read the file data,
+ * new lines are already known for each memory block, so it is fast enough to
+ * be called after each update. */
+static void
+anjuta_token_file_update_index (AnjutaTokenFile *file)
+{
+	AnjutaToken *token;
+	gsize position = 0;
+	gsize offset = 0;
+	gsize line = 1;
+	gsize line_offset = 0;
+
+	if (file->index == NULL) return;
+
+	g_array_set_size (file->index, 0);
+	for (token = file->content; token != NULL; token = anjuta_token_next (token))
+	{
+		AnjutaTokenFileSegment segment;
+		gsize first;
+		guint begin;
+		guint end;
+
+		segment.length = anjuta_token_get_length (token);
+		if (segment.length == 0) continue;
+
+		segment.start = anjuta_token_get_string (token);
+		segment.position = position;
+		segment.offset = offset;
+		segment.line = line;
+		segment.line_offset = line_offset;
+		segment.removed = anjuta_token_get_flags (token) & ANJUTA_TOKEN_REMOVED ? TRUE : FALSE;
+		segment.buffer = anjuta_token_file_find_buffer (file, segment.start);
+		if (segment.buffer == NULL)
+		{
+			segment.buffer = anjuta_token_file_add_buffer (file, segment.start, segment.length);
+		}
+		g_array_append_val (file->index, segment);
+
+		position += segment.length;
+		if (segment.removed) continue;
+
+		first = segment.start - segment.buffer->start;
+		begin = anjuta_token_file_buffer_count_lines (segment.buffer, first);
+		end = anjuta_token_file_buffer_count_lines (segment.buffer, first + segment.length);
+		if (end > begin)
+		{
+			line += end - begin;
+			line_offset = offset + g_array_index (segment.buffer->newlines, guint, end - 1) - first + 1;
+		}
+		offset += segment.length;
+	}
+	g_array_sort (file->index, anjuta_token_file_compare_segment);
+}
+
+static AnjutaTokenFileSegment *
+anjuta_token_file_find_segment (AnjutaTokenFile *file, const gchar *pos)
+{
+	guint low = 0;
+	guint high;
+	AnjutaTokenFileSegment *segment;
+
+	if ((file->index == NULL) || (pos == NULL)) return NULL;
+
+	/* Find the last segment starting before pos */
+	high = file->index->len;
+	while (low < high)
+	{
+		guint mid = (low + high) / 2;
+
+		segment = &g_array_index (file->index, AnjutaTokenFileSegment, mid);
+		if (segment->start <= pos)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	if (low == 0) return NULL;
+
+	segment = &g_array_index (file->index, AnjutaTokenFileSegment, low - 1);
+
+	return (pos < segment->start + segment->length) ? segment : NULL;
+}
+
 static AnjutaToken*
 anjuta_token_file_find_position (AnjutaTokenFile *file, AnjutaToken *token)
 {
@@ -113,6 +332,13 @@ anjuta_token_file_load (AnjutaTokenFile *file, GError **error)
 	if (g_file_load_contents (file->file, NULL, &content, &length, NULL, error))
 	{
 		AnjutaToken *token;
+		AnjutaTokenPool *old_pool;
+
+		file->pool = anjuta_token_pool_new ();
+		old_pool = anjuta_token_pool_set_current (file->pool);
+		file->buffers = g_ptr_array_new_with_free_func ((GDestroyNotify)anjuta_token_file_buffer_free);
+		file->index = g_array_new (FALSE, FALSE, sizeof (AnjutaTokenFileSegment));
+		anjuta_token_file_add_buffer (file, content, length);
 
 		file->save = anjuta_token_new_static (ANJUTA_TOKEN_FILE,  NULL);
 		file->content = anjuta_token_new_static (ANJUTA_TOKEN_FILE,  NULL);
@@ -123,6 +349,9 @@ anjuta_token_file_load (AnjutaTokenFile *file, GError **error)
 		token =	anjuta_token_new_static (ANJUTA_TOKEN_FILE, content);
 		anjuta_token_prepend_child (file->content, token);
 		file->dirty = FALSE;
+
+		anjuta_token_pool_set_current (old_pool);
+		anjuta_token_file_update_index (file);
 	}
 	
 	return file->content;
@@ -131,12 +360,18 @@ anjuta_token_file_load (AnjutaTokenFile *file, GError **error)
 gboolean
 anjuta_token_file_unload (AnjutaTokenFile *file)
 {
-	if (file->content != NULL) anjuta_token_free (file->content);
+	/* Tokens are allocated in the pool, the other ones linked in its trees
+	 * are freed with it */
+	if (file->pool != NULL) anjuta_token_pool_free (file->pool);
+	file->pool = NULL;
 	file->content = NULL;
-	
-	if (file->save != NULL) anjuta_token_free (file->save);
 	file->save = NULL;
 
+	if (file->buffers != NULL) g_ptr_array_free (file->buffers, TRUE);
+	file->buffers = NULL;
+	if (file->index != NULL) g_array_free (file->index, TRUE);
+	file->index = NULL;
+
 	return TRUE;
 }
 
@@ -261,8 +496,10 @@ anjuta_token_file_update (AnjutaTokenFile *file, AnjutaToken *token)
 	AnjutaToken *prev;
 	AnjutaToken *next;
 	AnjutaToken *last;
+	AnjutaTokenPool *old_pool;
 	guint added;
 	gchar *value;
+	gchar *block = NULL;
 
 	/* Find all token needing an update */
 
@@ -299,6 +536,9 @@ anjuta_token_file_update (AnjutaTokenFile *file, AnjutaToken *token)
 		}
 		token = anjuta_token_next (token);
 	}
+
+	/* Allocate new tokens of the file content in the file pool */
+	old_pool = anjuta_token_pool_set_current (file->pool);
 	
 	/* Find previous token */
 	for (prev = token; prev != NULL; prev = anjuta_token_previous (prev))
@@ -327,6 +567,7 @@ anjuta_token_file_update (AnjutaTokenFile *file, AnjutaToken *token)
 		AnjutaToken *start = NULL;
 		
 		value = g_new (gchar, added);
+		block = value;
 		add = anjuta_token_prepend_child (file->save, anjuta_token_new_string_len (ANJUTA_TOKEN_NAME, value, added));
 		
 		/* Find token position */
@@ -372,6 +613,12 @@ anjuta_token_file_update (AnjutaTokenFile *file, AnjutaToken *token)
 		next = anjuta_token_next (next);
 	}
 
+	anjuta_token_pool_set_current (old_pool);
+
+	/* Update positions, only the new data has to be read */
+	if ((block != NULL) && (file->buffers != NULL)) anjuta_token_file_add_buffer (file, block, added);
+	anjuta_token_file_update_index (file);
+
 	file->dirty = TRUE;
 	
 	return TRUE;
@@ -391,10 +638,8 @@ anjuta_token_file_update (AnjutaTokenFile *file, AnjutaToken *token)
 gsize
 anjuta_token_file_get_token_position (AnjutaTokenFile *file, AnjutaToken *token)
 {
-	AnjutaToken *content;
+	AnjutaTokenFileSegment *segment;
 	const gchar *string;
-	gsize pos = 1;
-	
 
 	do
 	{
@@ -406,37 +651,24 @@ anjuta_token_file_get_token_position (AnjutaTokenFile *file, AnjutaToken *token)
 		token = anjuta_token_next_after_children (token);
 	} while (token != NULL);
 
-	for (content = file->content; content != NULL; content = anjuta_token_next (content))
-	{
-		const gchar *start;
-		gsize len;
-
-		start = anjuta_token_get_string (content); 
-		len = anjuta_token_get_length (content);
+	segment = anjuta_token_file_find_segment (file, string);
 
-		if ((string >= start) && ((string - start) < len))
-		{
-			pos += string - start;
-			break;
-		}
-		else
-		{
-			pos += len;
-		}
-	}
-
-	return content == NULL ? 0 : pos;
+	return segment == NULL ? 0 : segment->position + (string - segment->start) + 1;
 }
 
 
 gboolean
 anjuta_token_file_get_token_location (AnjutaTokenFile *file, AnjutaTokenFileLocation *location, AnjutaToken *token)
 {
-	AnjutaTokenFileLocation loc = {NULL, 1, 1};
-	AnjutaToken *pos;
+	AnjutaTokenFileSegment *segment;
 	const gchar *target;
+	gsize first;
+	guint begin;
+	guint end;
+	gsize line;
+	gsize line_offset;
+	gsize offset;
 
-	anjuta_token_dump (token);
 	do
 	{
 		target = anjuta_token_get_string (token); 
@@ -447,45 +679,57 @@ anjuta_token_file_get_token_location (AnjutaTokenFile *file, AnjutaTokenFileLoca
 		token = anjuta_token_next_after_children (token);
 	} while (token != NULL);
 
-	for (pos = file->content; pos != NULL; pos = anjuta_token_next (pos))
+	segment = anjuta_token_file_find_segment (file, target);
+	if ((segment == NULL) || segment->removed) return FALSE;
+
+	/* Count new lines in the segment before the target */
+	first = segment->start - segment->buffer->start;
+	begin = anjuta_token_file_buffer_count_lines (segment->buffer, first);
+	end = anjuta_token_file_buffer_count_lines (segment->buffer, target - segment->buffer->start);
+	line = segment->line + end - begin;
+	if (end > begin)
 	{
-		if (!(anjuta_token_get_flags (pos) & ANJUTA_TOKEN_REMOVED) && (anjuta_token_get_length (pos) > 0))
-		{
-			const gchar *ptr;
-			const gchar *end;
+		line_offset = segment->offset + g_array_index (segment->buffer->newlines, guint, end - 1) - first + 1;
+	}
+	else
+	{
+		line_offset = segment->line_offset;
+	}
+	offset = segment->offset + (target - segment->start);
 
-			ptr = anjuta_token_get_string (pos);
-			end = ptr + anjuta_token_get_length (pos);
-			
-			for (; ptr != end; ptr++)
-			{
-				if (*ptr == '\n')
-				{
-					/* New line */
-					loc.line++;
-					loc.column = 1;
-				}
-				else
-				{
-					loc.column++;
-				}
-					
-				if (ptr == target)
-				{
-					if (location != NULL)
-					{
-						location->filename = file->file == NULL ? NULL : g_file_get_parse_name (file->file);
-						location->line = loc.line;
-						location->column = loc.column;
-					}
-
-					return TRUE;
-				}
-			}
+	if (location != NULL)
+	{
+		location->filename = file->file == NULL ? NULL : g_file_get_parse_name (file->file);
+		if (*target == '\n')
+		{
+			/* New line */
+			location->line = line + 1;
+			location->column = 1;
+		}
+		else
+		{
+			location->line = line;
+			location->column = offset - line_offset + 2;
 		}
 	}
 
-	return FALSE;
+	return TRUE;
+}
+
+/**
+ * anjuta_token_file_get_pool:
+ * @file: #AnjutaTokenFile object
+ *
+ * Returns the pool used to allocate the tokens of the file. It can be set as
+ * the current pool while parsing the file content, so the whole token tree
+ * is released with the file.
+ *
+ * Returns: The pool of the file or %NULL if the file is not loaded.
+ */
+AnjutaTokenPool *
+anjuta_token_file_get_pool (AnjutaTokenFile *file)
+{
+	return file->pool;
 }
 
 GFile*
@@ -541,6 +785,9 @@ anjuta_token_file_instance_init (AnjutaTokenFile *file)
 	file->file = NULL;
 	file->content = NULL;
 	file->save = NULL;
+	file->pool = NULL;
+	file->buffers = NULL;
+	file->index = NULL;
 }
 
 /* class_init intialize the class itself not the instance */
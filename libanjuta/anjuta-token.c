@@ -65,6 +65,13 @@
  * end in another included file. The grouping can be nested too. Typically
  * we can have a group representing a command, a sub group representing the
  * arguments and then one sub group for each argument.
+ *
+ * Tokens are normally allocated one by one. When a #AnjutaTokenPool is set
+ * as the current pool of the calling thread, tokens are allocated in blocks
+ * from this pool instead. Such token can still be freed and unlinked
+ * individually but their memory is only released with the whole pool. It is
+ * used to allocate all tokens of a file, which are then released in one
+ * operation when the file is unloaded.
  */
 
 /*
@@ -127,9 +134,46 @@ struct _AnjutaToken
 	AnjutaTokenData data;
 };
 
+#define ANJUTA_TOKEN_POOL_BLOCK_SIZE	512
+
+struct _AnjutaTokenPool
+{
+	GSList *blocks;		/* Allocated token blocks, the first one is the current */
+	guint used;			/* Number of tokens used in the current block */
+};
+
+static GStaticPrivate anjuta_token_current_pool = G_STATIC_PRIVATE_INIT;
+
 /* Helpers functions
  *---------------------------------------------------------------------------*/
 
+static AnjutaToken *
+anjuta_token_alloc (void)
+{
+	AnjutaTokenPool *pool;
+	AnjutaToken *token;
+
+	pool = (AnjutaTokenPool *)g_static_private_get (&anjuta_token_current_pool);
+	if (pool == NULL)
+	{
+		token = g_slice_new0 (AnjutaToken);
+	}
+	else
+	{
+		if ((pool->blocks == NULL) || (pool->used == ANJUTA_TOKEN_POOL_BLOCK_SIZE))
+		{
+			pool->blocks = g_slist_prepend (pool->blocks, g_new (AnjutaToken, ANJUTA_TOKEN_POOL_BLOCK_SIZE));
+			pool->used = 0;
+		}
+		token = ((AnjutaToken *)pool->blocks->data) + pool->used;
+		pool->used++;
+		memset (token, 0, sizeof (AnjutaToken));
+		token->data.flags = ANJUTA_TOKEN_POOLED;
+	}
+
+	return token;
+}
+
 /* Private functions
  *---------------------------------------------------------------------------*/
 
@@ -188,9 +232,9 @@ anjuta_token_copy (AnjutaToken *token)
 
 	if (token != NULL)
 	{
-		copy = g_slice_new0 (AnjutaToken);
+		copy = anjuta_token_alloc ();
 		copy->data.type = token->data.type;
-		copy->data.flags = token->data.flags;
+		copy->data.flags |= token->data.flags & ~ANJUTA_TOKEN_POOLED;
 		if ((copy->data.flags & ANJUTA_TOKEN_STATIC) || (token->data.pos == NULL))
 		{
 			copy->data.pos = token->data.pos;
@@ -1690,9 +1734,9 @@ AnjutaToken *anjuta_token_new_string (AnjutaTokenType type, const gchar *value)
 	}
 	else
 	{
-		token = g_slice_new0 (AnjutaToken);
+		token = anjuta_token_alloc ();
 		token->data.type = type  & ANJUTA_TOKEN_TYPE;
-		token->data.flags = type & ANJUTA_TOKEN_FLAGS;
+		token->data.flags |= type & ANJUTA_TOKEN_FLAGS;
 		token->data.pos = g_strdup (value);
 		token->data.length = strlen (value);
 	}
@@ -1711,9 +1755,9 @@ anjuta_token_new_string_len (AnjutaTokenType type, gchar *value, gsize length)
 	}
 	else
 	{
-		token = g_slice_new0 (AnjutaToken);
+		token = anjuta_token_alloc ();
 		token->data.type = type  & ANJUTA_TOKEN_TYPE;
-		token->data.flags = type & ANJUTA_TOKEN_FLAGS;
+		token->data.flags |= type & ANJUTA_TOKEN_FLAGS;
 		token->data.pos = value;
 		token->data.length = length;
 	}
@@ -1726,9 +1770,9 @@ anjuta_token_new_static_len (gint type, const gchar *pos, gsize length)
 {
 	AnjutaToken *token;
 
-	token = g_slice_new0 (AnjutaToken);
+	token = anjuta_token_alloc ();
 	token->data.type = type  & ANJUTA_TOKEN_TYPE;
-	token->data.flags = (type & ANJUTA_TOKEN_FLAGS) | ANJUTA_TOKEN_STATIC;
+	token->data.flags |= (type & ANJUTA_TOKEN_FLAGS) | ANJUTA_TOKEN_STATIC;
 	token->data.pos = (gchar *)pos;
 	token->data.length = length;
 
@@ -1776,7 +1820,16 @@ free_token (AnjutaToken *token, gpointer user_data)
 	{
 		g_free (token->data.pos);
 	}
-	g_slice_free (AnjutaToken, token);
+	if (token->data.flags & ANJUTA_TOKEN_POOLED)
+	{
+		/* Memory is released with the pool, just mark it as unused */
+		memset (token, 0, sizeof (AnjutaToken));
+		token->data.flags = ANJUTA_TOKEN_POOLED | ANJUTA_TOKEN_STATIC;
+	}
+	else
+	{
+		g_slice_free (AnjutaToken, token);
+	}
 }
 
 
@@ -1791,3 +1844,149 @@ anjuta_token_free (AnjutaToken *token)
 
 	return next;
 }
+
+/* Token pool
+ *---------------------------------------------------------------------------*/
+
+/**
+ * anjuta_token_pool_new:
+ *
+ * Create a new empty token pool.
+ *
+ * Return value: The newly created pool.
+ */
+AnjutaTokenPool *
+anjuta_token_pool_new (void)
+{
+	return g_slice_new0 (AnjutaTokenPool);
+}
+
+static void
+anjuta_token_pool_add_foreign (GHashTable *foreign, GQueue *pending, AnjutaToken *token)
+{
+	if ((token != NULL) &&
+	    !(token->data.flags & ANJUTA_TOKEN_POOLED) &&
+	    (g_hash_table_lookup (foreign, token) == NULL))
+	{
+		g_hash_table_insert (foreign, token, token);
+		g_queue_push_tail (pending, token);
+	}
+}
+
+static void
+anjuta_token_pool_add_linked (GHashTable *foreign, GQueue *pending, AnjutaToken *token)
+{
+	anjuta_token_pool_add_foreign (foreign, pending, token->next);
+	anjuta_token_pool_add_foreign (foreign, pending, token->prev);
+	anjuta_token_pool_add_foreign (foreign, pending, token->parent);
+	anjuta_token_pool_add_foreign (foreign, pending, token->children);
+}
+
+/* Free tokens allocated outside the pool, like the ones added by the
+ * project writers, which are linked in the trees of the pool */
+static void
+anjuta_token_pool_free_foreign (AnjutaTokenPool *pool)
+{
+	GHashTable *foreign;
+	GQueue pending = G_QUEUE_INIT;
+	GHashTableIter iter;
+	GSList *block;
+	guint used;
+	AnjutaToken *token;
+
+	foreign = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	used = pool->used;
+	for (block = pool->blocks; block != NULL; block = g_slist_next (block))
+	{
+		AnjutaToken *end;
+
+		token = (AnjutaToken *)block->data;
+		for (end = token + used; token != end; token++)
+		{
+			anjuta_token_pool_add_linked (foreign, &pending, token);
+		}
+		used = ANJUTA_TOKEN_POOL_BLOCK_SIZE;
+	}
+	while ((token = (AnjutaToken *)g_queue_pop_head (&pending)) != NULL)
+	{
+		anjuta_token_pool_add_linked (foreign, &pending, token);
+	}
+
+	g_hash_table_iter_init (&iter, foreign);
+	while (g_hash_table_iter_next (&iter, (gpointer *)&token, NULL))
+	{
+		if ((token->data.pos != NULL) && !(token->data.flags & ANJUTA_TOKEN_STATIC))
+		{
+			g_free (token->data.pos);
+		}
+		g_slice_free (AnjutaToken, token);
+	}
+	g_hash_table_destroy (foreign);
+}
+
+/**
+ * anjuta_token_pool_free:
+ * @pool: a #AnjutaTokenPool object.
+ *
+ * Release all tokens allocated from the pool, including the strings they
+ * own. None of these tokens can be used after this call. Tokens allocated
+ * outside the pool and linked in one of its trees are freed too.
+ */
+void
+anjuta_token_pool_free (AnjutaTokenPool *pool)
+{
+	GSList *block;
+	guint used;
+
+	if (pool == NULL) return;
+
+	if (g_static_private_get (&anjuta_token_current_pool) == pool)
+	{
+		g_static_private_set (&anjuta_token_current_pool, NULL, NULL);
+	}
+
+	anjuta_token_pool_free_foreign (pool);
+
+	used = pool->used;
+	for (block = pool->blocks; block != NULL; block = g_slist_next (block))
+	{
+		AnjutaToken *token = (AnjutaToken *)block->data;
+		AnjutaToken *end = token + used;
+
+		for (; token != end; token++)
+		{
+			if ((token->data.pos != NULL) && !(token->data.flags & ANJUTA_TOKEN_STATIC))
+			{
+				g_free (token->data.pos);
+			}
+		}
+		g_free (block->data);
+
+		/* Only the first block is partially used */
+		used = ANJUTA_TOKEN_POOL_BLOCK_SIZE;
+	}
+	g_slist_free (pool->blocks);
+	g_slice_free (AnjutaTokenPool, pool);
+}
+
+/**
+ * anjuta_token_pool_set_current:
+ * @pool: (allow-none): a #AnjutaTokenPool object or %NULL.
+ *
+ * Allocate all tokens created afterward by the calling thread from @pool.
+ * If @pool is %NULL, tokens are allocated individually.
+ *
+ * Return value: The previous current pool, which should be restored
+ * afterward.
+ */
+AnjutaTokenPool *
+anjuta_token_pool_set_current (AnjutaTokenPool *pool)
+{
+	AnjutaTokenPool *old;
+
+	old = (AnjutaTokenPool *)g_static_private_get (&anjuta_token_current_pool);
+	g_static_private_set (&anjuta_token_current_pool, pool, NULL);
+
+	return old;
+}
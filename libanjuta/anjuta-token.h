@@ -80,11 +80,13 @@ typedef enum
 	ANJUTA_TOKEN_CASE_INSENSITIVE 		= 1 << 24,
 	ANJUTA_TOKEN_STATIC 							= 1 << 25,
 	ANJUTA_TOKEN_REMOVED						= 1 << 26,
-	ANJUTA_TOKEN_ADDED							= 1 << 27
+	ANJUTA_TOKEN_ADDED							= 1 << 27,
+	ANJUTA_TOKEN_POOLED							= 1 << 28
 	
 } AnjutaTokenType;
 
 typedef struct _AnjutaToken AnjutaToken;
+typedef struct _AnjutaTokenPool AnjutaTokenPool;
 
 typedef void (*AnjutaTokenForeachFunc) (AnjutaToken *token, gpointer data);
 
@@ -97,6 +99,10 @@ AnjutaToken *anjuta_token_new_static_len (gint type, const gchar *pos, gsize len
 AnjutaToken* anjuta_token_free_children (AnjutaToken *token);
 AnjutaToken* anjuta_token_free (AnjutaToken *token);
 
+AnjutaTokenPool *anjuta_token_pool_new (void);
+void anjuta_token_pool_free (AnjutaTokenPool *pool);
+AnjutaTokenPool *anjuta_token_pool_set_current (AnjutaTokenPool *pool);
+
 void anjuta_token_set_type (AnjutaToken *token, gint type);
 gint anjuta_token_get_type (AnjutaToken *token);
 void anjuta_token_set_flags (AnjutaToken *token, gint flags);
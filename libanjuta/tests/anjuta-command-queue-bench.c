@@ -0,0 +1,163 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * anjuta-command-queue-bench.c
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "libanjuta/anjuta-command-queue.h"
+#include "libanjuta/anjuta-async-command.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Measure the time needed to run many independent asynchronous commands,
+ * like searching in all files of a project, one at a time and on all
+ * processors. The last run cancels the queue after the first command.
+ *
+ * Usage: anjuta-command-queue-bench [number of commands] [work size]
+ *---------------------------------------------------------------------------*/
+
+/* Command doing some computation */
+
+typedef struct
+{
+	AnjutaAsyncCommand parent;
+	guint size;
+	guint result;
+} BenchCommand;
+
+typedef struct
+{
+	AnjutaAsyncCommandClass parent_class;
+} BenchCommandClass;
+
+static GType bench_command_get_type (void);
+
+G_DEFINE_TYPE (BenchCommand, bench_command, ANJUTA_TYPE_ASYNC_COMMAND);
+
+static guint
+bench_command_run (AnjutaCommand *command)
+{
+	BenchCommand *self = (BenchCommand *)command;
+	guint hash = 0;
+	guint i;
+
+	for (i = 0; i < self->size; i++)
+		hash = hash * 31 + i;
+	self->result = hash;
+
+	return 0;
+}
+
+static void
+bench_command_init (BenchCommand *self)
+{
+}
+
+static void
+bench_command_class_init (BenchCommandClass *klass)
+{
+	ANJUTA_COMMAND_CLASS (klass)->run = bench_command_run;
+}
+
+/* Bench */
+
+typedef struct
+{
+	GMainLoop *loop;
+	AnjutaCommandQueue *queue;
+	guint finished;
+	gboolean cancel;
+} BenchData;
+
+static void
+on_command_finished (AnjutaCommand *command, guint return_code, gpointer user_data)
+{
+	BenchData *data = (BenchData *)user_data;
+
+	data->finished++;
+	if (data->cancel && (data->finished == 1))
+		anjuta_command_queue_cancel (data->queue);
+}
+
+static void
+on_queue_finished (AnjutaCommandQueue *queue, gpointer user_data)
+{
+	BenchData *data = (BenchData *)user_data;
+
+	g_main_loop_quit (data->loop);
+}
+
+static gboolean
+run_queue (guint n_commands, guint size, guint max_running, gboolean cancel)
+{
+	BenchData data;
+	GTimer *timer;
+	guint i;
+	gboolean ok;
+
+	data.loop = g_main_loop_new (NULL, FALSE);
+	data.queue = anjuta_command_queue_new (ANJUTA_COMMAND_QUEUE_EXECUTE_MANUAL);
+	data.finished = 0;
+	data.cancel = cancel;
+	anjuta_command_queue_set_max_running (data.queue, max_running);
+	g_signal_connect (data.queue, "finished", G_CALLBACK (on_queue_finished), &data);
+
+	for (i = 0; i < n_commands; i++)
+	{
+		BenchCommand *command;
+
+		command = g_object_new (bench_command_get_type (), NULL);
+		command->size = size;
+		g_signal_connect (command, "command-finished", G_CALLBACK (on_command_finished), &data);
+		anjuta_command_queue_push (data.queue, ANJUTA_COMMAND (command));
+		g_object_unref (command);
+	}
+
+	timer = g_timer_new ();
+	if (anjuta_command_queue_start (data.queue)) g_main_loop_run (data.loop);
+	fprintf (stdout, "%s%u running: %u/%u commands finished in %g s\n",
+	         cancel ? "cancel, " : "", max_running,
+	         data.finished, n_commands, g_timer_elapsed (timer, NULL));
+
+	ok = cancel ? (data.finished >= 1) && (data.finished < n_commands) : (data.finished == n_commands);
+	fprintf (stdout, "all commands finished %d\n", ok);
+
+	g_timer_destroy (timer);
+	g_object_unref (data.queue);
+	g_main_loop_unref (data.loop);
+
+	return ok;
+}
+
+int
+main(int argc, char *argv[])
+{
+	guint n_commands = argc > 1 ? atoi (argv[1]) : 200;
+	guint size = argc > 2 ? atoi (argv[2]) : 2000000;
+	gboolean ok;
+
+	/* Initialize program */
+	g_type_init ();
+	if (!g_thread_supported ()) g_thread_init (NULL);
+
+	ok = run_queue (n_commands, size, 1, FALSE);
+	ok = run_queue (n_commands, size, 0, FALSE) && ok;
+	ok = run_queue (n_commands, size, 1, TRUE) && ok;
+
+	return ok ? 0 : 1;
+}
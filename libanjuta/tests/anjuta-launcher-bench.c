@@ -0,0 +1,188 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * anjuta-launcher-bench.c
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "libanjuta/anjuta-launcher.h"
+#include "libanjuta/anjuta-debug.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Measure the time needed to split in lines the output of a child writing a
+ * lot of data, like a verbose build, with the output and the lines callback.
+ *
+ * The last run enables the flow control and releases lines in an idle
+ * callback like a slow user interface would do.
+ *
+ * Usage: anjuta-launcher-bench [number of lines] [read size] [high water mark]
+ *---------------------------------------------------------------------------*/
+
+typedef struct
+{
+	GMainLoop *loop;
+	AnjutaLauncher *launcher;
+	gsize unreleased;
+	guint release_idle;
+	gdouble blocked_time;
+	guint callbacks;
+	guint lines;
+	gsize bytes;
+	gboolean complete;
+} BenchData;
+
+static void
+on_output (AnjutaLauncher *launcher, AnjutaLauncherOutputType output_type,
+		   const gchar *chars, gpointer user_data)
+{
+	BenchData *data = (BenchData *)user_data;
+	const gchar *ptr;
+	gsize len = strlen (chars);
+
+	data->callbacks++;
+	data->bytes += len;
+	for (ptr = chars; (ptr = memchr (ptr, '\n', chars + len - ptr)) != NULL; ptr++)
+	{
+		data->lines++;
+	}
+	/* Buffered output delivers only complete lines */
+	if ((len > 0) && (chars[len - 1] != '\n')) data->complete = FALSE;
+}
+
+static void
+on_lines (AnjutaLauncher *launcher, AnjutaLauncherOutputType output_type,
+		  const gchar * const *lines, guint n_lines, gpointer user_data)
+{
+	BenchData *data = (BenchData *)user_data;
+	guint i;
+
+	data->callbacks++;
+	data->lines += n_lines;
+	for (i = 0; i < n_lines; i++)
+	{
+		data->bytes += strlen (lines[i]) + 1;
+		if (strchr (lines[i], '\n') != NULL) data->complete = FALSE;
+	}
+	if (lines[n_lines] != NULL) data->complete = FALSE;
+}
+
+static gboolean
+on_release_idle (gpointer user_data)
+{
+	BenchData *data = (BenchData *)user_data;
+
+	anjuta_launcher_release_output (data->launcher, data->unreleased);
+	data->unreleased = 0;
+	data->release_idle = 0;
+
+	return FALSE;
+}
+
+static void
+on_delayed_lines (AnjutaLauncher *launcher, AnjutaLauncherOutputType output_type,
+				  const gchar * const *lines, guint n_lines, gpointer user_data)
+{
+	BenchData *data = (BenchData *)user_data;
+	gsize bytes = data->bytes;
+
+	on_lines (launcher, output_type, lines, n_lines, user_data);
+	data->unreleased += data->bytes - bytes;
+	if (data->release_idle == 0)
+		data->release_idle = g_idle_add (on_release_idle, data);
+}
+
+static void
+on_child_exited (AnjutaLauncher *launcher, gint child_pid, gint status,
+				 gulong time, gpointer user_data)
+{
+	BenchData *data = (BenchData *)user_data;
+
+	data->blocked_time = anjuta_launcher_get_blocked_time (launcher);
+	if (data->release_idle != 0) g_source_remove (data->release_idle);
+	g_main_loop_quit (data->loop);
+}
+
+static gboolean
+run_command (const gchar *command, gsize read_size, gboolean by_lines, gsize high_water, guint lines)
+{
+	AnjutaLauncher *launcher;
+	BenchData data;
+	GTimer *timer;
+	gboolean ok;
+
+	memset (&data, 0, sizeof (data));
+	data.loop = g_main_loop_new (NULL, FALSE);
+	data.complete = TRUE;
+
+	launcher = anjuta_launcher_new ();
+	data.launcher = launcher;
+	anjuta_launcher_set_buffered_output (launcher, TRUE);
+	if (read_size > 0) anjuta_launcher_set_read_size (launcher, read_size);
+	anjuta_launcher_set_high_water_mark (launcher, high_water);
+	g_signal_connect (G_OBJECT (launcher), "child-exited",
+					  G_CALLBACK (on_child_exited), &data);
+
+	timer = g_timer_new ();
+	if (by_lines)
+		ok = anjuta_launcher_execute_lines (launcher, command,
+											high_water > 0 ? on_delayed_lines : on_lines,
+											&data);
+	else
+		ok = anjuta_launcher_execute (launcher, command, on_output, &data);
+	if (ok) g_main_loop_run (data.loop);
+	fprintf (stdout, "%s: read %u lines, %" G_GSIZE_FORMAT " bytes in %u callbacks: %g s (blocked %g s)\n",
+			 by_lines ? "lines" : "output",
+			 data.lines, data.bytes, data.callbacks, g_timer_elapsed (timer, NULL),
+			 data.blocked_time);
+
+	ok = ok && (data.lines == lines) && data.complete;
+	fprintf (stdout, "all lines complete %d\n", ok);
+
+	g_timer_destroy (timer);
+	g_object_unref (launcher);
+	g_main_loop_unref (data.loop);
+
+	return ok;
+}
+
+int
+main(int argc, char *argv[])
+{
+	guint lines = argc > 1 ? atoi (argv[1]) : 200000;
+	gsize read_size = argc > 2 ? atoi (argv[2]) : 0;
+	gsize high_water = argc > 3 ? atoi (argv[3]) : 64 * 1024;
+	gchar *command;
+	gboolean ok;
+
+	/* Initialize program */
+	g_type_init ();
+
+	anjuta_debug_init ();
+
+	/* Write lines looking like compiler output */
+	command = g_strdup_printf ("sh -c 'i=0; while [ $i -lt %u ]; do echo \"src/file$i.c:$i:1: warning: unused variable [-Wunused-variable]\"; i=$((i+1)); done'", lines);
+
+	ok = run_command (command, read_size, FALSE, 0, lines);
+	ok = run_command (command, read_size, TRUE, 0, lines) && ok;
+	ok = run_command (command, read_size, TRUE, high_water, lines) && ok;
+
+	g_free (command);
+
+	return ok ? 0 : 1;
+}
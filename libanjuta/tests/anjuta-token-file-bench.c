@@ -0,0 +1,154 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * anjuta-token-file-bench.c
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "libanjuta/anjuta-token.h"
+#include "libanjuta/anjuta-token-file.h"
+#include "libanjuta/anjuta-debug.h"
+
+#include <glib/gstdio.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Measure token position and location lookups in a big file. Each line of the
+ * file is represented by one token, like a parser would do.
+ *
+ * Usage: anjuta-token-file-bench [number of lines]
+ *---------------------------------------------------------------------------*/
+
+static gboolean
+check_location (AnjutaTokenFile *tfile, AnjutaToken *token, guint line, guint column)
+{
+	AnjutaTokenFileLocation location;
+
+	if (!anjuta_token_file_get_token_location (tfile, &location, token)) return FALSE;
+	g_free (location.filename);
+
+	return (location.line == line) && (location.column == column);
+}
+
+int
+main(int argc, char *argv[])
+{
+	guint lines = argc > 1 ? atoi (argv[1]) : 50000;
+	GString *data;
+	gchar *filename;
+	gint fd;
+	GFile *file;
+	AnjutaTokenFile *tfile;
+	AnjutaToken *content;
+	AnjutaToken *root;
+	AnjutaToken *added;
+	AnjutaToken **tokens;
+	const gchar *ptr;
+	const gchar *end;
+	GTimer *timer;
+	gsize sum;
+	guint i;
+	gboolean ok = TRUE;
+
+	/* Initialize program */
+	g_type_init ();
+
+	anjuta_debug_init ();
+
+	/* Create a Makefile.am like file */
+	data = g_string_new (NULL);
+	for (i = 0; i < lines; i++)
+	{
+		g_string_append_printf (data, "libfoo_la_SOURCES += source%u.c source%u.h\n", i, i);
+	}
+	fd = g_file_open_tmp ("anjuta-token-file-bench-XXXXXX", &filename, NULL);
+	if (fd == -1) return 1;
+	close (fd);
+	g_file_set_contents (filename, data->str, data->len, NULL);
+	g_string_free (data, TRUE);
+
+	file = g_file_new_for_path (filename);
+	tfile = anjuta_token_file_new (file);
+
+	timer = g_timer_new ();
+	content = anjuta_token_file_load (tfile, NULL);
+	fprintf (stdout, "load %u lines: %g s\n", lines, g_timer_elapsed (timer, NULL));
+
+	/* One token per line */
+	content = anjuta_token_next (content);
+	root = anjuta_token_new_static (ANJUTA_TOKEN_FILE, NULL);
+	tokens = g_new (AnjutaToken *, lines);
+	ptr = anjuta_token_get_string (content);
+	end = ptr + anjuta_token_get_length (content);
+	for (i = 0; i < lines; i++)
+	{
+		const gchar *next = (const gchar *)memchr (ptr, '\n', end - ptr) + 1;
+
+		tokens[i] = anjuta_token_append_child (root, anjuta_token_new_static_len (ANJUTA_TOKEN_NAME, ptr, next - ptr));
+		ptr = next;
+	}
+
+	/* Position of all tokens */
+	g_timer_start (timer);
+	sum = 0;
+	for (i = 0; i < lines; i++)
+	{
+		sum += anjuta_token_file_get_token_position (tfile, tokens[i]);
+	}
+	fprintf (stdout, "position of %u tokens: %g s (%" G_GSIZE_FORMAT ")\n", lines, g_timer_elapsed (timer, NULL), sum);
+
+	/* Location of all tokens */
+	g_timer_start (timer);
+	for (i = 0; i < lines; i++)
+	{
+		ok = ok && check_location (tfile, tokens[i], i + 1, 2);
+	}
+	fprintf (stdout, "location of %u tokens: %g s %d\n", lines, g_timer_elapsed (timer, NULL), ok);
+
+	/* Insert a line in the middle of the file */
+	i = lines / 2;
+	added = anjuta_token_insert_after (tokens[i], anjuta_token_new_string (ANJUTA_TOKEN_NAME | ANJUTA_TOKEN_ADDED, "libfoo_la_SOURCES += added.c\n"));
+	g_timer_start (timer);
+	ok = ok && anjuta_token_file_update (tfile, added);
+	fprintf (stdout, "update: %g s %d\n", g_timer_elapsed (timer, NULL), ok);
+
+	ok = ok && check_location (tfile, tokens[i], i + 1, 2);
+	ok = ok && check_location (tfile, added, i + 2, 2);
+	ok = ok && (i + 1 >= lines || check_location (tfile, tokens[i + 1], i + 3, 2));
+	ok = ok && (anjuta_token_file_get_token_position (tfile, added) < anjuta_token_file_get_token_position (tfile, tokens[lines - 1]));
+	fprintf (stdout, "location after update %d\n", ok);
+
+	/* Location of all tokens after update */
+	g_timer_start (timer);
+	for (i = 0; i < lines; i++)
+	{
+		ok = ok && check_location (tfile, tokens[i], i <= lines / 2 ? i + 1 : i + 2, 2);
+	}
+	fprintf (stdout, "location of %u tokens after update: %g s %d\n", lines, g_timer_elapsed (timer, NULL), ok);
+
+	g_timer_destroy (timer);
+	g_free (tokens);
+	anjuta_token_free (root);
+	anjuta_token_file_free (tfile);
+	g_object_unref (file);
+	g_unlink (filename);
+	g_free (filename);
+
+	return ok ? 0 : 1;
+}
@@ -36,8 +36,11 @@ main(int argc, char *argv[])
 {
 	AnjutaToken *list;
 	AnjutaToken *token;
+	AnjutaTokenPool *pool;
+	AnjutaTokenPool *old_pool;
 	gchar *value;
 	gboolean ok;
+	gint i;
 
 	/* Initialize program */
 	g_type_init ();
@@ -202,5 +205,26 @@ main(int argc, char *argv[])
 	fprintf(stdout, "%s %d\n", value, ok);
 	g_free (value);
 
+	// Check tokens allocated in a pool
+	pool = anjuta_token_pool_new ();
+	old_pool = anjuta_token_pool_set_current (pool);
+	list = anjuta_token_new_string (ANJUTA_TOKEN_NAME, "pip");
+	ok = ok && (anjuta_token_get_flags (list) & ANJUTA_TOKEN_POOLED);
+	for (i = 0; i < 1000; i++)
+	{
+		anjuta_token_append_child (list, anjuta_token_new_string (ANJUTA_TOKEN_NAME, "pop"));
+	}
+	anjuta_token_free (anjuta_token_next (list));
+	anjuta_token_pool_set_current (old_pool);
+	token = anjuta_token_new_static (ANJUTA_TOKEN_NAME, "pup");
+	ok = ok && !(anjuta_token_get_flags (token) & ANJUTA_TOKEN_POOLED);
+	anjuta_token_append_child (list, token);
+	value = anjuta_token_evaluate (list);
+	ok = ok && (strlen (value) == 999 * 3 + 3) && g_str_has_suffix (value, "poppup");
+	fprintf(stdout, "%s %d\n", value, ok);
+	g_free (value);
+	/* The token allocated outside the pool is freed with it */
+	anjuta_token_pool_free (pool);
+
 	return ok ? 0 : 1;
 }
@@ -85,6 +85,11 @@ struct _AmpProject {
 	/* Command queue */
 	PmCommandQueue *queue;
 
+	/* Makefiles loaded in other threads */
+	GMutex *lock;
+	GCond *loaded;
+	gint pending;
+
 	/* Language Manager */
 	IAnjutaLanguage *lang_manager;
 };
@@ -74,6 +74,9 @@ const gchar *valid_am_makefiles[] = {"GNUmakefile.am", "makefile.am", "Makefile.
 #define STR_REPLACE(target, source) \
 	{ g_free (target); target = source == NULL ? NULL : g_strdup (source);}
 
+/* Default number of threads used to parse makefiles */
+#define AMP_LOAD_THREADS	4
+
 
 typedef struct _AmpConfigFile AmpConfigFile;
 
@@ -82,6 +85,17 @@ struct _AmpConfigFile {
 	AnjutaToken *token;
 };
 
+typedef struct _AmpLoadTask AmpLoadTask;
+
+struct _AmpLoadTask {
+	AmpProject *project;
+	AmpGroupNode *group;
+};
+
+static gint amp_load_threads = AMP_LOAD_THREADS;
+static GThreadPool *amp_load_pool = NULL;
+G_LOCK_DEFINE_STATIC (amp_load_pool);
+
 /* Node types
  *---------------------------------------------------------------------------*/
 
@@ -484,10 +498,10 @@ amp_config_file_free (AmpConfigFile *config)
 static void
 amp_project_clear (AmpProject *project)
 {
+	/* configure tokens are allocated in the configure file pool */
+	project->configure_token = NULL;
 	if (project->configure_file != NULL) anjuta_token_file_free (project->configure_file);
 	project->configure_file = NULL;
-	if (project->configure_token) anjuta_token_free (project->configure_token);
-	project->configure_token = NULL;
 }
 
 static void
@@ -516,6 +530,8 @@ AnjutaTokenFile*
 amp_project_set_configure (AmpProject *project, GFile *configure)
 {
 	if (project->configure != NULL) g_object_unref (project->configure);
+	/* configure tokens are allocated in the configure file pool */
+	project->configure_token = NULL;
 	if (project->configure_file != NULL) anjuta_token_file_free (project->configure_file);
 	if (project->monitor) g_object_unref (project->monitor);
 	if (configure != NULL)
@@ -574,7 +590,9 @@ remove_config_file (gpointer data, GObject *object)
 
 	g_return_if_fail (project->files != NULL);
 
+	g_mutex_lock (project->lock);
 	project->files = g_list_remove (project->files, object);
+	g_mutex_unlock (project->lock);
 }
 
 void
@@ -1335,6 +1353,63 @@ find_group (AnjutaProjectNode *node, gpointer data)
 	return FALSE;
 }
 
+static void
+amp_load_group_thread (AmpLoadTask *task, gpointer user_data)
+{
+	AmpProject *project = task->project;
+
+	amp_node_load (AMP_NODE (task->group), NULL, project, NULL);
+	g_slice_free (AmpLoadTask, task);
+
+	g_mutex_lock (project->lock);
+	if (--project->pending == 0) g_cond_broadcast (project->loaded);
+	g_mutex_unlock (project->lock);
+}
+
+/* Load a group, in another thread if possible. A group appends its children
+ * itself in the order of the SUBDIRS variable, so the tree does not depend
+ * on the order of the threads. */
+static void
+amp_project_load_group (AmpProject *project, AmpGroupNode *group)
+{
+	AmpLoadTask *task;
+
+	if (amp_load_threads > 1)
+	{
+		G_LOCK (amp_load_pool);
+		if (amp_load_pool == NULL)
+		{
+			amp_load_pool = g_thread_pool_new ((GFunc)amp_load_group_thread, NULL, amp_load_threads, FALSE, NULL);
+		}
+		G_UNLOCK (amp_load_pool);
+	}
+
+	if ((amp_load_threads <= 1) || (amp_load_pool == NULL))
+	{
+		amp_node_load (AMP_NODE (group), NULL, project, NULL);
+		return;
+	}
+
+	task = g_slice_new (AmpLoadTask);
+	task->project = project;
+	task->group = group;
+
+	g_mutex_lock (project->lock);
+	project->pending++;
+	g_mutex_unlock (project->lock);
+
+	g_thread_pool_push (amp_load_pool, task, NULL);
+}
+
+/* Wait until all groups loaded in other threads are done */
+static void
+amp_project_wait_load (AmpProject *project)
+{
+	g_mutex_lock (project->lock);
+	while (project->pending > 0) g_cond_wait (project->loaded, project->lock);
+	g_mutex_unlock (project->lock);
+}
+
 static void
 project_load_subdirs (AmpProject *project, AnjutaToken *list, AnjutaProjectNode *parent, gboolean dist_only)
 {
@@ -1363,6 +1438,11 @@ project_load_subdirs (AmpProject *project, AnjutaToken *list, AnjutaProjectNode
 				/* Already existing group, mark for built if needed */
 				if (!dist_only) amp_group_node_set_dist_only (group, FALSE);
 			}
+			else if ((group = amp_group_node_new_placeholder (AMP_GROUP_NODE (parent), subdir, value, dist_only)) != NULL)
+			{
+				/* Already loaded group, kept as is in the tree */
+				anjuta_project_node_append (parent, ANJUTA_PROJECT_NODE (group));
+			}
 			else
 			{
 				/* Create new group */
@@ -1371,10 +1451,12 @@ project_load_subdirs (AmpProject *project, AnjutaToken *list, AnjutaProjectNode
 				/* Group can be NULL if the name is not valid */
 				if (group != NULL)
 				{
+					g_mutex_lock (project->lock);
 					g_hash_table_insert (project->groups, g_file_get_uri (subdir), group);
+					g_mutex_unlock (project->lock);
 					anjuta_project_node_append (parent, ANJUTA_PROJECT_NODE (group));
 
-					amp_node_load (AMP_NODE (group), NULL, project, NULL);
+					amp_project_load_group (project, group);
 				}
 			}
 			if (group) amp_group_node_add_token (group, arg, dist_only ? AM_GROUP_TOKEN_DIST_SUBDIRS : AM_GROUP_TOKEN_SUBDIRS);
@@ -1501,7 +1583,11 @@ amp_project_map_children (GHashTable *map, AnjutaProjectNode *old_node, AnjutaPr
 			/* Add new to old node mapping */
 			g_hash_table_insert (map, (AnjutaProjectNode *)same->data, old_node);
 
-			amp_project_map_children (map, old_node, (AnjutaProjectNode *)same->data);
+			/* Children of a kept group are not reloaded */
+			if (!amp_group_node_is_placeholder ((AnjutaProjectNode *)same->data))
+			{
+				amp_project_map_children (map, old_node, (AnjutaProjectNode *)same->data);
+			}
 			children = g_list_delete_link (children, same);
 		}
 		else
@@ -1553,7 +1639,18 @@ amp_project_update_node (AnjutaProjectNode *key, AnjutaProjectNode *value, GHash
 		AnjutaProjectNode *node = value;	/* The node that we keep in the tree */
 		AnjutaProjectNode *new_node = key;  /* The node with the new data */
 
-		if (new_node && new_node != node)
+		if (new_node && new_node != node && amp_group_node_is_placeholder (new_node))
+		{
+			/* Kept node, update only its position and its parent tokens */
+			amp_node_update (AMP_NODE (node), AMP_NODE (new_node));
+			node->parent = new_node->parent;
+			node->next = new_node->next;
+			node->prev = new_node->prev;
+
+			/* Destroy placeholder */
+			old_node = new_node;
+		}
+		else if (new_node && new_node != node)
 		{
 			GList *properties;
 
@@ -1668,8 +1765,10 @@ amp_project_load_root (AmpProject *project, GError **error)
 	GFile *root_file;
 	GFile *configure_file;
 	AnjutaTokenFile *configure_token_file;
+	AnjutaTokenPool *old_pool;
 	AnjutaProjectNode *source;
 	GError *err = NULL;
+	gboolean ok;
 
 	root_file = anjuta_project_node_get_file (ANJUTA_PROJECT_NODE (project));
 	DEBUG_PRINT ("reload project %p root file %p", project, root_file);
@@ -1707,9 +1806,11 @@ amp_project_load_root (AmpProject *project, GError **error)
 	anjuta_project_node_append (ANJUTA_PROJECT_NODE (project), source);
 	arg = anjuta_token_file_load (configure_token_file, NULL);
 	g_hash_table_remove_all (project->ac_variables);
+	old_pool = anjuta_token_pool_set_current (anjuta_token_file_get_pool (configure_token_file));
 	scanner = amp_ac_scanner_new (project);
 	project->configure_token = amp_ac_scanner_parse_token (scanner, NULL, arg, 0, configure_file, &err);
 	amp_ac_scanner_free (scanner);
+	anjuta_token_pool_set_current (old_pool);
 
 	if (project->configure_token == NULL)
 	{
@@ -1732,7 +1833,9 @@ amp_project_load_root (AmpProject *project, GError **error)
 	}
 
 	/* Load all makefiles recursively */
-	if (!AMP_NODE_CLASS (parent_class)->load (AMP_NODE (project), NULL, project, NULL))
+	ok = AMP_NODE_CLASS (parent_class)->load (AMP_NODE (project), NULL, project, NULL);
+	amp_project_wait_load (project);
+	if (!ok)
 	{
 		g_set_error (error, IANJUTA_PROJECT_ERROR,
 					IANJUTA_PROJECT_ERROR_DOESNT_EXIST,
@@ -1821,16 +1924,20 @@ gboolean
 amp_project_get_token_location (AmpProject *project, AnjutaTokenFileLocation *location, AnjutaToken *token)
 {
 	GList *list;
+	gboolean found = FALSE;
 
+	g_mutex_lock (project->lock);
 	for (list = project->files; list != NULL; list = g_list_next (list))
 	{
 		if (anjuta_token_file_get_token_location ((AnjutaTokenFile *)list->data, location, token))
 		{
-			return TRUE;
+			found = TRUE;
+			break;
 		}
 	}
+	g_mutex_unlock (project->lock);
 
-	return FALSE;
+	return found;
 }
 
 void
@@ -2090,7 +2197,9 @@ amp_project_get_file (AmpProject *project)
 void
 amp_project_add_file (AmpProject *project, GFile *file, AnjutaTokenFile* token)
 {
+	g_mutex_lock (project->lock);
 	project->files = g_list_prepend (project->files, token);
+	g_mutex_unlock (project->lock);
 	g_object_weak_ref (G_OBJECT (token), remove_config_file, project);
 }
 
@@ -2115,6 +2224,20 @@ amp_project_is_busy (AmpProject *project)
 	return pm_command_queue_is_busy (project->queue);
 }
 
+/* Set the number of threads used to parse makefiles, 0 or 1 loads all
+ * makefiles sequentially in the worker thread */
+void
+amp_project_set_load_threads (gint threads)
+{
+	G_LOCK (amp_load_pool);
+	amp_load_threads = threads;
+	if ((amp_load_pool != NULL) && (threads > 1))
+	{
+		g_thread_pool_set_max_threads (amp_load_pool, threads, NULL);
+	}
+	G_UNLOCK (amp_load_pool);
+}
+
 /* Worker thread
  *---------------------------------------------------------------------------*/
 
@@ -2124,6 +2247,15 @@ amp_load_setup (PmJob *job)
 	//anjuta_project_node_check (job->node);
 	pm_job_set_parent (job, anjuta_project_node_parent (job->node));
 	job->proxy = amp_project_duplicate_node (job->node);
+	if ((anjuta_project_node_get_node_type (job->node) == ANJUTA_PROJECT_GROUP) &&
+	    (job->parent != NULL) &&
+	    (anjuta_project_node_get_node_type (job->parent) == ANJUTA_PROJECT_GROUP))
+	{
+		/* Reload only the group makefile, subdirectories are not changed.
+		 * The root group, child of the project node, is reloaded with all
+		 * its subdirectories */
+		amp_group_node_keep_subgroups (AMP_GROUP_NODE (job->proxy), job->node);
+	}
 
 	return TRUE;
 }
@@ -2131,7 +2263,14 @@ amp_load_setup (PmJob *job)
 static gboolean
 amp_load_work (PmJob *job)
 {
-	return amp_node_load (AMP_NODE (job->proxy), AMP_NODE (job->parent), AMP_PROJECT (job->user_data), &job->error);
+	gboolean ok;
+
+	ok = amp_node_load (AMP_NODE (job->proxy), AMP_NODE (job->parent), AMP_PROJECT (job->user_data), &job->error);
+
+	/* Wait for subdirectories loaded in other threads */
+	amp_project_wait_load (AMP_PROJECT (job->user_data));
+
+	return ok;
 }
 
 static gboolean
@@ -2597,6 +2736,11 @@ amp_project_dispose (GObject *object)
 	if (project->lang_manager) g_object_unref (project->lang_manager);
 	project->lang_manager = NULL;
 
+	if (project->lock) g_mutex_free (project->lock);
+	project->lock = NULL;
+	if (project->loaded) g_cond_free (project->loaded);
+	project->loaded = NULL;
+
 	G_OBJECT_CLASS (parent_class)->dispose (object);
 }
 
@@ -2623,6 +2767,11 @@ amp_project_init (AmpProject *project)
 
 	project->queue = NULL;
 	project->loading = 0;
+
+	/* Parallel load */
+	project->lock = g_mutex_new ();
+	project->loaded = g_cond_new ();
+	project->pending = 0;
 }
 
 static void
@@ -97,6 +97,7 @@ gchar * amp_project_get_uri (AmpProject *project);
 GFile* amp_project_get_file (AmpProject *project);
 
 gboolean amp_project_is_busy (AmpProject *project);
+void amp_project_set_load_threads (gint threads);
 
 void amp_project_add_file (AmpProject *project, GFile *file, AnjutaTokenFile* token);
 void amp_project_add_subst_variable (AmpProject *project, const gchar *name, AnjutaToken *value);
@@ -1209,9 +1209,13 @@ static GList* AmpScriptTargetPropertyList = NULL;
 /* Private functions
  *---------------------------------------------------------------------------*/
 
+G_LOCK_DEFINE_STATIC (amp_property_list);
+
 static GList *
 amp_create_property_list (GList **list, AmpPropertyInfo *properties)
 {
+	/* Property lists can be created by several threads loading makefiles */
+	G_LOCK (amp_property_list);
 	if (*list == NULL)
 	{
 		AmpPropertyInfo *info;
@@ -1227,6 +1231,7 @@ amp_create_property_list (GList **list, AmpPropertyInfo *properties)
 		}
 		*list = g_list_reverse (*list);
 	}
+	G_UNLOCK (amp_property_list);
 
 	return *list;
 }
@@ -415,12 +415,14 @@ AnjutaTokenFile*
 amp_group_node_set_makefile (AmpGroupNode *group, GFile *makefile, AmpProject *project)
 {
 	if (group->makefile != NULL) g_object_unref (group->makefile);
+	group->make_token = NULL;
 	if (group->tfile != NULL) anjuta_token_file_free (group->tfile);
 	if (makefile != NULL)
 	{
 		AnjutaToken *token;
 		AmpAmScanner *scanner;
 		AnjutaProjectNode *source;
+		AnjutaTokenPool *old_pool;
 
 		group->makefile = g_object_ref (makefile);
 		group->tfile = anjuta_token_file_new (makefile);
@@ -432,9 +434,12 @@ amp_group_node_set_makefile (AmpGroupNode *group, GFile *makefile, AmpProject *p
 
 		amp_group_node_update_preset_variable (group);
 
+		/* Keep the parsed tokens in the file pool, they are released with it */
+		old_pool = anjuta_token_pool_set_current (anjuta_token_file_get_pool (group->tfile));
 		scanner = amp_am_scanner_new (project, group);
 		group->make_token = amp_am_scanner_parse_token (scanner, anjuta_token_new_static (ANJUTA_TOKEN_FILE, NULL), token, makefile, NULL);
 		amp_am_scanner_free (scanner);
+		anjuta_token_pool_set_current (old_pool);
 
 		group->monitor = g_file_monitor_file (makefile,
 						      									G_FILE_MONITOR_NONE,
@@ -497,6 +502,21 @@ amp_group_node_update_node (AmpGroupNode *group, AmpGroupNode *new_group)
 	gint i;
 	GHashTable *hash;
 
+	if (new_group->placeholder)
+	{
+		/* The group is not reloaded, update only the tokens of the parent
+		 * makefile */
+		for (i = AM_GROUP_TOKEN_SUBDIRS; i <= AM_GROUP_TOKEN_DIST_SUBDIRS; i++)
+		{
+			if (group->tokens[i] != NULL) g_list_free (group->tokens[i]);
+			group->tokens[i] = new_group->tokens[i];
+			new_group->tokens[i] = NULL;
+		}
+		group->dist_only = new_group->dist_only;
+
+		return;
+	}
+
 	if (group->monitor != NULL)
 	{
 		g_object_unref (group->monitor);
@@ -597,6 +617,50 @@ amp_group_node_set_file (AmpGroupNode *group, GFile *new_file)
 	return TRUE;
 }
 
+/* Record the subgroups of node, already loaded, in group. When group is
+ * loaded these subgroups are not parsed again, only a placeholder is created.
+ * It is used when a single Makefile.am is modified, to avoid reloading the
+ * whole subtree. */
+void
+amp_group_node_keep_subgroups (AmpGroupNode *group, AnjutaProjectNode *node)
+{
+	AnjutaProjectNode *child;
+
+	if (group->kept == NULL)
+	{
+		group->kept = g_hash_table_new_full (g_file_hash, (GEqualFunc)g_file_equal, g_object_unref, NULL);
+	}
+
+	for (child = anjuta_project_node_first_child (node); child != NULL; child = anjuta_project_node_next_sibling (child))
+	{
+		if (anjuta_project_node_get_node_type (child) == ANJUTA_PROJECT_GROUP)
+		{
+			g_hash_table_insert (group->kept, g_file_dup (anjuta_project_node_get_file (child)), NULL);
+		}
+	}
+}
+
+/* Return a new group without any data standing for a subgroup kept in parent
+ * or NULL if the subgroup has to be loaded */
+AmpGroupNode*
+amp_group_node_new_placeholder (AmpGroupNode *parent, GFile *file, const gchar *name, gboolean dist_only)
+{
+	AmpGroupNode *node;
+
+	if ((parent->kept == NULL) || !g_hash_table_lookup_extended (parent->kept, file, NULL, NULL)) return NULL;
+
+	node = amp_group_node_new (file, name, dist_only);
+	node->placeholder = TRUE;
+
+	return node;
+}
+
+gboolean
+amp_group_node_is_placeholder (AnjutaProjectNode *node)
+{
+	return (anjuta_project_node_get_node_type (node) == ANJUTA_PROJECT_GROUP) && AMP_GROUP_NODE (node)->placeholder;
+}
+
 AmpGroupNode*
 amp_group_node_new (GFile *file, const gchar *name, gboolean dist_only)
 {
@@ -747,6 +811,8 @@ amp_group_node_init (AmpGroupNode *node)
 	node->monitor = NULL;
 	memset (node->tokens, 0, sizeof (node->tokens));
 	node->preset_token = NULL;
+	node->kept = NULL;
+	node->placeholder = FALSE;
 }
 
 static void
@@ -777,6 +843,7 @@ amp_group_node_finalize (GObject *object)
 		if (node->tokens[i] != NULL) g_list_free (node->tokens[i]);
 	}
 	if (node->variables) g_hash_table_destroy (node->variables);
+	if (node->kept) g_hash_table_destroy (node->kept);
 
 	G_OBJECT_CLASS (amp_group_node_parent_class)->finalize (object);
 }
@@ -53,6 +53,8 @@ struct _AmpGroupNode {
 	AnjutaToken *preset_token;
 	GHashTable *variables;
 	GFileMonitor *monitor;							/* File monitor */
+	GHashTable *kept;								/* Already loaded subgroups kept when reloading */
+	gboolean placeholder;							/* TRUE if the group stands for a kept subgroup */
 };
 
 struct _AmpGroupNodeClass {
@@ -93,6 +95,9 @@ AmpGroupNode* amp_group_node_new (GFile *file, const gchar *name, gboolean dist_
 void amp_group_node_free (AmpGroupNode *node);
 void amp_group_node_update_node (AmpGroupNode *node, AmpGroupNode *new_node);
 gboolean amp_group_node_set_file (AmpGroupNode *group, GFile *new_file);
+void amp_group_node_keep_subgroups (AmpGroupNode *group, AnjutaProjectNode *node);
+AmpGroupNode* amp_group_node_new_placeholder (AmpGroupNode *parent, GFile *file, const gchar *name, gboolean dist_only);
+gboolean amp_group_node_is_placeholder (AnjutaProjectNode *node);
 
 
 G_END_DECLS
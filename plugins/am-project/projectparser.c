@@ -34,11 +34,15 @@
 static gchar* output_file = NULL;
 static FILE* output_stream = NULL;
 gboolean no_id = FALSE;
+static gint load_threads = -1;
+static gboolean show_time = FALSE;
 
 static GOptionEntry entries[] =
 {
   { "output", 'o', 0, G_OPTION_ARG_FILENAME, &output_file, "Output file (default stdout)", "output_file" },
   { "no-id", 0, 0, G_OPTION_ARG_NONE, &no_id, "Do not display node ID", "" },
+  { "load-threads", 0, 0, G_OPTION_ARG_INT, &load_threads, "Number of threads used to parse makefiles (1 to disable)", "threads" },
+  { "time", 0, 0, G_OPTION_ARG_NONE, &show_time, "Display the time needed by each command on stderr", "" },
   { NULL }
 };
 
@@ -509,8 +513,10 @@ main(int argc, char *argv[])
 	char **command;
 	GOptionContext *context;
 	GError *error = NULL;
+	GTimer *timer;
 
 	/* Initialize program */
+	if (!g_thread_supported ()) g_thread_init (NULL);
 	g_type_init ();
 
 	anjuta_debug_init ();
@@ -531,9 +537,15 @@ main(int argc, char *argv[])
 
 	open_output ();
 
+	if (load_threads >= 0) amp_project_set_load_threads (load_threads);
+	timer = g_timer_new ();
+
 	/* Execute commands */
 	for (command = &argv[1]; *command != NULL; command++)
 	{
+		const gchar *name = *command;
+
+		g_timer_start (timer);
 		if (g_ascii_strcasecmp (*command, "load") == 0)
 		{
 			GFile *file = g_file_new_for_commandline_arg (*(++command));
@@ -760,6 +772,7 @@ main(int argc, char *argv[])
 			break;
 		}
 		amp_project_wait_ready (project);
+		if (show_time) fprintf (stderr, "%s: %g s\n", name, g_timer_elapsed (timer, NULL));
 		if (error != NULL)
 		{
 			print_error ("Error: %s", error->message == NULL ? "unknown error" : error->message);
@@ -770,6 +783,7 @@ main(int argc, char *argv[])
 	}
 
 	/* Free objects */
+	g_timer_destroy (timer);
 	if (project) g_object_unref (project);
 	close_output ();
 
@@ -0,0 +1,152 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-classifier-bench.c
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * Measure the throughput of the build output classifier on a build log, with
+ * and without the literal prefilter, and check that both give the same
+ * results. Without a log file, a log looking like an automake build is
+ * generated.
+ *
+ * Usage: build-classifier-bench [filters file] [build log]
+ *---------------------------------------------------------------------------*/
+
+#include <config.h>
+
+#include "build-classifier.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static gchar *
+build_bench_generate_log (gsize *length)
+{
+	GString *log;
+	guint i;
+
+	log = g_string_new (NULL);
+	for (i = 0; i < 20000; i++)
+	{
+		if (i % 100 == 0)
+			g_string_append_printf (log, "make[%u]: Entering directory `/home/user/project/src/dir%u'\n", i % 4, i / 100);
+		g_string_append_printf (log, "/bin/bash ../libtool --tag=CC   --mode=compile gcc -DHAVE_CONFIG_H -I. -I..   -g -O2 -MT file%u.lo -MD -MP -MF .deps/file%u.Tpo -c -o file%u.lo file%u.c\n", i, i, i, i);
+		g_string_append_printf (log, "libtool: compile:  gcc -DHAVE_CONFIG_H -I. -I.. -g -O2 -MT file%u.lo -MD -MP -MF .deps/file%u.Tpo -c file%u.c  -fPIC -DPIC -o .libs/file%u.o\n", i, i, i, i);
+		g_string_append_printf (log, "mv -f .deps/file%u.Tpo .deps/file%u.Plo\n", i, i);
+		if (i % 10 == 0)
+		{
+			g_string_append_printf (log, "file%u.c: In function 'function%u':\n", i, i);
+			g_string_append_printf (log, "file%u.c:%u:5: warning: unused variable 'tmp' [-Wunused-variable]\n", i, i % 1000);
+			g_string_append (log, "     int tmp;\n");
+			g_string_append (log, "         ^\n");
+		}
+		if (i % 100 == 99)
+			g_string_append_printf (log, "make[%u]: Leaving directory `/home/user/project/src/dir%u'\n", i % 4, i / 100);
+	}
+	*length = log->len;
+
+	return g_string_free (log, FALSE);
+}
+
+/* Classify all lines, return a checksum of the results */
+static guint
+build_bench_run (BuildClassifier *classifier, gchar **lines, guint n_lines, guint *n_summaries)
+{
+	guint hash = 0;
+	guint i;
+
+	*n_summaries = 0;
+	for (i = 0; i < n_lines; i++)
+	{
+		gchar *dir;
+		gchar *summary;
+
+		hash = hash * 31 + build_classifier_match_directory (classifier, lines[i], &dir);
+		if (dir != NULL) hash = hash * 31 + g_str_hash (dir);
+		g_free (dir);
+
+		summary = build_classifier_get_summary (classifier, lines[i]);
+		if (summary != NULL)
+		{
+			hash = hash * 31 + g_str_hash (summary);
+			(*n_summaries)++;
+		}
+		g_free (summary);
+	}
+
+	return hash;
+}
+
+int
+main(int argc, char *argv[])
+{
+	const gchar *filters = argc > 1 ? argv[1] : "automake-c.filters";
+	BuildClassifier *classifier;
+	gchar *log;
+	gsize length;
+	gchar **lines;
+	guint n_lines;
+	GTimer *timer;
+	guint hash[2];
+	guint n_summaries;
+	gint i;
+
+	if (argc > 2)
+	{
+		if (!g_file_get_contents (argv[2], &log, &length, NULL))
+		{
+			fprintf (stderr, "Cannot read %s\n", argv[2]);
+			return 1;
+		}
+	}
+	else
+	{
+		log = build_bench_generate_log (&length);
+	}
+	lines = g_strsplit (log, "\n", -1);
+	n_lines = g_strv_length (lines);
+
+	classifier = build_classifier_new ();
+	if (!build_classifier_load_filters (classifier, filters))
+	{
+		fprintf (stderr, "Cannot read %s\n", filters);
+		return 1;
+	}
+
+	timer = g_timer_new ();
+	for (i = 1; i >= 0; i--)
+	{
+		gdouble elapsed;
+
+		build_classifier_set_prefilter (classifier, i);
+		g_timer_start (timer);
+		hash[i] = build_bench_run (classifier, lines, n_lines, &n_summaries);
+		elapsed = g_timer_elapsed (timer, NULL);
+		fprintf (stdout, "%s prefilter: %u lines (%u summaries) in %g s, %g lines/s, %g MB/s\n",
+		         i ? "with" : "without", n_lines, n_summaries, elapsed,
+		         n_lines / elapsed, length / elapsed / 1e6);
+	}
+	fprintf (stdout, "same results %d\n", hash[0] == hash[1]);
+
+	g_timer_destroy (timer);
+	build_classifier_free (classifier);
+	g_strfreev (lines);
+	g_free (log);
+
+	return hash[0] == hash[1] ? 0 : 1;
+}
@@ -0,0 +1,502 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-classifier.c
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * This object recognizes the lines written by make and the compiler during
+ * a build: directory changes and lines which can be replaced by a shorter
+ * summary using the patterns of automake-c.filters.
+ *
+ * All patterns are regular expressions checked in order. Most lines do not
+ * match any of them, so for each pattern the longest literal text which has
+ * to appear in a matching line is extracted when the pattern is compiled.
+ * A line not containing this text is rejected without running the regular
+ * expression.
+ *---------------------------------------------------------------------------*/
+
+#include <config.h>
+
+#include "build-classifier.h"
+
+#include <libanjuta/anjuta-debug.h>
+
+#include <glib/gi18n.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+typedef struct
+{
+	GRegex *regex;
+	gchar *literal;		/* Text included in all matching lines or NULL */
+	gchar *replace;		/* Summary, only for filters */
+} BuildRule;
+
+struct _BuildClassifier
+{
+	GPtrArray *entering;
+	GPtrArray *leaving;
+	GPtrArray *filters;
+	gboolean prefilter;
+};
+
+/* The translations should match that of 'make' program. Both strings uses
+ * pearl regular expression
+ * 2 similar strings are used in order to parse the output of 2 different
+ * version of make if necessary. If you update one string, move the first
+ * string into the second slot and then replace the first string only. */
+static const gchar *patterns_make_entering[] = {N_("make(\\[\\d+\\])?:\\s+Entering\\s+directory\\s+`(.+)'"),
+												N_("make(\\[\\d+\\])?:\\s+Entering\\s+directory\\s+'(.+)'"),
+												NULL};
+
+/* The translations should match that of 'make' program. Both strings uses
+ * pearl regular expression
+ * 2 similar strings are used in order to parse the output of 2 different
+ * version of make if necessary. If you update one string, move the first
+ * string into the second slot and then replace the first string only. */
+static const gchar *patterns_make_leaving[] = {N_("make(\\[\\d+\\])?:\\s+Leaving\\s+directory\\s+`(.+)'"),
+											   N_("make(\\[\\d+\\])?:\\s+Leaving\\s+directory\\s+'(.+)'"),
+											   NULL};
+
+/* Literal prefilter
+ *---------------------------------------------------------------------------*/
+
+/* Remove the last UTF-8 character of the string */
+static void
+build_string_truncate_char (GString *str)
+{
+	while ((str->len > 0) && ((str->str[str->len - 1] & 0xC0) == 0x80))
+	{
+		g_string_truncate (str, str->len - 1);
+	}
+	if (str->len > 0) g_string_truncate (str, str->len - 1);
+}
+
+static void
+build_literal_end (GString *run, GString *best)
+{
+	if (run->len > best->len) g_string_assign (best, run->str);
+	g_string_truncate (run, 0);
+}
+
+/* Return the position after the character class starting at ptr, POSIX
+ * classes like [:digit:] can be used inside it */
+static const gchar *
+build_regex_skip_class (const gchar *ptr)
+{
+	ptr++;
+	if (*ptr == '^') ptr++;
+	if (*ptr == ']') ptr++;
+	for (; (*ptr != '\0') && (*ptr != ']'); ptr++)
+	{
+		if ((*ptr == '\\') && (ptr[1] != '\0'))
+		{
+			ptr++;
+		}
+		else if ((*ptr == '[') && (ptr[1] == ':'))
+		{
+			const gchar *end = strstr (ptr + 2, ":]");
+
+			if (end != NULL) ptr = end + 1;
+		}
+	}
+	if (*ptr == ']') ptr++;
+
+	return ptr;
+}
+
+/* Check if an escape sequence is followed by an argument, like \x41, \012,
+ * \1 or \Q...\E, these sequences are not analyzed */
+static gboolean
+build_regex_is_complex_escape (gchar ch)
+{
+	return g_ascii_isdigit (ch) || ((ch != '\0') && (strchr ("xocQgkpP", ch) != NULL));
+}
+
+/* Return the longest text which has to be found in all lines matching the
+ * pattern or NULL if there is none. The analysis is conservative: groups,
+ * character classes and escaped letters end the literal text, a top level
+ * alternative or an escape sequence with an argument disables it. */
+static gchar *
+build_regex_get_literal (const gchar *pattern, GRegexCompileFlags options)
+{
+	GString *run;
+	GString *best;
+	const gchar *ptr;
+	gint depth = 0;
+
+	/* Options changing how the literal characters are matched */
+	if (options & (G_REGEX_CASELESS | G_REGEX_EXTENDED)) return NULL;
+
+	run = g_string_new (NULL);
+	best = g_string_new (NULL);
+	for (ptr = pattern; *ptr != '\0';)
+	{
+		if (depth > 0)
+		{
+			/* Skip groups */
+			if ((*ptr == '\\') && (ptr[1] == 'Q'))
+			{
+				break;
+			}
+			else if ((*ptr == '\\') && (ptr[1] != '\0'))
+			{
+				ptr++;
+			}
+			else if (*ptr == '[')
+			{
+				ptr = build_regex_skip_class (ptr);
+				continue;
+			}
+			else if (*ptr == '(')
+			{
+				depth++;
+			}
+			else if (*ptr == ')')
+			{
+				depth--;
+			}
+			ptr++;
+			continue;
+		}
+
+		switch (*ptr)
+		{
+		case '\\':
+			if (build_regex_is_complex_escape (ptr[1]))
+			{
+				g_string_free (run, TRUE);
+				g_string_free (best, TRUE);
+				return NULL;
+			}
+			else if ((ptr[1] == '\0') || isalnum (ptr[1]))
+			{
+				/* Character class or assertion */
+				build_literal_end (run, best);
+				ptr += ptr[1] == '\0' ? 1 : 2;
+			}
+			else
+			{
+				g_string_append_c (run, ptr[1]);
+				ptr += 2;
+			}
+			break;
+		case '[':
+			build_literal_end (run, best);
+			ptr = build_regex_skip_class (ptr);
+			break;
+		case '(':
+			if (ptr[1] == '?' && (isalpha (ptr[2]) || (ptr[2] == '-')))
+			{
+				/* Inline options like (?i) */
+				g_string_free (run, TRUE);
+				g_string_free (best, TRUE);
+				return NULL;
+			}
+			build_literal_end (run, best);
+			depth++;
+			ptr++;
+			break;
+		case '|':
+			/* Alternative at top level */
+			g_string_free (run, TRUE);
+			g_string_free (best, TRUE);
+			return NULL;
+		case '*':
+		case '?':
+		case '{':
+			/* The previous character is optional */
+			build_string_truncate_char (run);
+			build_literal_end (run, best);
+			if (*ptr == '{')
+			{
+				while ((*ptr != '\0') && (*ptr != '}')) ptr++;
+			}
+			if (*ptr != '\0') ptr++;
+			break;
+		case '+':
+			/* The previous character is needed but can be repeated */
+			build_literal_end (run, best);
+			ptr++;
+			break;
+		case '.':
+		case '^':
+		case '$':
+			build_literal_end (run, best);
+			ptr++;
+			break;
+		default:
+			g_string_append_c (run, *ptr);
+			ptr++;
+			break;
+		}
+	}
+	build_literal_end (run, best);
+	g_string_free (run, TRUE);
+
+	if (best->len == 0)
+	{
+		g_string_free (best, TRUE);
+		return NULL;
+	}
+
+	return g_string_free (best, FALSE);
+}
+
+/* Rules
+ *---------------------------------------------------------------------------*/
+
+static BuildRule *
+build_rule_new (const gchar *pattern, GRegexCompileFlags options, const gchar *replace)
+{
+	BuildRule *rule;
+	GRegex *regex;
+	GError *error = NULL;
+
+	regex = g_regex_new (pattern, options | G_REGEX_OPTIMIZE, 0, &error);
+	if (error != NULL)
+	{
+		DEBUG_PRINT ("GRegex compilation failed: pattern \"%s\": error %s",
+					pattern, error->message);
+		g_error_free (error);
+		return NULL;
+	}
+
+	rule = g_slice_new0 (BuildRule);
+	rule->regex = regex;
+	rule->literal = build_regex_get_literal (pattern, options);
+	rule->replace = g_strdup (replace);
+
+	return rule;
+}
+
+static void
+build_rule_free (BuildRule *rule)
+{
+	g_regex_unref (rule->regex);
+	g_free (rule->literal);
+	g_free (rule->replace);
+	g_slice_free (BuildRule, rule);
+}
+
+static gboolean
+build_rule_match (BuildClassifier *classifier, BuildRule *rule, const gchar *line, GMatchInfo **match_info)
+{
+	if (classifier->prefilter && (rule->literal != NULL) && (strstr (line, rule->literal) == NULL))
+	{
+		*match_info = NULL;
+		return FALSE;
+	}
+
+	if (g_regex_match (rule->regex, line, 0, match_info)) return TRUE;
+
+	g_match_info_free (*match_info);
+	*match_info = NULL;
+
+	return FALSE;
+}
+
+static void
+build_rules_add_message (GPtrArray *rules, const gchar **patterns)
+{
+	for (; *patterns != NULL; patterns++)
+	{
+		BuildRule *rule;
+
+		/* Untranslated string */
+		rule = build_rule_new (*patterns, 0, NULL);
+		if (rule != NULL) g_ptr_array_add (rules, rule);
+
+		/* Translated string, if different */
+		if (strcmp (*patterns, _(*patterns)) != 0)
+		{
+			rule = build_rule_new (_(*patterns), 0, NULL);
+			if (rule != NULL) g_ptr_array_add (rules, rule);
+		}
+	}
+}
+
+/* Return the index of the first rule matching the line or -1 */
+static gint
+build_rules_match (BuildClassifier *classifier, GPtrArray *rules, const gchar *line, GMatchInfo **match_info)
+{
+	guint i;
+
+	for (i = 0; i < rules->len; i++)
+	{
+		if (build_rule_match (classifier, (BuildRule *)g_ptr_array_index (rules, i), line, match_info)) return i;
+	}
+
+	return -1;
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+BuildClassifier*
+build_classifier_new (void)
+{
+	BuildClassifier *classifier;
+
+	classifier = g_new0 (BuildClassifier, 1);
+	classifier->entering = g_ptr_array_new_with_free_func ((GDestroyNotify)build_rule_free);
+	classifier->leaving = g_ptr_array_new_with_free_func ((GDestroyNotify)build_rule_free);
+	classifier->filters = g_ptr_array_new_with_free_func ((GDestroyNotify)build_rule_free);
+	classifier->prefilter = TRUE;
+
+	build_rules_add_message (classifier->entering, patterns_make_entering);
+	build_rules_add_message (classifier->leaving, patterns_make_leaving);
+
+	return classifier;
+}
+
+void
+build_classifier_free (BuildClassifier *classifier)
+{
+	g_ptr_array_free (classifier->entering, TRUE);
+	g_ptr_array_free (classifier->leaving, TRUE);
+	g_ptr_array_free (classifier->filters, TRUE);
+	g_free (classifier);
+}
+
+/* Read summary patterns, one per line, with the following format:
+ * regular expression|||summary|||GRegex compile options */
+gboolean
+build_classifier_load_filters (BuildClassifier *classifier, const gchar *filename)
+{
+	FILE *fp;
+
+	fp = fopen (filename, "r");
+	if (fp == NULL)
+	{
+		DEBUG_PRINT ("Failed to load filters: %s", filename);
+		return FALSE;
+	}
+	while (!feof (fp) && !ferror (fp))
+	{
+		char buffer[1024];
+		gchar **tokens;
+		BuildRule *rule;
+
+		if (!fgets (buffer, 1024, fp))
+			break;
+		tokens = g_strsplit (buffer, "|||", 3);
+
+		if (!tokens[0] || !tokens[1])
+		{
+			DEBUG_PRINT ("Cannot parse regex: %s", buffer);
+			g_strfreev (tokens);
+			continue;
+		}
+		rule = build_rule_new (tokens[0], tokens[2] ? atoi (tokens[2]) : 0, tokens[1]);
+		if (rule != NULL) g_ptr_array_add (classifier->filters, rule);
+		g_strfreev (tokens);
+	}
+	fclose (fp);
+
+	return TRUE;
+}
+
+/* The literal prefilter is used by default, disabling it is useful only to
+ * measure its effect. */
+void
+build_classifier_set_prefilter (BuildClassifier *classifier, gboolean enable)
+{
+	classifier->prefilter = enable;
+}
+
+/* Check if the line is written by make when entering or leaving a directory.
+ * In this case, the directory is returned in a newly allocated string. */
+BuildDirectoryChange
+build_classifier_match_directory (BuildClassifier *classifier, const gchar *line, gchar **directory)
+{
+	GMatchInfo *match_info;
+	BuildDirectoryChange change;
+
+	*directory = NULL;
+	if (build_rules_match (classifier, classifier->entering, line, &match_info) >= 0)
+	{
+		change = BUILD_DIRECTORY_ENTERING;
+	}
+	else if (build_rules_match (classifier, classifier->leaving, line, &match_info) >= 0)
+	{
+		change = BUILD_DIRECTORY_LEAVING;
+	}
+	else
+	{
+		return BUILD_DIRECTORY_NONE;
+	}
+
+	*directory = g_match_info_fetch (match_info, 2);
+	g_match_info_free (match_info);
+
+	return change;
+}
+
+/* Return a summary of the line using the first matching filter or NULL */
+gchar *
+build_classifier_get_summary (BuildClassifier *classifier, const gchar *line)
+{
+	GMatchInfo *match_info;
+	BuildRule *rule;
+	const gchar *iter;
+	GString *ret;
+	gint i;
+
+	i = build_rules_match (classifier, classifier->filters, line, &match_info);
+	if (i < 0) return NULL;
+
+	rule = (BuildRule *)g_ptr_array_index (classifier->filters, i);
+	ret = g_string_new ("");
+	iter = rule->replace;
+	while (*iter != '\0')
+	{
+		if (*iter == '\\' && isdigit(*(iter + 1)))
+		{
+			gint start_pos, end_pos;
+
+			if (g_match_info_fetch_pos (match_info, *(iter + 1) - '0', &start_pos, &end_pos) &&
+				(start_pos >= 0))
+			{
+				ret = g_string_append_len (ret, line + start_pos,
+										   end_pos - start_pos);
+			}
+			iter += 2;
+		}
+		else
+		{
+			const gchar *start;
+
+			start = iter;
+			iter = g_utf8_next_char (iter);
+
+			ret = g_string_append_len (ret, start, iter - start);
+		}
+	}
+	g_match_info_free (match_info);
+
+	if (ret->len == 0)
+	{
+		g_string_free (ret, TRUE);
+		return NULL;
+	}
+
+	return g_string_free (ret, FALSE);
+}
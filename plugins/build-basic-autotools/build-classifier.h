@@ -0,0 +1,43 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-classifier.h
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef BUILD_CLASSIFIER_H
+#define BUILD_CLASSIFIER_H
+
+#include <glib.h>
+
+typedef struct _BuildClassifier BuildClassifier;
+
+typedef enum
+{
+	BUILD_DIRECTORY_NONE,
+	BUILD_DIRECTORY_ENTERING,
+	BUILD_DIRECTORY_LEAVING
+} BuildDirectoryChange;
+
+BuildClassifier* build_classifier_new (void);
+void build_classifier_free (BuildClassifier *classifier);
+
+gboolean build_classifier_load_filters (BuildClassifier *classifier, const gchar *filename);
+void build_classifier_set_prefilter (BuildClassifier *classifier, gboolean enable);
+
+BuildDirectoryChange build_classifier_match_directory (BuildClassifier *classifier, const gchar *line, gchar **directory);
+gchar *build_classifier_get_summary (BuildClassifier *classifier, const gchar *line);
+
+#endif /* BUILD_CLASSIFIER_H */
@@ -0,0 +1,524 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-commands.c
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * Keep the compiler command used for each source file during a build, so
+ * a single file can be compiled later by running the compiler directly
+ * instead of going through make, which has to read all makefiles and check
+ * all dependencies first.
+ *
+ * The commands are read from the build output: they are available only if
+ * make displays them (silent rules disabled or V=1). They are saved using
+ * the JSON compilation database format in a private file of the user cache
+ * directory, so a compile_commands.json written by another tool in the
+ * build directory is never changed.
+ *---------------------------------------------------------------------------*/
+
+#include <config.h>
+
+#include "build-commands.h"
+#include "build-json.h"
+
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include <string.h>
+
+typedef struct
+{
+	gchar *directory;
+	gchar *command;
+	gint64 time;		/* Time when the command has been read */
+} BuildCommand;
+
+struct _BuildCommandDb
+{
+	gchar *build_dir;
+	gchar *filename;
+	GHashTable *commands;		/* Absolute source file name -> BuildCommand */
+	gboolean modified;
+};
+
+/* Options of gcc having an argument in the following parameter */
+static const gchar *options_with_argument[] = {
+	"-o", "-MF", "-MT", "-MQ", "-D", "-U", "-I", "-x",
+	"-include", "-imacros", "-isystem", "-iquote", "-idirafter",
+	NULL
+};
+
+static const gchar *source_extensions[] = {
+	"c", "cc", "cp", "cpp", "cxx", "c++", "C", "m", "mm",
+	NULL
+};
+
+/* Helper functions
+ *---------------------------------------------------------------------------*/
+
+static BuildCommand *
+build_command_new (const gchar *directory, const gchar *command, gint64 time)
+{
+	BuildCommand *cmd = g_new0 (BuildCommand, 1);
+
+	cmd->directory = g_strdup (directory);
+	cmd->command = g_strdup (command);
+	cmd->time = time;
+
+	return cmd;
+}
+
+static void
+build_command_free (BuildCommand *cmd)
+{
+	g_free (cmd->directory);
+	g_free (cmd->command);
+	g_free (cmd);
+}
+
+static gboolean
+build_command_is_compiler (const gchar *program)
+{
+	gchar *name;
+	gboolean found;
+
+	name = g_path_get_basename (program);
+	found = (strcmp (name, "cc") == 0) ||
+			(strcmp (name, "c++") == 0) ||
+			g_str_has_prefix (name, "gcc") ||
+			g_str_has_prefix (name, "g++") ||
+			g_str_has_prefix (name, "clang") ||
+			(strstr (name, "-gcc") != NULL) ||
+			(strstr (name, "-g++") != NULL);
+	g_free (name);
+
+	return found;
+}
+
+static gboolean
+build_command_is_source (const gchar *filename)
+{
+	const gchar *ext;
+	gint i;
+
+	ext = strrchr (filename, '.');
+	if (ext == NULL) return FALSE;
+
+	for (i = 0; source_extensions[i] != NULL; i++)
+	{
+		if (strcmp (ext + 1, source_extensions[i]) == 0) return TRUE;
+	}
+
+	return FALSE;
+}
+
+static gboolean
+build_command_has_argument (const gchar *option)
+{
+	gint i;
+
+	for (i = 0; options_with_argument[i] != NULL; i++)
+	{
+		if (strcmp (option, options_with_argument[i]) == 0) return TRUE;
+	}
+
+	return FALSE;
+}
+
+/* Return the source file compiled by the command or NULL */
+static const gchar *
+build_command_get_source (gchar **argv)
+{
+	const gchar *source = NULL;
+	gboolean compile = FALSE;
+	gint i;
+
+	/* Look for the compiler, it could be called through libtool */
+	for (i = 0; argv[i] != NULL; i++)
+	{
+		if (strcmp (argv[i], "--mode=compile") == 0) break;
+	}
+	if (argv[i] == NULL)
+	{
+		i = 0;
+	}
+	else
+	{
+		i++;
+	}
+	if ((argv[i] == NULL) || !build_command_is_compiler (argv[i])) return NULL;
+
+	for (i++; argv[i] != NULL; i++)
+	{
+		if (strcmp (argv[i], "-c") == 0)
+		{
+			compile = TRUE;
+		}
+		else if (build_command_has_argument (argv[i]))
+		{
+			if (argv[i + 1] == NULL) break;
+			i++;
+		}
+		else if ((*argv[i] != '-') && build_command_is_source (argv[i]))
+		{
+			/* Several sources cannot be compiled to one object */
+			if (source != NULL) return NULL;
+			source = argv[i];
+		}
+	}
+
+	return compile ? source : NULL;
+}
+
+static gchar *
+build_command_get_absolute_path (const gchar *directory, const gchar *filename)
+{
+	GFile *file;
+	gchar *path;
+
+	if (g_path_is_absolute (filename))
+	{
+		file = g_file_new_for_path (filename);
+	}
+	else
+	{
+		gchar *full;
+
+		full = g_build_filename (directory, filename, NULL);
+		file = g_file_new_for_path (full);
+		g_free (full);
+	}
+
+	/* Remove . and .. */
+	path = g_file_get_path (file);
+	g_object_unref (file);
+
+	return path;
+}
+
+/* Automake compiles with -MF .deps/name.Tpo and renames the dependency file
+ * to .deps/name.Po, or .deps/name.Plo with libtool, in the next command,
+ * which is not kept. Return the command writing the final dependency file
+ * directly or NULL if it cannot be changed. */
+static gchar *
+build_command_fix_dependency (const gchar *line, gchar **argv)
+{
+	const gchar *depfile = NULL;
+	gboolean libtool = FALSE;
+	gchar *option;
+	const gchar *pos;
+	GString *str;
+	gint i;
+
+	for (i = 0; argv[i] != NULL; i++)
+	{
+		if (strcmp (argv[i], "--mode=compile") == 0)
+		{
+			libtool = TRUE;
+		}
+		else if ((strcmp (argv[i], "-MF") == 0) && (argv[i + 1] != NULL))
+		{
+			depfile = argv[i + 1];
+			break;
+		}
+	}
+	if ((depfile == NULL) || !g_str_has_suffix (depfile, ".Tpo")) return g_strdup (line);
+
+	/* Change only the extension, keeping the rest of the command as is */
+	option = g_strconcat ("-MF ", depfile, NULL);
+	pos = strstr (line, option);
+	if (pos == NULL)
+	{
+		g_free (option);
+		return NULL;
+	}
+	pos += strlen (option);
+	str = g_string_new_len (line, pos - line - strlen (".Tpo"));
+	g_string_append (str, libtool ? ".Plo" : ".Po");
+	g_string_append (str, pos);
+	g_free (option);
+
+	return g_string_free (str, FALSE);
+}
+
+static gint64
+build_command_get_mtime (const gchar *filename)
+{
+	GStatBuf buf;
+
+	return g_stat (filename, &buf) == 0 ? (gint64)buf.st_mtime : -1;
+}
+
+static void
+build_command_db_add (BuildCommandDb *db, const gchar *filename, const gchar *directory, const gchar *command, gint64 time)
+{
+	BuildCommand *cmd;
+
+	cmd = g_hash_table_lookup (db->commands, filename);
+	if ((cmd != NULL) && (strcmp (cmd->directory, directory) == 0) && (strcmp (cmd->command, command) == 0))
+	{
+		/* Same command, no need to save it again */
+		cmd->time = time;
+	}
+	else
+	{
+		cmd = build_command_new (directory, command, time);
+		g_hash_table_replace (db->commands, g_strdup (filename), cmd);
+		db->modified = TRUE;
+	}
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+const gchar *
+build_command_db_get_build_dir (BuildCommandDb *db)
+{
+	return db->build_dir;
+}
+
+const gchar *
+build_command_db_get_filename (BuildCommandDb *db)
+{
+	return db->filename;
+}
+
+/* Read a compilation database, both "command" and "arguments" forms are
+ * accepted. */
+gboolean
+build_command_db_load (BuildCommandDb *db)
+{
+	gchar *content;
+	GVariant *array;
+	gint64 time;
+	gsize i;
+
+	if (!g_file_get_contents (db->filename, &content, NULL, NULL)) return FALSE;
+	array = build_json_parse (content);
+	g_free (content);
+	if (array == NULL) return FALSE;
+
+	if (g_variant_is_of_type (array, G_VARIANT_TYPE ("av")))
+	{
+		/* Entries are as old as the file */
+		time = build_command_get_mtime (db->filename);
+
+		for (i = 0; i < g_variant_n_children (array); i++)
+		{
+			GVariant *child;
+			GVariant *entry;
+			const gchar *directory;
+			const gchar *file;
+			gchar *command = NULL;
+
+			child = g_variant_get_child_value (array, i);
+			entry = g_variant_get_variant (child);
+			g_variant_unref (child);
+
+			if (g_variant_is_of_type (entry, G_VARIANT_TYPE_VARDICT) &&
+			    g_variant_lookup (entry, "directory", "&s", &directory) &&
+			    g_variant_lookup (entry, "file", "&s", &file))
+			{
+				GVariant *arguments;
+
+				if (!g_variant_lookup (entry, "command", "s", &command) &&
+				    ((arguments = g_variant_lookup_value (entry, "arguments", G_VARIANT_TYPE ("av"))) != NULL))
+				{
+					GString *str = g_string_new (NULL);
+					gsize j;
+
+					for (j = 0; j < g_variant_n_children (arguments); j++)
+					{
+						GVariant *arg = g_variant_get_child_value (arguments, j);
+						GVariant *value = g_variant_get_variant (arg);
+
+						if (g_variant_is_of_type (value, G_VARIANT_TYPE_STRING))
+						{
+							gchar *quoted = g_shell_quote (g_variant_get_string (value, NULL));
+
+							if (str->len != 0) g_string_append_c (str, ' ');
+							g_string_append (str, quoted);
+							g_free (quoted);
+						}
+						g_variant_unref (value);
+						g_variant_unref (arg);
+					}
+					g_variant_unref (arguments);
+					command = g_string_free (str, FALSE);
+				}
+
+				if (command != NULL)
+				{
+					gchar *path = build_command_get_absolute_path (directory, file);
+
+					build_command_db_add (db, path, directory, command, time);
+					g_free (path);
+					g_free (command);
+				}
+			}
+			g_variant_unref (entry);
+		}
+	}
+	g_variant_unref (array);
+
+	/* Nothing new compared to the file */
+	db->modified = FALSE;
+
+	return TRUE;
+}
+
+/* Write the database if it has been modified */
+gboolean
+build_command_db_save (BuildCommandDb *db)
+{
+	GString *str;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	gboolean first = TRUE;
+	gboolean ok;
+
+	if (!db->modified) return TRUE;
+
+	str = g_string_new ("[");
+	g_hash_table_iter_init (&iter, db->commands);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		BuildCommand *cmd = (BuildCommand *)value;
+
+		g_string_append (str, first ? "\n" : ",\n");
+		g_string_append (str, "  {\n    \"directory\": ");
+		build_json_append_string (str, cmd->directory);
+		g_string_append (str, ",\n    \"command\": ");
+		build_json_append_string (str, cmd->command);
+		g_string_append (str, ",\n    \"file\": ");
+		build_json_append_string (str, (const gchar *)key);
+		g_string_append (str, "\n  }");
+		first = FALSE;
+	}
+	g_string_append (str, "\n]\n");
+
+	ok = g_file_set_contents (db->filename, str->str, str->len, NULL);
+	g_string_free (str, TRUE);
+	if (ok) db->modified = FALSE;
+
+	return ok;
+}
+
+/* Check if the line is a command compiling one source file and keep it.
+ * directory is the current directory of make. */
+gboolean
+build_command_db_capture (BuildCommandDb *db, const gchar *directory, const gchar *line)
+{
+	gchar **argv;
+	const gchar *source;
+	gchar *command;
+	gboolean found = FALSE;
+
+	/* Fast checks before splitting the line */
+	if ((directory == NULL) || (strstr (line, " -c") == NULL)) return FALSE;
+	while (g_ascii_isspace (*line)) line++;
+
+	/* Skip commands echoed by libtool, the libtool command is kept instead,
+	 * and commands needing a shell */
+	if (g_str_has_prefix (line, "libtool:")) return FALSE;
+	if (strpbrk (line, "`;|&<>$") != NULL) return FALSE;
+
+	if (!g_shell_parse_argv (line, NULL, &argv, NULL)) return FALSE;
+
+	source = build_command_get_source (argv);
+	command = source != NULL ? build_command_fix_dependency (line, argv) : NULL;
+	if (command != NULL)
+	{
+		gchar *path = build_command_get_absolute_path (directory, source);
+
+		build_command_db_add (db, path, directory, command, g_get_real_time () / G_USEC_PER_SEC);
+		g_free (path);
+		g_free (command);
+		found = TRUE;
+	}
+	g_strfreev (argv);
+
+	return found;
+}
+
+/* Check if a file used to generate the makefile has changed after time.
+ * Missing files are ignored if optional is TRUE. */
+static gboolean
+build_command_is_newer (const gchar *directory, const gchar *name, gint64 time, gboolean optional)
+{
+	gchar *filename;
+	gint64 mtime;
+
+	filename = g_build_filename (directory, name, NULL);
+	mtime = build_command_get_mtime (filename);
+	g_free (filename);
+
+	return mtime < 0 ? !optional : mtime > time;
+}
+
+/* Get the command used to compile filename. Return FALSE if there is no
+ * such command or if the makefile, or one of the files it is generated
+ * from, has changed since: the command could use old flags. */
+gboolean
+build_command_db_lookup (BuildCommandDb *db, const gchar *filename, gchar **directory, gchar **command)
+{
+	BuildCommand *cmd;
+	gchar *source_dir;
+	gboolean stale;
+
+	cmd = g_hash_table_lookup (db->commands, filename);
+	if (cmd == NULL) return FALSE;
+
+	source_dir = g_path_get_dirname (filename);
+	stale = build_command_is_newer (cmd->directory, "Makefile", cmd->time, FALSE) ||
+			build_command_is_newer (source_dir, "Makefile.am", cmd->time, TRUE) ||
+			build_command_is_newer (source_dir, "Makefile.in", cmd->time, TRUE) ||
+			build_command_is_newer (db->build_dir, "config.status", cmd->time, TRUE);
+	g_free (source_dir);
+	if (stale) return FALSE;
+
+	if (directory != NULL) *directory = g_strdup (cmd->directory);
+	if (command != NULL) *command = g_strdup (cmd->command);
+
+	return TRUE;
+}
+
+/* Constructor & Destructor
+ *---------------------------------------------------------------------------*/
+
+BuildCommandDb*
+build_command_db_new (const gchar *build_dir, const gchar *filename)
+{
+	BuildCommandDb *db;
+
+	db = g_new0 (BuildCommandDb, 1);
+	db->build_dir = g_strdup (build_dir);
+	db->filename = g_strdup (filename);
+	db->commands = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)build_command_free);
+
+	return db;
+}
+
+void
+build_command_db_free (BuildCommandDb *db)
+{
+	g_hash_table_destroy (db->commands);
+	g_free (db->build_dir);
+	g_free (db->filename);
+	g_free (db);
+}
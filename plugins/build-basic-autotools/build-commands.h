@@ -0,0 +1,41 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-commands.h
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef BUILD_COMMANDS_H
+#define BUILD_COMMANDS_H
+
+#include <glib.h>
+
+/* Directory of the databases in the user cache directory */
+#define COMPILE_COMMANDS_DIR "build-commands"
+
+typedef struct _BuildCommandDb BuildCommandDb;
+
+BuildCommandDb* build_command_db_new (const gchar *build_dir, const gchar *filename);
+void build_command_db_free (BuildCommandDb *db);
+
+const gchar *build_command_db_get_build_dir (BuildCommandDb *db);
+const gchar *build_command_db_get_filename (BuildCommandDb *db);
+gboolean build_command_db_load (BuildCommandDb *db);
+gboolean build_command_db_save (BuildCommandDb *db);
+
+gboolean build_command_db_capture (BuildCommandDb *db, const gchar *directory, const gchar *line);
+gboolean build_command_db_lookup (BuildCommandDb *db, const gchar *filename, gchar **directory, gchar **command);
+
+#endif /* BUILD_COMMANDS_H */
@@ -0,0 +1,468 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-diagnostics.c
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * GCC is able to write its diagnostics in JSON with the option
+ * -fdiagnostics-format=json. All diagnostics of a compilation are written as
+ * one array on a single line of the standard error. Each diagnostic has
+ * a kind, a message, exact locations with column ranges, fix-it hints and
+ * children notes.
+ *
+ * These functions parse such a line, so the messages do not have to be
+ * scraped from the text output, and add the needed option to the configure
+ * arguments.
+ *---------------------------------------------------------------------------*/
+
+#include <config.h>
+
+#include "build-diagnostics.h"
+#include "build-json.h"
+
+#include <glib/gi18n.h>
+
+#include <string.h>
+#include <sys/wait.h>
+
+/* Option making gcc write diagnostics in JSON */
+#define JSON_DIAGNOSTICS_FLAG "-fdiagnostics-format=json"
+
+/* Flags used by autoconf for gcc when CFLAGS is not defined */
+#define DEFAULT_FLAGS "-g -O2"
+
+/* Diagnostics
+ *---------------------------------------------------------------------------*/
+
+static gchar *
+build_variant_dup_string (GVariant *dict, const gchar *key)
+{
+	const gchar *str;
+
+	return g_variant_lookup (dict, key, "&s", &str) ? g_strdup (str) : NULL;
+}
+
+static gint
+build_variant_get_int (GVariant *dict, const gchar *key)
+{
+	gdouble number;
+
+	return g_variant_lookup (dict, key, "d", &number) ? (gint)number : 0;
+}
+
+/* Return the nth object of an array of variants */
+static GVariant *
+build_variant_get_object (GVariant *array, gsize index)
+{
+	GVariant *child;
+	GVariant *object;
+
+	child = g_variant_get_child_value (array, index);
+	object = g_variant_get_variant (child);
+	g_variant_unref (child);
+
+	if (!g_variant_is_of_type (object, G_VARIANT_TYPE_VARDICT))
+	{
+		g_variant_unref (object);
+		return NULL;
+	}
+
+	return object;
+}
+
+static gchar *
+build_diagnostic_fixit_new (GVariant *fixit)
+{
+	GVariant *start;
+	GVariant *next;
+	gchar *text;
+	gchar *str = NULL;
+
+	start = g_variant_lookup_value (fixit, "start", G_VARIANT_TYPE_VARDICT);
+	next = g_variant_lookup_value (fixit, "next", G_VARIANT_TYPE_VARDICT);
+	text = build_variant_dup_string (fixit, "string");
+	if ((start != NULL) && (next != NULL) && (text != NULL))
+	{
+		gint line = build_variant_get_int (start, "line");
+		gint column = build_variant_get_int (start, "column");
+		gint end_column = build_variant_get_int (next, "column");
+
+		if (column == end_column)
+		{
+			str = g_strdup_printf (_("%d:%d: fix-it: insert \"%s\""), line, column, text);
+		}
+		else if (*text == '\0')
+		{
+			str = g_strdup_printf (_("%d:%d: fix-it: remove columns %d-%d"), line, column, column, end_column - 1);
+		}
+		else
+		{
+			str = g_strdup_printf (_("%d:%d: fix-it: replace columns %d-%d with \"%s\""), line, column, column, end_column - 1, text);
+		}
+	}
+	if (start != NULL) g_variant_unref (start);
+	if (next != NULL) g_variant_unref (next);
+	g_free (text);
+
+	return str;
+}
+
+static gboolean
+build_diagnostics_add (GList **list, GVariant *object, gboolean child)
+{
+	BuildDiagnostic *diagnostic;
+	GVariant *array;
+
+	diagnostic = g_new0 (BuildDiagnostic, 1);
+	diagnostic->kind = build_variant_dup_string (object, "kind");
+	diagnostic->message = build_variant_dup_string (object, "message");
+	if ((diagnostic->kind == NULL) || (diagnostic->message == NULL))
+	{
+		/* Not a gcc diagnostic */
+		build_diagnostic_free (diagnostic);
+		return FALSE;
+	}
+	diagnostic->option = build_variant_dup_string (object, "option");
+	diagnostic->child = child;
+
+	/* Main location */
+	array = g_variant_lookup_value (object, "locations", G_VARIANT_TYPE ("av"));
+	if (array != NULL)
+	{
+		GVariant *location = g_variant_n_children (array) > 0 ? build_variant_get_object (array, 0) : NULL;
+
+		if (location != NULL)
+		{
+			GVariant *caret = g_variant_lookup_value (location, "caret", G_VARIANT_TYPE_VARDICT);
+			GVariant *finish = g_variant_lookup_value (location, "finish", G_VARIANT_TYPE_VARDICT);
+
+			if (caret != NULL)
+			{
+				diagnostic->filename = build_variant_dup_string (caret, "file");
+				diagnostic->line = build_variant_get_int (caret, "line");
+				diagnostic->column = build_variant_get_int (caret, "column");
+				g_variant_unref (caret);
+			}
+			if (finish != NULL)
+			{
+				if (build_variant_get_int (finish, "line") == diagnostic->line)
+				{
+					diagnostic->end_column = build_variant_get_int (finish, "column");
+				}
+				g_variant_unref (finish);
+			}
+			g_variant_unref (location);
+		}
+		g_variant_unref (array);
+	}
+
+	/* Fix-it hints */
+	array = g_variant_lookup_value (object, "fixits", G_VARIANT_TYPE ("av"));
+	if (array != NULL)
+	{
+		gsize n_fixits = g_variant_n_children (array);
+		gsize i, j;
+
+		diagnostic->fixits = g_new0 (gchar *, n_fixits + 1);
+		for (i = 0, j = 0; i < n_fixits; i++)
+		{
+			GVariant *fixit = build_variant_get_object (array, i);
+
+			if (fixit != NULL)
+			{
+				diagnostic->fixits[j] = build_diagnostic_fixit_new (fixit);
+				if (diagnostic->fixits[j] != NULL) j++;
+				g_variant_unref (fixit);
+			}
+		}
+		g_variant_unref (array);
+	}
+	*list = g_list_prepend (*list, diagnostic);
+
+	/* Notes */
+	array = g_variant_lookup_value (object, "children", G_VARIANT_TYPE ("av"));
+	if (array != NULL)
+	{
+		gsize n_children = g_variant_n_children (array);
+		gsize i;
+
+		for (i = 0; i < n_children; i++)
+		{
+			GVariant *note = build_variant_get_object (array, i);
+
+			if (note != NULL)
+			{
+				build_diagnostics_add (list, note, TRUE);
+				g_variant_unref (note);
+			}
+		}
+		g_variant_unref (array);
+	}
+
+	return TRUE;
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+/* Parse a line written by gcc with -fdiagnostics-format=json. Return FALSE if
+ * it is not such line, else diagnostics contains a list of BuildDiagnostic
+ * in the order of the output. An empty array is valid: gcc writes it when
+ * there is no diagnostic. */
+gboolean
+build_diagnostics_parse (const gchar *line, GList **diagnostics)
+{
+	GVariant *array;
+	gsize n_items;
+	gsize i;
+	gboolean ok = TRUE;
+
+	*diagnostics = NULL;
+
+	/* Check the first character before trying to parse the line */
+	if (line[0] != '[') return FALSE;
+
+	array = build_json_parse (line);
+	if (array == NULL) return FALSE;
+	if (!g_variant_is_of_type (array, G_VARIANT_TYPE ("av")))
+	{
+		g_variant_unref (array);
+		return FALSE;
+	}
+
+	n_items = g_variant_n_children (array);
+	for (i = 0; ok && (i < n_items); i++)
+	{
+		GVariant *object = build_variant_get_object (array, i);
+
+		ok = (object != NULL) && build_diagnostics_add (diagnostics, object, FALSE);
+		if (object != NULL) g_variant_unref (object);
+	}
+	g_variant_unref (array);
+
+	if (!ok)
+	{
+		g_list_foreach (*diagnostics, (GFunc)build_diagnostic_free, NULL);
+		g_list_free (*diagnostics);
+		*diagnostics = NULL;
+		return FALSE;
+	}
+	*diagnostics = g_list_reverse (*diagnostics);
+
+	return TRUE;
+}
+
+void
+build_diagnostic_free (BuildDiagnostic *diagnostic)
+{
+	g_free (diagnostic->kind);
+	g_free (diagnostic->message);
+	g_free (diagnostic->option);
+	g_free (diagnostic->filename);
+	g_strfreev (diagnostic->fixits);
+	g_free (diagnostic);
+}
+
+/* Return the diagnostic like gcc writes it in text mode, using filename
+ * instead of the file name of the diagnostic if not NULL. */
+gchar *
+build_diagnostic_to_string (BuildDiagnostic *diagnostic, const gchar *filename)
+{
+	GString *str;
+
+	if (filename == NULL) filename = diagnostic->filename;
+
+	str = g_string_new (NULL);
+	if (filename != NULL)
+	{
+		g_string_append (str, filename);
+		if (diagnostic->line > 0)
+		{
+			g_string_append_printf (str, ":%d", diagnostic->line);
+			if (diagnostic->column > 0) g_string_append_printf (str, ":%d", diagnostic->column);
+		}
+		g_string_append (str, ": ");
+	}
+	g_string_append_printf (str, "%s: %s", diagnostic->kind, diagnostic->message);
+	if (diagnostic->option != NULL) g_string_append_printf (str, " [%s]", diagnostic->option);
+
+	return g_string_free (str, FALSE);
+}
+
+/* Compiler options
+ *---------------------------------------------------------------------------*/
+
+/* Check if the compiler accepts the option to write diagnostics in JSON,
+ * the compiler is run only once */
+static gboolean
+build_diagnostics_compiler_has_json (const gchar *compiler, const gchar *language)
+{
+	static GHashTable *probed = NULL;
+	gchar *key;
+	gpointer value;
+	gchar **argv;
+	gint argc;
+	gint status;
+	gboolean supported = FALSE;
+
+	if (probed == NULL) probed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	key = g_strconcat (language, " ", compiler, NULL);
+	if (g_hash_table_lookup_extended (probed, key, NULL, &value))
+	{
+		g_free (key);
+		return GPOINTER_TO_INT (value);
+	}
+
+	if (g_shell_parse_argv (compiler, &argc, &argv, NULL))
+	{
+		gchar **probe_argv;
+		gint i;
+
+		/* Preprocess an empty file with the option */
+		probe_argv = g_new (gchar *, argc + 6);
+		for (i = 0; i < argc; i++) probe_argv[i] = argv[i];
+		probe_argv[i++] = JSON_DIAGNOSTICS_FLAG;
+		probe_argv[i++] = "-E";
+		probe_argv[i++] = "-x";
+		probe_argv[i++] = (gchar *)language;
+		probe_argv[i++] = "/dev/null";
+		probe_argv[i] = NULL;
+
+		supported = g_spawn_sync (NULL, probe_argv, NULL,
+		                          G_SPAWN_SEARCH_PATH | G_SPAWN_STDOUT_TO_DEV_NULL | G_SPAWN_STDERR_TO_DEV_NULL,
+		                          NULL, NULL, NULL, NULL, &status, NULL) &&
+			WIFEXITED (status) && (WEXITSTATUS (status) == 0);
+		g_free (probe_argv);
+		g_strfreev (argv);
+	}
+	g_hash_table_insert (probed, key, GINT_TO_POINTER (supported));
+
+	return supported;
+}
+
+/* Get the value of a variable defined in the arguments or in the environment */
+static const gchar *
+build_diagnostics_get_variable (gchar **argv, GList *vars, const gchar *name, const gchar *value)
+{
+	GList *item;
+	gint i;
+
+	for (item = vars; item != NULL; item = g_list_next (item))
+	{
+		if (g_str_has_prefix ((const gchar *)item->data, name))
+		{
+			value = (const gchar *)item->data + strlen (name);
+		}
+	}
+	for (i = 0; (argv != NULL) && (argv[i] != NULL); i++)
+	{
+		if (g_str_has_prefix (argv[i], name))
+		{
+			value = argv[i] + strlen (name);
+		}
+	}
+
+	return value;
+}
+
+/* Return new configure arguments with the option needed to get diagnostics
+ * in JSON added to CFLAGS and CXXFLAGS if the C and C++ compilers support it.
+ * The variables defined in the environment are used if the arguments do not
+ * define them. */
+gchar *
+build_diagnostics_add_flags (const gchar *args, GList *vars)
+{
+	static const gchar *flags[] = {"CFLAGS=", "CXXFLAGS=", NULL};
+	static const gchar *compilers[] = {"CC=", "CXX=", NULL};
+	static const gchar *default_compilers[] = {"gcc", "g++", NULL};
+	static const gchar *languages[] = {"c", "c++", NULL};
+	gchar **argv = NULL;
+	GString *new_args;
+	gboolean found[G_N_ELEMENTS (flags)] = {FALSE};
+	gboolean supported[G_N_ELEMENTS (flags)];
+	gint i;
+	gint j;
+
+	if ((args != NULL) && (*args != '\0') && !g_shell_parse_argv (args, NULL, &argv, NULL))
+	{
+		/* Keep arguments unchanged */
+		return g_strdup (args);
+	}
+
+	/* Do not add the option if the compiler does not know it */
+	for (j = 0; flags[j] != NULL; j++)
+	{
+		const gchar *compiler;
+
+		compiler = build_diagnostics_get_variable (argv, vars, compilers[j], default_compilers[j]);
+		supported[j] = build_diagnostics_compiler_has_json (compiler, languages[j]);
+	}
+
+	new_args = g_string_new (NULL);
+	for (i = 0; (argv != NULL) && (argv[i] != NULL); i++)
+	{
+		gchar *arg = argv[i];
+		gchar *quoted;
+
+		for (j = 0; flags[j] != NULL; j++)
+		{
+			if (supported[j] && g_str_has_prefix (argv[i], flags[j]))
+			{
+				found[j] = TRUE;
+				if (strstr (argv[i], JSON_DIAGNOSTICS_FLAG) == NULL)
+				{
+					arg = g_strconcat (argv[i], " " JSON_DIAGNOSTICS_FLAG, NULL);
+				}
+			}
+		}
+		quoted = g_shell_quote (arg);
+		if (arg != argv[i]) g_free (arg);
+		if (new_args->len != 0) g_string_append_c (new_args, ' ');
+		g_string_append (new_args, quoted);
+		g_free (quoted);
+	}
+	g_strfreev (argv);
+
+	for (j = 0; flags[j] != NULL; j++)
+	{
+		const gchar *value = DEFAULT_FLAGS;
+		GList *item;
+		gchar *arg;
+		gchar *quoted;
+
+		if (found[j] || !supported[j]) continue;
+
+		/* Keep the value from the environment */
+		for (item = vars; item != NULL; item = g_list_next (item))
+		{
+			if (g_str_has_prefix ((const gchar *)item->data, flags[j]))
+			{
+				value = (const gchar *)item->data + strlen (flags[j]);
+			}
+		}
+
+		arg = g_strconcat (flags[j], value, " " JSON_DIAGNOSTICS_FLAG, NULL);
+		quoted = g_shell_quote (arg);
+		if (new_args->len != 0) g_string_append_c (new_args, ' ');
+		g_string_append (new_args, quoted);
+		g_free (quoted);
+		g_free (arg);
+	}
+
+	return g_string_free (new_args, FALSE);
+}
@@ -0,0 +1,46 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-diagnostics.h
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef BUILD_DIAGNOSTICS_H
+#define BUILD_DIAGNOSTICS_H
+
+#include <glib.h>
+
+typedef struct _BuildDiagnostic BuildDiagnostic;
+
+struct _BuildDiagnostic
+{
+	gchar *kind;		/* "error", "warning", "note"... */
+	gchar *message;
+	gchar *option;		/* Option enabling the warning or NULL */
+	gchar *filename;	/* File of the main location or NULL */
+	gint line;
+	gint column;
+	gint end_column;	/* Last column if the range is on one line or 0 */
+	gchar **fixits;		/* Suggested changes, one per line */
+	gboolean child;		/* Note attached to the previous diagnostic */
+};
+
+gboolean build_diagnostics_parse (const gchar *line, GList **diagnostics);
+void build_diagnostic_free (BuildDiagnostic *diagnostic);
+gchar *build_diagnostic_to_string (BuildDiagnostic *diagnostic, const gchar *filename);
+
+gchar *build_diagnostics_add_flags (const gchar *args, GList *vars);
+
+#endif /* BUILD_DIAGNOSTICS_H */
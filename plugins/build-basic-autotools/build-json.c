@@ -0,0 +1,399 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-json.c
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * Small JSON reader and writer helpers, enough for the output of compilers
+ * and compilation databases.
+ *---------------------------------------------------------------------------*/
+
+#include <config.h>
+
+#include "build-json.h"
+
+#include <string.h>
+
+/* Maximum nesting of JSON values */
+#define JSON_MAX_DEPTH 32
+
+/* Minimal JSON parser
+ *
+ * The values are converted to GVariant: objects are a{sv}, arrays av,
+ * strings s, numbers d, booleans b and null is an empty mv.
+ *---------------------------------------------------------------------------*/
+
+typedef struct
+{
+	const gchar *ptr;
+	gint depth;
+} BuildJsonParser;
+
+static GVariant *build_json_parse_value (BuildJsonParser *parser);
+
+static void
+build_json_skip_space (BuildJsonParser *parser)
+{
+	while ((*parser->ptr == ' ') || (*parser->ptr == '\t') || (*parser->ptr == '\n') || (*parser->ptr == '\r'))
+	{
+		parser->ptr++;
+	}
+}
+
+static gboolean
+build_json_parse_hex (const gchar *ptr, gunichar *value)
+{
+	gint i;
+
+	*value = 0;
+	for (i = 0; i < 4; i++)
+	{
+		if (!g_ascii_isxdigit (ptr[i])) return FALSE;
+		*value = (*value << 4) | g_ascii_xdigit_value (ptr[i]);
+	}
+
+	return TRUE;
+}
+
+/* Return a newly allocated UTF-8 string or NULL */
+static gchar *
+build_json_parse_string (BuildJsonParser *parser)
+{
+	GString *str;
+	const gchar *ptr = parser->ptr;
+
+	if (*ptr != '"') return NULL;
+	ptr++;
+
+	str = g_string_new (NULL);
+	for (;;)
+	{
+		const gchar *end;
+
+		/* Copy characters without escape at once */
+		for (end = ptr; (*end != '"') && (*end != '\\') && (*end != '\0'); end++);
+		g_string_append_len (str, ptr, end - ptr);
+		ptr = end;
+
+		if (*ptr == '"')
+		{
+			ptr++;
+			break;
+		}
+		else if (*ptr == '\0')
+		{
+			g_string_free (str, TRUE);
+			return NULL;
+		}
+
+		/* Escaped character */
+		ptr++;
+		switch (*ptr)
+		{
+		case '"':
+		case '\\':
+		case '/':
+			g_string_append_c (str, *ptr);
+			break;
+		case 'b':
+			g_string_append_c (str, '\b');
+			break;
+		case 'f':
+			g_string_append_c (str, '\f');
+			break;
+		case 'n':
+			g_string_append_c (str, '\n');
+			break;
+		case 'r':
+			g_string_append_c (str, '\r');
+			break;
+		case 't':
+			g_string_append_c (str, '\t');
+			break;
+		case 'u':
+			{
+				gunichar c;
+
+				if (!build_json_parse_hex (ptr + 1, &c))
+				{
+					g_string_free (str, TRUE);
+					return NULL;
+				}
+				ptr += 4;
+				if ((c >= 0xD800) && (c < 0xDC00))
+				{
+					gunichar low;
+
+					/* Surrogate pair */
+					if ((ptr[1] != '\\') || (ptr[2] != 'u') ||
+					    !build_json_parse_hex (ptr + 3, &low) ||
+					    (low < 0xDC00) || (low >= 0xE000))
+					{
+						g_string_free (str, TRUE);
+						return NULL;
+					}
+					c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+					ptr += 6;
+				}
+				g_string_append_unichar (str, c);
+			}
+			break;
+		default:
+			g_string_free (str, TRUE);
+			return NULL;
+		}
+		ptr++;
+	}
+
+	if (!g_utf8_validate (str->str, str->len, NULL))
+	{
+		g_string_free (str, TRUE);
+		return NULL;
+	}
+	parser->ptr = ptr;
+
+	return g_string_free (str, FALSE);
+}
+
+static GVariant *
+build_json_parse_object (BuildJsonParser *parser)
+{
+	GVariantBuilder builder;
+
+	parser->ptr++;
+	g_variant_builder_init (&builder, G_VARIANT_TYPE_VARDICT);
+	build_json_skip_space (parser);
+	if (*parser->ptr == '}')
+	{
+		parser->ptr++;
+		return g_variant_builder_end (&builder);
+	}
+
+	for (;;)
+	{
+		gchar *name;
+		GVariant *value;
+
+		build_json_skip_space (parser);
+		name = build_json_parse_string (parser);
+		if (name == NULL) break;
+
+		build_json_skip_space (parser);
+		if (*parser->ptr != ':')
+		{
+			g_free (name);
+			break;
+		}
+		parser->ptr++;
+
+		value = build_json_parse_value (parser);
+		if (value == NULL)
+		{
+			g_free (name);
+			break;
+		}
+		g_variant_builder_add (&builder, "{sv}", name, value);
+		g_free (name);
+
+		build_json_skip_space (parser);
+		if (*parser->ptr == '}')
+		{
+			parser->ptr++;
+			return g_variant_builder_end (&builder);
+		}
+		else if (*parser->ptr != ',')
+		{
+			break;
+		}
+		parser->ptr++;
+	}
+
+	g_variant_builder_clear (&builder);
+
+	return NULL;
+}
+
+static GVariant *
+build_json_parse_array (BuildJsonParser *parser)
+{
+	GVariantBuilder builder;
+
+	parser->ptr++;
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("av"));
+	build_json_skip_space (parser);
+	if (*parser->ptr == ']')
+	{
+		parser->ptr++;
+		return g_variant_builder_end (&builder);
+	}
+
+	for (;;)
+	{
+		GVariant *value;
+
+		value = build_json_parse_value (parser);
+		if (value == NULL) break;
+		g_variant_builder_add (&builder, "v", value);
+
+		build_json_skip_space (parser);
+		if (*parser->ptr == ']')
+		{
+			parser->ptr++;
+			return g_variant_builder_end (&builder);
+		}
+		else if (*parser->ptr != ',')
+		{
+			break;
+		}
+		parser->ptr++;
+	}
+
+	g_variant_builder_clear (&builder);
+
+	return NULL;
+}
+
+/* Return a floating reference on the parsed value or NULL */
+static GVariant *
+build_json_parse_value (BuildJsonParser *parser)
+{
+	GVariant *value = NULL;
+
+	if (parser->depth >= JSON_MAX_DEPTH) return NULL;
+	parser->depth++;
+
+	build_json_skip_space (parser);
+	switch (*parser->ptr)
+	{
+	case '{':
+		value = build_json_parse_object (parser);
+		break;
+	case '[':
+		value = build_json_parse_array (parser);
+		break;
+	case '"':
+		{
+			gchar *str = build_json_parse_string (parser);
+
+			if (str != NULL) value = g_variant_new_string (str);
+			g_free (str);
+		}
+		break;
+	case 't':
+		if (strncmp (parser->ptr, "true", 4) == 0)
+		{
+			parser->ptr += 4;
+			value = g_variant_new_boolean (TRUE);
+		}
+		break;
+	case 'f':
+		if (strncmp (parser->ptr, "false", 5) == 0)
+		{
+			parser->ptr += 5;
+			value = g_variant_new_boolean (FALSE);
+		}
+		break;
+	case 'n':
+		if (strncmp (parser->ptr, "null", 4) == 0)
+		{
+			parser->ptr += 4;
+			value = g_variant_new_maybe (G_VARIANT_TYPE_VARIANT, NULL);
+		}
+		break;
+	default:
+		{
+			gchar *end;
+			gdouble number;
+
+			number = g_ascii_strtod (parser->ptr, &end);
+			if (end != parser->ptr)
+			{
+				parser->ptr = end;
+				value = g_variant_new_double (number);
+			}
+		}
+		break;
+	}
+	parser->depth--;
+
+	return value;
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+/* Parse a complete JSON text, return a new GVariant or NULL if the text is
+ * not valid. */
+GVariant *
+build_json_parse (const gchar *text)
+{
+	BuildJsonParser parser;
+	GVariant *value;
+
+	parser.ptr = text;
+	parser.depth = 0;
+	value = build_json_parse_value (&parser);
+	if (value == NULL) return NULL;
+	g_variant_ref_sink (value);
+
+	build_json_skip_space (&parser);
+	if (*parser.ptr != '\0')
+	{
+		g_variant_unref (value);
+		return NULL;
+	}
+
+	return value;
+}
+
+/* Append text as a quoted JSON string */
+void
+build_json_append_string (GString *str, const gchar *text)
+{
+	const gchar *ptr;
+
+	g_string_append_c (str, '"');
+	for (ptr = text; *ptr != '\0'; ptr++)
+	{
+		switch (*ptr)
+		{
+		case '"':
+			g_string_append (str, "\\\"");
+			break;
+		case '\\':
+			g_string_append (str, "\\\\");
+			break;
+		case '\n':
+			g_string_append (str, "\\n");
+			break;
+		case '\t':
+			g_string_append (str, "\\t");
+			break;
+		default:
+			if ((guchar)*ptr < 0x20)
+			{
+				g_string_append_printf (str, "\\u%04x", (guchar)*ptr);
+			}
+			else
+			{
+				g_string_append_c (str, *ptr);
+			}
+			break;
+		}
+	}
+	g_string_append_c (str, '"');
+}
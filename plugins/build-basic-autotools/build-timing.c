@@ -0,0 +1,374 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-timing.c
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*
+ * Record how long each directory and each command takes during a build.
+ *
+ * make displays the commands when they start but nothing when they end, so
+ * the end of a command is the modification time of the file written by it
+ * (the -o argument). This works with parallel builds too. If the file has
+ * not been written, the command is considered done when the next command
+ * starts in the same directory or when make leaves it. Directories are timed
+ * using make "Entering" and "Leaving" messages.
+ *---------------------------------------------------------------------------*/
+
+#include <config.h>
+
+#include "build-timing.h"
+
+#include <glib/gi18n.h>
+
+#include <string.h>
+
+enum {
+	COLUMN_NAME,
+	COLUMN_KIND,
+	COLUMN_TIME,
+	N_COLUMNS
+};
+
+typedef struct
+{
+	gchar *name;		/* Directory or file written by the command */
+	gboolean directory;
+	gint64 start;		/* In microseconds */
+	gint64 end;			/* 0 if unknown */
+	gint64 next;		/* Start of the next command in the same directory or 0 */
+} BuildTimingItem;
+
+struct _BuildTiming
+{
+	gchar *directory;		/* Build directory, names are displayed relative to it */
+	GPtrArray *items;
+	GHashTable *depths;		/* Directory name -> number of sub-makes in it */
+	GHashTable *running;	/* Directory name and depth -> BuildTimingItem */
+	GHashTable *commands;	/* Directory name -> last BuildTimingItem command */
+	gint64 start;
+	gint64 end;
+};
+
+/* Only one report window is kept */
+static GtkWidget *report_window = NULL;
+
+/* Helper functions
+ *---------------------------------------------------------------------------*/
+
+static BuildTimingItem *
+build_timing_item_new (BuildTiming *timing, const gchar *name, gboolean directory)
+{
+	BuildTimingItem *item = g_slice_new0 (BuildTimingItem);
+
+	item->name = g_strdup (name);
+	item->directory = directory;
+	item->start = g_get_real_time ();
+	g_ptr_array_add (timing->items, item);
+
+	return item;
+}
+
+static void
+build_timing_item_free (BuildTimingItem *item)
+{
+	g_free (item->name);
+	g_slice_free (BuildTimingItem, item);
+}
+
+/* Return the argument of -o or NULL */
+static const gchar *
+build_timing_get_output (gchar **argv)
+{
+	gint i;
+
+	for (i = 1; argv[i] != NULL; i++)
+	{
+		if ((strcmp (argv[i], "-o") == 0) && (argv[i + 1] != NULL)) return argv[i + 1];
+	}
+
+	return NULL;
+}
+
+/* Mark the end of the previous command started in the directory */
+static void
+build_timing_end_command (BuildTiming *timing, const gchar *directory, gint64 time)
+{
+	BuildTimingItem *item;
+
+	item = g_hash_table_lookup (timing->commands, directory);
+	if ((item != NULL) && (item->next == 0)) item->next = time;
+	g_hash_table_remove (timing->commands, directory);
+}
+
+static gint64
+build_timing_get_mtime (const gchar *filename)
+{
+	GFile *file;
+	GFileInfo *info;
+	gint64 time = 0;
+
+	file = g_file_new_for_path (filename);
+	info = g_file_query_info (file,
+	                          G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+	                          G_FILE_QUERY_INFO_NONE, NULL, NULL);
+	if (info != NULL)
+	{
+		time = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC +
+			g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+		g_object_unref (info);
+	}
+	g_object_unref (file);
+
+	return time;
+}
+
+static void
+build_timing_render_time (GtkTreeViewColumn *column, GtkCellRenderer *renderer,
+                          GtkTreeModel *model, GtkTreeIter *iter, gpointer user_data)
+{
+	gdouble time;
+	gchar *text;
+
+	gtk_tree_model_get (model, iter, COLUMN_TIME, &time, -1);
+	text = g_strdup_printf ("%.2f s", time);
+	g_object_set (renderer, "text", text, NULL);
+	g_free (text);
+}
+
+static void
+build_timing_add_column (GtkTreeView *view, const gchar *title, gint column)
+{
+	GtkCellRenderer *renderer;
+	GtkTreeViewColumn *col;
+
+	renderer = gtk_cell_renderer_text_new ();
+	if (column == COLUMN_TIME)
+	{
+		g_object_set (renderer, "xalign", 1.0, NULL);
+		col = gtk_tree_view_column_new_with_attributes (title, renderer, NULL);
+		gtk_tree_view_column_set_cell_data_func (col, renderer, build_timing_render_time, NULL, NULL);
+	}
+	else
+	{
+		col = gtk_tree_view_column_new_with_attributes (title, renderer, "text", column, NULL);
+	}
+	gtk_tree_view_column_set_sort_column_id (col, column);
+	gtk_tree_view_column_set_resizable (col, TRUE);
+	gtk_tree_view_column_set_expand (col, column == COLUMN_NAME);
+	gtk_tree_view_append_column (view, col);
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+/* The same directory can be entered several times by recursive makes, each
+ * one is recorded with its depth */
+void
+build_timing_enter_directory (BuildTiming *timing, const gchar *directory)
+{
+	BuildTimingItem *item;
+	gint depth;
+
+	depth = GPOINTER_TO_INT (g_hash_table_lookup (timing->depths, directory)) + 1;
+	g_hash_table_replace (timing->depths, g_strdup (directory), GINT_TO_POINTER (depth));
+
+	item = build_timing_item_new (timing, directory, TRUE);
+	g_hash_table_replace (timing->running, g_strdup_printf ("%s:%d", directory, depth), item);
+}
+
+void
+build_timing_leave_directory (BuildTiming *timing, const gchar *directory)
+{
+	BuildTimingItem *item;
+	gint depth;
+	gchar *key;
+
+	depth = GPOINTER_TO_INT (g_hash_table_lookup (timing->depths, directory));
+	if (depth == 0) return;
+	if (depth > 1)
+	{
+		g_hash_table_replace (timing->depths, g_strdup (directory), GINT_TO_POINTER (depth - 1));
+	}
+	else
+	{
+		g_hash_table_remove (timing->depths, directory);
+	}
+
+	key = g_strdup_printf ("%s:%d", directory, depth);
+	item = g_hash_table_lookup (timing->running, key);
+	if (item != NULL)
+	{
+		item->end = g_get_real_time ();
+		build_timing_end_command (timing, directory, item->end);
+		g_hash_table_remove (timing->running, key);
+	}
+	g_free (key);
+}
+
+/* Record the start of a command writing a file. directory is the current
+ * directory of make. */
+gboolean
+build_timing_add_command (BuildTiming *timing, const gchar *directory, const gchar *line)
+{
+	gchar **argv;
+	const gchar *output;
+	gboolean found = FALSE;
+
+	/* Fast check before splitting the line, skip commands echoed by libtool */
+	if ((directory == NULL) || (strstr (line, " -o ") == NULL)) return FALSE;
+	while (g_ascii_isspace (*line)) line++;
+	if (g_str_has_prefix (line, "libtool:")) return FALSE;
+
+	if (!g_shell_parse_argv (line, NULL, &argv, NULL)) return FALSE;
+
+	output = build_timing_get_output (argv);
+	if (output != NULL)
+	{
+		BuildTimingItem *item;
+		gchar *path;
+
+		path = g_path_is_absolute (output) ? g_strdup (output) : g_build_filename (directory, output, NULL);
+		item = build_timing_item_new (timing, path, FALSE);
+		build_timing_end_command (timing, directory, item->start);
+		g_hash_table_insert (timing->commands, g_strdup (directory), item);
+		g_free (path);
+		found = TRUE;
+	}
+	g_strfreev (argv);
+
+	return found;
+}
+
+/* Compute the end of all commands when the build is done */
+void
+build_timing_finish (BuildTiming *timing)
+{
+	guint i;
+
+	timing->end = g_get_real_time ();
+	for (i = 0; i < timing->items->len; i++)
+	{
+		BuildTimingItem *item = g_ptr_array_index (timing->items, i);
+
+		if (item->directory)
+		{
+			/* Directory not left, the build has been interrupted */
+			if (item->end == 0) item->end = timing->end;
+		}
+		else
+		{
+			item->end = build_timing_get_mtime (item->name);
+
+			/* File not written by this command or modification time not
+			 * precise enough, use the start of the next command */
+			if (item->end < item->start)
+				item->end = item->next != 0 ? item->next : item->start;
+		}
+	}
+	g_hash_table_remove_all (timing->depths);
+	g_hash_table_remove_all (timing->running);
+	g_hash_table_remove_all (timing->commands);
+}
+
+/* Display all timed items in a window, sorted by decreasing time */
+void
+build_timing_show_report (BuildTiming *timing, GtkWindow *parent)
+{
+	GtkListStore *store;
+	GtkWidget *view;
+	GtkWidget *scrolled;
+	gchar *title;
+	guint i;
+
+	store = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_DOUBLE);
+	for (i = 0; i < timing->items->len; i++)
+	{
+		BuildTimingItem *item = g_ptr_array_index (timing->items, i);
+		const gchar *name;
+		GtkTreeIter iter;
+
+		if (item->end == 0) continue;
+
+		/* Display names relative to the build directory */
+		name = item->name;
+		if (g_str_has_prefix (name, timing->directory) && (name[strlen (timing->directory)] == G_DIR_SEPARATOR))
+		{
+			name += strlen (timing->directory) + 1;
+		}
+
+		gtk_list_store_append (store, &iter);
+		gtk_list_store_set (store, &iter,
+		                    COLUMN_NAME, name,
+		                    COLUMN_KIND, item->directory ? _("Directory") : _("File"),
+		                    COLUMN_TIME, (item->end - item->start) / (gdouble)G_USEC_PER_SEC,
+		                    -1);
+	}
+	gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), COLUMN_TIME, GTK_SORT_DESCENDING);
+
+	view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+	g_object_unref (store);
+	build_timing_add_column (GTK_TREE_VIEW (view), _("Name"), COLUMN_NAME);
+	build_timing_add_column (GTK_TREE_VIEW (view), _("Type"), COLUMN_KIND);
+	build_timing_add_column (GTK_TREE_VIEW (view), _("Time"), COLUMN_TIME);
+
+	scrolled = gtk_scrolled_window_new (NULL, NULL);
+	gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (scrolled), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+	gtk_scrolled_window_set_shadow_type (GTK_SCROLLED_WINDOW (scrolled), GTK_SHADOW_IN);
+	gtk_container_add (GTK_CONTAINER (scrolled), view);
+
+	if (report_window != NULL) gtk_widget_destroy (report_window);
+	report_window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+	g_object_add_weak_pointer (G_OBJECT (report_window), (gpointer *)&report_window);
+	gtk_window_set_transient_for (GTK_WINDOW (report_window), parent);
+	gtk_window_set_default_size (GTK_WINDOW (report_window), 600, 400);
+	gtk_container_set_border_width (GTK_CONTAINER (report_window), 6);
+	title = g_strdup_printf (_("Build Timing (%.1f s)"), (timing->end - timing->start) / (gdouble)G_USEC_PER_SEC);
+	gtk_window_set_title (GTK_WINDOW (report_window), title);
+	g_free (title);
+	gtk_container_add (GTK_CONTAINER (report_window), scrolled);
+	gtk_widget_show_all (report_window);
+}
+
+/* Constructor & Destructor
+ *---------------------------------------------------------------------------*/
+
+BuildTiming*
+build_timing_new (const gchar *directory)
+{
+	BuildTiming *timing;
+
+	timing = g_new0 (BuildTiming, 1);
+	timing->directory = g_strdup (directory);
+	timing->items = g_ptr_array_new_with_free_func ((GDestroyNotify)build_timing_item_free);
+	timing->depths = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	timing->running = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	timing->commands = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	timing->start = g_get_real_time ();
+
+	return timing;
+}
+
+void
+build_timing_free (BuildTiming *timing)
+{
+	g_hash_table_destroy (timing->depths);
+	g_hash_table_destroy (timing->running);
+	g_hash_table_destroy (timing->commands);
+	g_ptr_array_free (timing->items, TRUE);
+	g_free (timing->directory);
+	g_free (timing);
+}
@@ -0,0 +1,37 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+    build-timing.h
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef BUILD_TIMING_H
+#define BUILD_TIMING_H
+
+#include <gtk/gtk.h>
+
+typedef struct _BuildTiming BuildTiming;
+
+BuildTiming* build_timing_new (const gchar *directory);
+void build_timing_free (BuildTiming *timing);
+
+void build_timing_enter_directory (BuildTiming *timing, const gchar *directory);
+void build_timing_leave_directory (BuildTiming *timing, const gchar *directory);
+gboolean build_timing_add_command (BuildTiming *timing, const gchar *directory, const gchar *line);
+void build_timing_finish (BuildTiming *timing);
+
+void build_timing_show_report (BuildTiming *timing, GtkWindow *parent);
+
+#endif /* BUILD_TIMING_H */
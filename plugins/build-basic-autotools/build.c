@@ -32,6 +32,7 @@
 
 #include "program.h"
 #include "build-options.h"
+#include "build-diagnostics.h"
 
 /* Types
  *---------------------------------------------------------------------------*/
@@ -50,6 +51,7 @@ typedef struct
 
 #define PREF_INSTALL_ROOT "install-root"
 #define PREF_INSTALL_ROOT_COMMAND "install-root-command"
+#define PREF_JSON_DIAGNOSTICS "json-diagnostics"
 
 #define DEFAULT_COMMAND_COMPILE "make"
 #define DEFAULT_COMMAND_BUILD "make"
@@ -830,6 +832,88 @@ build_tarball (BasicAutotoolsPlugin *plugin)
 	return context;
 }
 
+/* Get the compiler commands of the current build directory, they are kept
+ * in the user cache directory in a file named from the build directory */
+BuildCommandDb*
+build_get_compile_commands (BasicAutotoolsPlugin *plugin)
+{
+	gchar *dir;
+
+	if (plugin->project_build_dir == NULL) return NULL;
+	dir = g_file_get_path (plugin->project_build_dir);
+	if (dir == NULL) return NULL;
+
+	if ((plugin->compile_commands != NULL) &&
+	    (strcmp (build_command_db_get_build_dir (plugin->compile_commands), dir) != 0))
+	{
+		/* Build directory has changed */
+		build_command_db_save (plugin->compile_commands);
+		build_command_db_free (plugin->compile_commands);
+		plugin->compile_commands = NULL;
+	}
+	if (plugin->compile_commands == NULL)
+	{
+		gchar *checksum;
+		gchar *name;
+		gchar *filename;
+
+		checksum = g_compute_checksum_for_string (G_CHECKSUM_MD5, dir, -1);
+		name = g_strconcat (checksum, ".json", NULL);
+		filename = anjuta_util_get_user_cache_file_path (COMPILE_COMMANDS_DIR, name, NULL);
+		g_free (name);
+		g_free (checksum);
+		if (filename != NULL)
+		{
+			plugin->compile_commands = build_command_db_new (dir, filename);
+			build_command_db_load (plugin->compile_commands);
+			g_free (filename);
+		}
+	}
+	g_free (dir);
+
+	return plugin->compile_commands;
+}
+
+/* Run the compiler directly if the command used in a previous build is
+ * known and still valid */
+static BuildContext*
+build_compile_file_with_command (BasicAutotoolsPlugin *plugin, GFile *file)
+{
+	BuildContext *context = NULL;
+	BuildCommandDb *db;
+	gchar *filename;
+	gchar *dir;
+	gchar *command;
+
+	/* Keep user defined command */
+	if (plugin->commands[IANJUTA_BUILDABLE_COMMAND_COMPILE] != NULL) return NULL;
+
+	db = build_get_compile_commands (plugin);
+	if (db == NULL) return NULL;
+
+	filename = g_file_get_path (file);
+	if ((filename != NULL) && build_command_db_lookup (db, filename, &dir, &command))
+	{
+		BuildProgram *prog;
+		BuildConfiguration *config;
+		GFile *build_dir;
+
+		config = build_configuration_list_get_selected (plugin->configurations);
+
+		build_dir = g_file_new_for_path (dir);
+		prog = build_program_new_with_command (build_dir, "%s", command);
+		g_object_unref (build_dir);
+		build_program_add_env_list (prog, build_configuration_get_variables (config));
+
+		context = build_save_and_execute_command (plugin, prog, TRUE, NULL);
+		g_free (dir);
+		g_free (command);
+	}
+	g_free (filename);
+
+	return context;
+}
+
 BuildContext*
 build_compile_file (BasicAutotoolsPlugin *plugin, GFile *file)
 {
@@ -840,6 +924,9 @@ build_compile_file (BasicAutotoolsPlugin *plugin, GFile *file)
 
 	g_return_val_if_fail (file != NULL, FALSE);
 
+	context = build_compile_file_with_command (plugin, file);
+	if (context != NULL) return context;
+
 	object = build_object_from_file (plugin, file);
 	if (object != NULL)
 	{
@@ -935,10 +1022,17 @@ build_configure_dir (BasicAutotoolsPlugin *plugin, GFile *dir, const gchar *args
 	BuildConfigureAndBuild *pack = g_new0 (BuildConfigureAndBuild, 1);
 	gchar *quote;
 	gchar *root_path;
+	gchar *json_args = NULL;
 
 	config = build_configuration_list_get_selected (plugin->configurations);
 	vars = build_configuration_get_variables (config);
 
+	/* Get compiler diagnostics in JSON for the whole build */
+	if (g_settings_get_boolean (plugin->settings, PREF_JSON_DIAGNOSTICS))
+	{
+		args = json_args = build_diagnostics_add_flags (args, vars);
+	}
+
 	root_path = g_file_get_path (plugin->project_root_dir);
 	quote = shell_quotef ("%s%s%s",
 		       	root_path,
@@ -951,6 +1045,7 @@ build_configure_dir (BasicAutotoolsPlugin *plugin, GFile *dir, const gchar *args
 										   args);
 	g_free (quote);
 	g_free (root_path);
+	g_free (json_args);
 
 	pack->args = NULL;
 	pack->func = func;
@@ -75,6 +75,8 @@ BuildContext* build_tarball (BasicAutotoolsPlugin *plugin);
 BuildContext* build_compile_file (BasicAutotoolsPlugin *plugin,
                                   GFile *file);
 
+BuildCommandDb* build_get_compile_commands (BasicAutotoolsPlugin *plugin);
+
 BuildContext* build_configure_dir (BasicAutotoolsPlugin *plugin,
                                    GFile *dir,
                                    const gchar *args,
@@ -21,6 +21,7 @@
 #include <config.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <glib/gstdio.h>
 #include <gio/gio.h>
@@ -49,6 +50,9 @@
 #include "executer.h"
 #include "program.h"
 #include "build.h"
+#include "build-classifier.h"
+#include "build-diagnostics.h"
+#include "build-timing.h"
 
 #include <sys/wait.h>
 #if defined(__FreeBSD__)
@@ -65,6 +69,8 @@
 #define PREF_INDICATORS_AUTOMATIC "indicators-automatic"
 #define PREF_PARALLEL_MAKE "parallel-make"
 #define PREF_PARALLEL_MAKE_JOB "parallel-make-job"
+#define PREF_PARALLEL_MAKE_AUTO "parallel-make-auto"
+#define PREF_BUILD_TIMING "build-timing"
 #define PREF_TRANSLATE_MESSAGE "translate-message"
 #define PREF_CONTINUE_ON_ERROR "continue-error"
 
@@ -74,29 +80,20 @@
 #define INSTALL_ROOT_ENTRY "preferences:install-root-command"
 #define PARALLEL_MAKE_CHECK "preferences:parallel-make"
 #define PARALLEL_MAKE_SPIN "preferences:parallel-make-job"
+#define PARALLEL_MAKE_AUTO_CHECK "preferences:parallel-make-auto"
 
-static gpointer parent_class;
-
-typedef struct
-{
-	gchar *pattern;
-	int options;
-	gchar *replace;
-	GRegex *regex;
-} BuildPattern;
+/* Maximum size of the build output read and not displayed yet */
+#define BUILD_OUTPUT_HIGH_WATER_MARK (256 * 1024)
 
-typedef struct
-{
-	gchar *pattern;
-	GRegex *regex;
-	GRegex *local_regex;
-} MessagePattern;
+static gpointer parent_class;
 
 typedef struct
 {
 	GFile *file;
 	gchar *tooltip;
 	gint line;
+	gint column;		/* First and last column or 0 for the whole line */
+	gint end_column;
 	IAnjutaIndicableIndicator indicator;
 } BuildIndicatorLocation;
 
@@ -124,30 +121,19 @@ struct _BuildContext
 
 	/* Saved files */
 	gint file_saved;
+
+	/* Time taken by directories and commands or NULL */
+	BuildTiming *timing;
+
+	/* Output read by the launcher and not displayed yet */
+	gsize output_pending;
+	gboolean message_added;
 };
 
 /* Declarations */
 static void update_project_ui (BasicAutotoolsPlugin *bb_plugin);
 
-static GList *patterns_list = NULL;
-
-/* The translations should match that of 'make' program. Both strings uses
- * pearl regular expression
- * 2 similar strings are used in order to parse the output of 2 different
- * version of make if necessary. If you update one string, move the first
- * string into the second slot and then replace the first string only. */
-static MessagePattern patterns_make_entering[] = {{N_("make(\\[\\d+\\])?:\\s+Entering\\s+directory\\s+`(.+)'"), NULL, NULL},
-												{N_("make(\\[\\d+\\])?:\\s+Entering\\s+directory\\s+'(.+)'"), NULL, NULL},
-												{NULL, NULL, NULL}};
-
-/* The translations should match that of 'make' program. Both strings uses
- * pearl regular expression
- * 2 similar strings are used in order to parse the output of 2 different
- * version of make if necessary. If you update one string, move the first
- * string into the second slot and then replace the first string only. */
-static MessagePattern patterns_make_leaving[] = {{N_("make(\\[\\d+\\])?:\\s+Leaving\\s+directory\\s+`(.+)'"), NULL, NULL},
-												{N_("make(\\[\\d+\\])?:\\s+Leaving\\s+directory\\s+'(.+)'"), NULL, NULL},
-												{NULL, NULL, NULL}};
+static BuildClassifier *classifier = NULL;
 
 /* Helper functions
  *---------------------------------------------------------------------------*/
@@ -223,6 +209,18 @@ build_indicator_location_set (BuildIndicatorLocation *loc,
 
 		line_end = ianjuta_editor_get_line_end_position (editor,
 														 loc->line, NULL);
+		if ((loc->column > 0) && (loc->end_column >= loc->column))
+		{
+			/* Restrict indicator to the exact range when it is known */
+			gint begin = ianjuta_iterable_get_position (line_start, NULL);
+			gint end = ianjuta_iterable_get_position (line_end, NULL);
+
+			if (begin + loc->end_column <= end)
+			{
+				ianjuta_iterable_set_position (line_start, begin + loc->column - 1, NULL);
+				ianjuta_iterable_set_position (line_end, begin + loc->end_column, NULL);
+			}
+		}
 		ianjuta_indicable_set (IANJUTA_INDICABLE (editor),
 							   line_start, line_end, loc->indicator,
 							   NULL);
@@ -352,6 +350,12 @@ build_context_destroy_command (BuildContext *context)
 		context->program = NULL;
 	}
 
+	if (context->timing)
+	{
+		build_timing_free (context->timing);
+		context->timing = NULL;
+	}
+
 	if (context->launcher)
 	{
 		g_object_unref (context->launcher);
@@ -449,186 +453,16 @@ build_context_reset (BuildContext *context)
 	context->locations = NULL;
 }
 
-static void
-build_regex_load ()
-{
-	FILE *fp;
-
-	if (patterns_list)
-		return;
-
-	fp = fopen (PACKAGE_DATA_DIR "/build/automake-c.filters", "r");
-	if (fp == NULL)
-	{
-		DEBUG_PRINT ("Failed to load filters: %s",
-				   PACKAGE_DATA_DIR "/build/automake-c.filters");
-		return;
-	}
-	while (!feof (fp) && !ferror (fp))
-	{
-		char buffer[1024];
-		gchar **tokens;
-		BuildPattern *pattern;
-
-		if (!fgets (buffer, 1024, fp))
-			break;
-		tokens = g_strsplit (buffer, "|||", 3);
-
-		if (!tokens[0] || !tokens[1])
-		{
-			DEBUG_PRINT ("Cannot parse regex: %s", buffer);
-			g_strfreev (tokens);
-			continue;
-		}
-		pattern = g_new0 (BuildPattern, 1);
-		pattern->pattern = g_strdup (tokens[0]);
-		pattern->replace = g_strdup (tokens[1]);
-		if (tokens[2])
-			pattern->options = atoi (tokens[2]);
-		g_strfreev (tokens);
-
-		patterns_list = g_list_prepend (patterns_list, pattern);
-	}
-	fclose (fp);
-	patterns_list = g_list_reverse (patterns_list);
-}
-
-static void
-build_regex_init_message (MessagePattern *patterns)
-{
-	g_return_if_fail (patterns != NULL);
-
-	if (patterns->regex != NULL)
-		return;		/* Already done */
-
-	for (;patterns->pattern != NULL; patterns++)
-	{
-		/* Untranslated string */
-		patterns->regex = g_regex_new(
-			   patterns->pattern,
-			   0,
-			   0,
-			   NULL);
-
-		/* Translated string */
-		patterns->local_regex = g_regex_new(
-			   _(patterns->pattern),
-			   0,
-			   0,
-			   NULL);
-	}
-}
-
 static void
 build_regex_init ()
 {
-	GList *node;
-	GError *error = NULL;
-
-	build_regex_init_message (patterns_make_entering);
-
-	build_regex_init_message (patterns_make_leaving);
-
-	build_regex_load ();
-	if (!patterns_list)
-		return;
-
-	if (((BuildPattern*)(patterns_list->data))->regex)
-		return;
-
-	node = patterns_list;
-	while (node)
-	{
-		BuildPattern *pattern;
-
-		pattern = node->data;
-		pattern->regex =
-			g_regex_new(
-			   pattern->pattern,
-			   pattern->options,
-			   0,
-			   &error);           /* for error message */
-		if (error != NULL) {
-			DEBUG_PRINT ("GRegex compilation failed: pattern \"%s\": error %s",
-						pattern->pattern, error->message);
-			g_error_free (error);
-		}
-		node = g_list_next (node);
-	}
-}
-
-/* Regex processing */
-static gchar*
-build_get_summary (const gchar *details, BuildPattern* bp)
-{
-	gboolean matched;
-	GMatchInfo *match_info;
-	const gchar *iter;
-	GString *ret;
-	gchar *final = NULL;
-
-	if (!bp || !bp->regex)
-		return NULL;
-
-	matched = g_regex_match(
-			  bp->regex,       /* result of g_regex_new() */
-			  details,         /* the subject string */
-			  0,
-			  &match_info);
-
-	if (matched)
-	{
-		ret = g_string_new ("");
-		iter = bp->replace;
-		while (*iter != '\0')
-		{
-			if (*iter == '\\' && isdigit(*(iter + 1)))
-			{
-				char temp[2] = {0, 0};
-				gint start_pos, end_pos;
-
-				temp[0] = *(iter + 1);
-				int idx = atoi (temp);
-
-				g_match_info_fetch_pos (match_info, idx, &start_pos, &end_pos);
-
-				ret = g_string_append_len (ret, details + start_pos,
-									   end_pos - start_pos);
-				iter += 2;
-			}
-			else
-			{
-				const gchar *start;
-				const gchar *end;
-
-				start = iter;
-				iter = g_utf8_next_char (iter);
-				end = iter;
-
-				ret = g_string_append_len (ret, start, end - start);
-			}
-		}
-
-		final = g_string_free (ret, FALSE);
-		if (strlen (final) <= 0) {
-			g_free (final);
-			final = NULL;
-		}
-	}
-	g_match_info_free (match_info);
-
-	return final;
-}
+	if (classifier != NULL)
+		return;		/* Already done */
 
-static void
-on_build_mesg_arrived (AnjutaLauncher *launcher,
-					   AnjutaLauncherOutputType output_type,
-					   const gchar * mesg, gpointer user_data)
-{
-	BuildContext *context = (BuildContext*)user_data;
-	/* Message view could have been destroyed */
-	if (context->message_view)
-		ianjuta_message_view_buffer_append (context->message_view, mesg, NULL);
+	/* All patterns are compiled together with a literal prefilter */
+	classifier = build_classifier_new ();
+	build_classifier_load_filters (classifier,
+								   PACKAGE_DATA_DIR "/build/automake-c.filters");
 }
 
 static gboolean
@@ -702,6 +536,97 @@ parse_error_line (const gchar * line, gchar ** filename, int *lineno)
 	return FALSE;
 }
 
+/* Display diagnostics written by gcc in JSON */
+static void
+build_append_diagnostics (IAnjutaMessageView *view, GList *diagnostics,
+						  BuildContext *context)
+{
+	BasicAutotoolsPlugin *p = ANJUTA_PLUGIN_BASIC_AUTOTOOLS (context->plugin);
+	GList *item;
+
+	for (item = diagnostics; item != NULL; item = g_list_next (item))
+	{
+		BuildDiagnostic *diagnostic = (BuildDiagnostic *)item->data;
+		IAnjutaMessageViewType type;
+		IAnjutaIndicableIndicator indicator;
+		gchar *filename = NULL;
+		gchar *details;
+		gchar *summary;
+
+		if (strcmp (diagnostic->kind, "warning") == 0)
+		{
+			type = IANJUTA_MESSAGE_VIEW_TYPE_WARNING;
+			indicator = IANJUTA_INDICABLE_WARNING;
+		}
+		else if ((strcmp (diagnostic->kind, "error") == 0) ||
+				 (strcmp (diagnostic->kind, "fatal error") == 0))
+		{
+			type = IANJUTA_MESSAGE_VIEW_TYPE_ERROR;
+			indicator = IANJUTA_INDICABLE_CRITICAL;
+		}
+		else
+		{
+			type = IANJUTA_MESSAGE_VIEW_TYPE_NORMAL;
+			indicator = IANJUTA_INDICABLE_IMPORTANT;
+		}
+
+		if (diagnostic->filename != NULL)
+		{
+			if (g_path_is_absolute (diagnostic->filename))
+			{
+				filename = g_strdup (diagnostic->filename);
+			}
+			else
+			{
+				filename = g_build_filename (build_context_get_dir (context, "default"),
+											 diagnostic->filename, NULL);
+			}
+		}
+
+		/* Details are kept in gcc text format, so messages can be parsed
+		 * when clicked */
+		details = build_diagnostic_to_string (diagnostic, filename);
+		summary = build_classifier_get_summary (classifier, details);
+		ianjuta_message_view_append (view, type,
+									 summary != NULL ? summary : details,
+									 summary != NULL ? details : "", NULL);
+		g_free (summary);
+
+		if ((filename != NULL) && (diagnostic->line > 0) && !diagnostic->child)
+		{
+			BuildIndicatorLocation *loc;
+
+			loc = build_indicator_location_new (filename, diagnostic->line,
+												indicator, diagnostic->message);
+			loc->column = diagnostic->column;
+			loc->end_column = diagnostic->end_column;
+			context->locations = g_slist_prepend (context->locations, loc);
+
+			if (g_settings_get_boolean (p->settings, PREF_INDICATORS_AUTOMATIC))
+			{
+				build_indicator_location_set (loc, p->current_editor,
+											  p->current_editor_file);
+			}
+		}
+
+		if (diagnostic->fixits != NULL)
+		{
+			gchar **fixit;
+
+			for (fixit = diagnostic->fixits; *fixit != NULL; fixit++)
+			{
+				gchar *text = g_strconcat (filename != NULL ? filename : "", ":", *fixit, NULL);
+
+				ianjuta_message_view_append (view, IANJUTA_MESSAGE_VIEW_TYPE_INFO,
+											 *fixit, text, NULL);
+				g_free (text);
+			}
+		}
+		g_free (details);
+		g_free (filename);
+	}
+}
+
 static void
 on_build_mesg_format (IAnjutaMessageView *view, const gchar *one_line,
 					  BuildContext *context)
@@ -709,86 +634,70 @@ on_build_mesg_format (IAnjutaMessageView *view, const gchar *one_line,
 	gchar *dummy_fn, *line;
 	gint dummy_int;
 	IAnjutaMessageViewType type;
-	GList *node;
 	gchar *summary = NULL;
 	gchar *freeptr = NULL;
 	BasicAutotoolsPlugin *p = ANJUTA_PLUGIN_BASIC_AUTOTOOLS (context->plugin);
-	gboolean matched;
-	GMatchInfo *match_info;
-	MessagePattern *pat;
+	BuildDirectoryChange change;
+	gchar *dir;
+	GList *diagnostics;
 
 	g_return_if_fail (one_line != NULL);
 
-	/* Check if make enter a new directory */
-	matched = FALSE;
-	for (pat = patterns_make_entering; pat->pattern != NULL; pat++)
-	{
-		matched = g_regex_match(
-						pat->regex,
-				  		one_line,
-			  			0,
-			  			&match_info);
-		if (matched) break;
-		g_match_info_free (match_info);
-		matched = g_regex_match(
-						pat->local_regex,
-				  		one_line,
-			  			0,
-			  			&match_info);
-		if (matched) break;
-		g_match_info_free (match_info);
-	}
-	if (matched)
-	{
-		gchar *dir;
-		gchar *summary;
+	/* Check if gcc has written diagnostics in JSON */
+	if (build_diagnostics_parse (one_line, &diagnostics))
+	{
+		if (diagnostics != NULL) context->message_added = TRUE;
+		build_append_diagnostics (view, diagnostics, context);
+		g_list_foreach (diagnostics, (GFunc)build_diagnostic_free, NULL);
+		g_list_free (diagnostics);
+		return;
+	}
 
-		dir = g_match_info_fetch (match_info, 2);
-		dir = context->environment ? ianjuta_environment_get_real_directory(context->environment, dir, NULL)
-								: dir;
-		build_context_push_dir (context, "default", dir);
-		summary = g_strdup_printf(_("Entering: %s"), dir);
-		ianjuta_message_view_append (view, IANJUTA_MESSAGE_VIEW_TYPE_NORMAL,
-									 summary, one_line, NULL);
-		g_free (dir);
-		g_free(summary);
-		g_match_info_free (match_info);
-	}
-
-	/* Check if make leave a directory */
-	matched = FALSE;
-	for (pat = patterns_make_leaving; pat->pattern != NULL; pat++)
-	{
-		matched = g_regex_match(
-						pat->regex,
-				  		one_line,
-			  			0,
-			  			&match_info);
-		if (matched) break;
-		g_match_info_free (match_info);
-		matched = g_regex_match(
-						pat->local_regex,
-				  		one_line,
-			  			0,
-			  			&match_info);
-		if (matched) break;
-		g_match_info_free (match_info);
-	}
-	if (matched)
-	{
-		gchar *dir;
+	/* Check if make enter or leave a directory */
+	change = build_classifier_match_directory (classifier, one_line, &dir);
+	if (change != BUILD_DIRECTORY_NONE)
+	{
+		gchar *real_dir;
 		gchar *summary;
 
-		dir = g_match_info_fetch (match_info, 2);
-		dir = context->environment ? ianjuta_environment_get_real_directory(context->environment, dir, NULL)
+		real_dir = context->environment ? ianjuta_environment_get_real_directory(context->environment, dir, NULL)
 								: dir;
-		build_context_pop_dir (context, "default", dir);
-		summary = g_strdup_printf(_("Leaving: %s"), dir);
+		if (change == BUILD_DIRECTORY_ENTERING)
+		{
+			build_context_push_dir (context, "default", real_dir);
+			if (context->timing != NULL)
+				build_timing_enter_directory (context->timing, real_dir);
+			summary = g_strdup_printf(_("Entering: %s"), real_dir);
+		}
+		else
+		{
+			build_context_pop_dir (context, "default", real_dir);
+			if (context->timing != NULL)
+				build_timing_leave_directory (context->timing, real_dir);
+			summary = g_strdup_printf(_("Leaving: %s"), real_dir);
+		}
 		ianjuta_message_view_append (view, IANJUTA_MESSAGE_VIEW_TYPE_NORMAL,
 									 summary, one_line, NULL);
-		g_free (dir);
+		g_free (real_dir);
 		g_free(summary);
-		g_match_info_free (match_info);
+	}
+
+	/* Record start of commands */
+	if (context->timing != NULL)
+		build_timing_add_command (context->timing, build_context_get_dir (context, "default"), one_line);
+
+	/* Keep compiler commands to compile files without make later */
+	if (strstr (one_line, " -c") != NULL)
+	{
+		BuildCommandDb *db = build_get_compile_commands (p);
+		const gchar *build_dir;
+
+		/* Use the directory of the command if make has not displayed it */
+		build_dir = build_context_get_dir (context, "default");
+		if ((build_dir == NULL) && (context->program != NULL))
+			build_dir = build_context_get_work_dir (context);
+		if (db != NULL)
+			build_command_db_capture (db, build_dir, one_line);
 	}
 
 	/* Save freeptr so that we can free the copied string */
@@ -892,16 +801,8 @@ on_build_mesg_format (IAnjutaMessageView *view, const gchar *one_line,
 		g_free (dummy_fn);
 	}
 
-	node = patterns_list;
-	while (node)
-	{
-		BuildPattern *pattern = node->data;
-		summary = build_get_summary (line, pattern);
-		if (summary)
-			break;
-		node = g_list_next (node);
-	}
-
+	context->message_added = TRUE;
+	summary = build_classifier_get_summary (classifier, line);
 	if (summary)
 	{
 		ianjuta_message_view_append (view, type, summary, line, NULL);
@@ -912,6 +813,58 @@ on_build_mesg_format (IAnjutaMessageView *view, const gchar *one_line,
 	g_free(freeptr);
 }
 
+static void
+build_context_release_output (BuildContext *context)
+{
+	if ((context->launcher != NULL) && (context->output_pending != 0))
+		anjuta_launcher_release_output (context->launcher, context->output_pending);
+	context->output_pending = 0;
+}
+
+static void
+on_build_mesg_arrived (AnjutaLauncher *launcher,
+					   AnjutaLauncherOutputType output_type,
+					   const gchar * const *lines, guint n_lines,
+					   gpointer user_data)
+{
+	BuildContext *context = (BuildContext*)user_data;
+	gsize length = 0;
+	guint i;
+
+	/* Count the output before appending messages, the view can display
+	 * them and release it while they are formatted */
+	for (i = 0; i < n_lines; i++)
+		length += strlen (lines[i]) + 1;
+	context->output_pending += length;
+
+	/* Lines are already split, format them without going through the
+	 * message view buffer */
+	context->message_added = FALSE;
+	for (i = 0; i < n_lines; i++)
+	{
+		/* Message view could have been destroyed */
+		if (context->message_view == NULL) continue;
+		on_build_mesg_format (context->message_view, lines[i], context);
+	}
+
+	/* Read more output only when the messages are displayed */
+	if (context->message_view == NULL)
+	{
+		build_context_release_output (context);
+	}
+	else if (!context->message_added)
+	{
+		context->output_pending -= length;
+		anjuta_launcher_release_output (launcher, length);
+	}
+}
+
+static void
+on_build_mesg_displayed (IAnjutaMessageView *view, BuildContext *context)
+{
+	build_context_release_output (context);
+}
+
 static void
 on_build_mesg_parse (IAnjutaMessageView *view, const gchar *line,
 					 BuildContext *context)
@@ -940,7 +893,18 @@ on_build_terminated (AnjutaLauncher *launcher,
 					 gint child_pid, gint status, gulong time_taken,
 					 BuildContext *context)
 {
+	BasicAutotoolsPlugin *plugin = ANJUTA_PLUGIN_BASIC_AUTOTOOLS (context->plugin);
+
 	context->used = FALSE;
+	if (plugin->compile_commands != NULL)
+		build_command_db_save (plugin->compile_commands);
+	if (context->timing != NULL)
+	{
+		build_timing_finish (context->timing);
+		build_timing_show_report (context->timing, GTK_WINDOW (context->plugin->shell));
+		build_timing_free (context->timing);
+		context->timing = NULL;
+	}
 	if (context->program->callback != NULL)
 	{
 		GError *err = NULL;
@@ -996,6 +960,7 @@ on_build_terminated (AnjutaLauncher *launcher,
 	{
 		IAnjutaMessageManager *mesg_manager;
 		gchar *buff1;
+		gdouble blocked;
 
 		buff1 = g_strdup_printf (_("Total time taken: %lu secs\n"),
 								 time_taken);
@@ -1020,6 +985,16 @@ on_build_terminated (AnjutaLauncher *launcher,
 		ianjuta_message_view_buffer_append (context->message_view, buff1, NULL);
 		g_free (buff1);
 
+		/* The build is slowed down if the output is not displayed fast enough */
+		blocked = anjuta_launcher_get_blocked_time (launcher);
+		if (blocked >= 1.0)
+		{
+			buff1 = g_strdup_printf (_("Time waiting for the message view: %.0f secs\n"),
+									 blocked);
+			ianjuta_message_view_buffer_append (context->message_view, buff1, NULL);
+			g_free (buff1);
+		}
+
 		/* Goto the first error if it exists */
 		/* if (anjuta_preferences_get_int (ANJUTA_PREFERENCES (app->preferences),
 										"build.option.gotofirst"))
@@ -1036,6 +1011,7 @@ on_message_view_destroyed (BuildContext *context, GtkWidget *view)
 {
 	DEBUG_PRINT ("%s", "Destroying build context");
 	context->message_view = NULL;
+	build_context_release_output (context);
 
 	build_context_destroy_view (context);
 }
@@ -1144,6 +1120,8 @@ build_get_context_with_message(BasicAutotoolsPlugin *plugin, const gchar *dir)
 						  G_CALLBACK (on_build_mesg_format), context);
 		g_signal_connect (G_OBJECT (context->message_view), "message_clicked",
 						  G_CALLBACK (on_build_mesg_parse), context);
+		g_signal_connect (G_OBJECT (context->message_view), "messages_displayed",
+						  G_CALLBACK (on_build_mesg_displayed), context);
 		g_object_weak_ref (G_OBJECT (context->message_view),
 						   (GWeakNotify)on_message_view_destroyed, context);
 	}
@@ -1217,6 +1195,28 @@ build_get_context (BasicAutotoolsPlugin *plugin, const gchar *dir,
 	return context;
 }
 
+/* Return a number of jobs for make using the processors which are not
+ * already busy */
+static gint
+build_get_parallel_jobs (gint *cpus)
+{
+	gint jobs;
+	gdouble load;
+
+	*cpus = 1;
+#ifdef _SC_NPROCESSORS_ONLN
+	*cpus = MAX (sysconf (_SC_NPROCESSORS_ONLN), 1);
+#endif
+
+	jobs = *cpus;
+	if (getloadavg (&load, 1) == 1)
+	{
+		jobs = *cpus - (gint)load;
+	}
+
+	return MAX (jobs, 1);
+}
+
 void
 build_set_command_in_context (BuildContext* context, BuildProgram *prog)
 {
@@ -1234,10 +1234,31 @@ build_execute_command_in_context (BuildContext* context, GError **err)
 	{
 		if (g_settings_get_boolean (settings, PREF_PARALLEL_MAKE))
 		{
-			gchar *arg = g_strdup_printf ("-j%d", g_settings_get_int (settings , PREF_PARALLEL_MAKE_JOB));
+			gchar *arg;
+
+			if (g_settings_get_boolean (settings, PREF_PARALLEL_MAKE_AUTO))
+			{
+				gint cpus;
+				gint jobs = build_get_parallel_jobs (&cpus);
+
+				/* Let make reduce the number of jobs if the load increases */
+				arg = g_strdup_printf ("-l%d", cpus);
+				build_program_insert_arg (context->program, 1, arg);
+				g_free (arg);
+				arg = g_strdup_printf ("-j%d", jobs);
+			}
+			else
+			{
+				arg = g_strdup_printf ("-j%d", g_settings_get_int (settings , PREF_PARALLEL_MAKE_JOB));
+			}
 			build_program_insert_arg (context->program, 1, arg);
 			g_free (arg);
 		}
+		if (g_settings_get_boolean (settings, PREF_BUILD_TIMING))
+		{
+			if (context->timing != NULL) build_timing_free (context->timing);
+			context->timing = build_timing_new (context->program->work_dir);
+		}
 		if (g_settings_get_boolean (settings, PREF_CONTINUE_ON_ERROR))
 		{
 			build_program_insert_arg (context->program, 1, "-k");
@@ -1271,7 +1292,9 @@ build_execute_command_in_context (BuildContext* context, GError **err)
 		ianjuta_message_view_buffer_append (context->message_view, "\n", NULL);
 		g_free (command);
 
-		anjuta_launcher_execute_v (context->launcher,
+		context->output_pending = 0;
+		anjuta_launcher_set_high_water_mark (context->launcher, BUILD_OUTPUT_HIGH_WATER_MARK);
+		anjuta_launcher_execute_lines_v (context->launcher,
 		    context->program->work_dir,
 		    context->program->argv,
 		    context->program->envp,
@@ -1279,6 +1302,7 @@ build_execute_command_in_context (BuildContext* context, GError **err)
 	}
 	else
 	{
+		anjuta_launcher_set_high_water_mark (context->launcher, 0);
 		anjuta_launcher_execute_v (context->launcher,
 		    context->program->work_dir,
 		    context->program->argv,
@@ -2591,6 +2615,11 @@ finalize (GObject *obj)
 	if (ba_plugin->project_build_dir != NULL) g_object_unref (ba_plugin->project_build_dir);
 	g_free (ba_plugin->program_args);
 	build_configuration_list_free (ba_plugin->configurations);
+	if (ba_plugin->compile_commands != NULL)
+	{
+		build_command_db_save (ba_plugin->compile_commands);
+		build_command_db_free (ba_plugin->compile_commands);
+	}
 
 	ba_plugin->fm_current_file = NULL;
 	ba_plugin->pm_current_file = NULL;
@@ -2599,6 +2628,7 @@ finalize (GObject *obj)
 	ba_plugin->project_build_dir = NULL;
 	ba_plugin->program_args = NULL;
 	ba_plugin->configurations = NULL;
+	ba_plugin->compile_commands = NULL;
 
 	G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
@@ -2620,6 +2650,7 @@ basic_autotools_plugin_instance_init (GObject *obj)
 	ba_plugin->current_editor = NULL;
 	ba_plugin->contexts_pool = NULL;
 	ba_plugin->configurations = build_configuration_list_new ();
+	ba_plugin->compile_commands = NULL;
 	ba_plugin->program_args = NULL;
 	ba_plugin->run_in_terminal = TRUE;
 	ba_plugin->last_exec_uri = NULL;
@@ -2892,6 +2923,7 @@ ipreferences_merge(IAnjutaPreferences* ipref, AnjutaPreferences* prefs, GError**
 	GtkWidget *make_check;
 	GtkWidget *root_entry;
 	GtkWidget *make_entry;
+	GtkWidget *make_auto_check;
 	GtkBuilder *bxml;
 	BasicAutotoolsPlugin *plugin = ANJUTA_PLUGIN_BASIC_AUTOTOOLS (ipref);
 
@@ -2904,6 +2936,7 @@ ipreferences_merge(IAnjutaPreferences* ipref, AnjutaPreferences* prefs, GError**
 	    INSTALL_ROOT_ENTRY, &root_entry,
 	    PARALLEL_MAKE_CHECK, &make_check,
 	    PARALLEL_MAKE_SPIN, &make_entry,
+	    PARALLEL_MAKE_AUTO_CHECK, &make_auto_check,
 	    NULL);
 
 	g_signal_connect(G_OBJECT(root_check), "toggled", G_CALLBACK(on_root_check_toggled), root_entry);
@@ -2911,6 +2944,8 @@ ipreferences_merge(IAnjutaPreferences* ipref, AnjutaPreferences* prefs, GError**
 
 	g_signal_connect(G_OBJECT(make_check), "toggled", G_CALLBACK(on_root_check_toggled), make_entry);
 	on_root_check_toggled (make_check, make_entry);
+	g_signal_connect(G_OBJECT(make_check), "toggled", G_CALLBACK(on_root_check_toggled), make_auto_check);
+	on_root_check_toggled (make_check, make_auto_check);
 
 	anjuta_preferences_add_from_builder (prefs, bxml, plugin->settings,
 	                                     BUILD_PREFS_ROOT, _("Build Autotools"),  ICON_FILE);
@@ -27,6 +27,7 @@
 
 #include "configuration-list.h"
 #include "program.h"
+#include "build-commands.h"
 
 #define BUILDER_FILE PACKAGE_DATA_DIR "/glade/anjuta-build-basic-autotools-plugin.ui"
 
@@ -73,6 +74,9 @@ struct _BasicAutotoolsPlugin{
 	
 	/* Build parameters */
 	BuildConfigurationList *configurations;
+
+	/* Compiler commands read from the build output */
+	BuildCommandDb *compile_commands;
 	
 	/* Execution parameters */
 	gchar *program_args;
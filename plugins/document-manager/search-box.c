@@ -43,6 +43,11 @@
 #define LINE_ENTRY_WIDTH 7
 #define SEARCH_ENTRY_WIDTH 45
 
+/* Lines around the cursor highlighted at once, the rest of the text is
+ * highlighted in chunks of HIGHLIGHT_CHUNK_SIZE characters when idle */
+#define HIGHLIGHT_VISIBLE_LINES 100
+#define HIGHLIGHT_CHUNK_SIZE 32768
+
 struct _SearchBoxPrivate
 {
 	GtkWidget* grid;
@@ -75,7 +80,28 @@ struct _SearchBoxPrivate
 	gboolean regex_mode;
 	
 	gboolean highlight_complete;
-	
+
+	/* Compiled regular expression and its pattern */
+	GRegex* regex;
+	gchar* regex_pattern;
+
+	/* Editor text, kept until the editor is changed, with the last
+	 * converted character offset and byte index */
+	gchar* text;
+	gint text_length;
+	gint text_n_chars;
+	gint text_offset;
+	gint text_index;
+
+	/* Last pattern not found, longer patterns starting with it are not
+	 * searched */
+	gchar* not_found;
+
+	/* Idle highlight, the region around the cursor is already done */
+	guint highlight_idle;
+	gint highlight_pos;
+	gint highlight_skip_start;
+	gint highlight_skip_end;
 };
 
 #ifdef GET_PRIVATE
@@ -92,10 +118,49 @@ on_search_box_hide (GtkWidget* button, SearchBox* search_box)
 	gtk_widget_hide (GTK_WIDGET (search_box));
 }
 
+static void
+search_box_stop_highlight (SearchBox* search_box)
+{
+	if (search_box->priv->highlight_idle)
+	{
+		g_source_remove (search_box->priv->highlight_idle);
+		search_box->priv->highlight_idle = 0;
+	}
+}
+
+static void
+search_box_clear_text (SearchBox* search_box)
+{
+	g_free (search_box->priv->text);
+	search_box->priv->text = NULL;
+	g_free (search_box->priv->not_found);
+	search_box->priv->not_found = NULL;
+}
+
+static void
+on_editor_changed (IAnjutaEditor* editor, IAnjutaIterable* position,
+                   gboolean added, gint length, gint lines,
+                   const gchar* text, SearchBox* search_box)
+{
+	if (editor != search_box->priv->current_editor)
+		return;
+
+	search_box_clear_text (search_box);
+	if (search_box->priv->highlight_idle)
+	{
+		/* Restart highlighting on next search */
+		search_box_stop_highlight (search_box);
+		search_box->priv->highlight_complete = FALSE;
+	}
+}
+
 static void
 on_document_changed (AnjutaDocman* docman, IAnjutaDocument* doc,
 					SearchBox* search_box)
 {
+	search_box_stop_highlight (search_box);
+	search_box_clear_text (search_box);
+
 	if (!doc || !IANJUTA_IS_EDITOR (doc))
 	{
 		gtk_widget_hide (GTK_WIDGET (search_box));
@@ -104,6 +169,13 @@ on_document_changed (AnjutaDocman* docman, IAnjutaDocument* doc,
 	else
 	{
 		search_box->priv->current_editor = IANJUTA_EDITOR (doc);
+		if (g_object_get_data (G_OBJECT (doc), "search-box") == NULL)
+		{
+			g_object_set_data (G_OBJECT (doc), "search-box", search_box);
+			g_signal_connect_object (doc, "changed",
+			                         G_CALLBACK (on_editor_changed),
+			                         search_box, 0);
+		}
 	}
 }
 
@@ -237,49 +309,157 @@ on_search_focus_out (GtkWidget* widget, GdkEvent* event, SearchBox* search_box)
 
 
 
-static gboolean
-incremental_regex_search (const gchar* search_entry, const gchar* editor_text, gint * start_pos, gint * end_pos, gboolean search_forward)
+static GRegex*
+search_box_get_regex (SearchBox* search_box)
 {
-	GRegex * regex;
-	GMatchInfo *match_info;
-	gboolean result;
-	GError * err = NULL;
+	const gchar* search_text = gtk_entry_get_text (GTK_ENTRY (search_box->priv->search_entry));
 
-	regex = g_regex_new (search_entry, 0, 0, &err);
-	if (err)
+	/* Compile the pattern only when it has changed */
+	if (g_strcmp0 (search_box->priv->regex_pattern, search_text) != 0)
 	{
-		g_message ("%s",err->message);
-		g_error_free (err);
-		g_regex_unref(regex);
-		return FALSE;
+		GError* err = NULL;
+
+		if (search_box->priv->regex)
+			g_regex_unref (search_box->priv->regex);
+		g_free (search_box->priv->regex_pattern);
+		search_box->priv->regex_pattern = g_strdup (search_text);
+		search_box->priv->regex = g_regex_new (search_text, 0, 0, &err);
+		if (err)
+		{
+			g_message ("%s",err->message);
+			g_error_free (err);
+		}
 	}
 
-	result = g_regex_match (regex, editor_text, 0, &match_info);
+	return search_box->priv->regex;
+}
+
+static void
+search_box_clear_regex (SearchBox* search_box)
+{
+	if (search_box->priv->regex)
+		g_regex_unref (search_box->priv->regex);
+	search_box->priv->regex = NULL;
+	g_free (search_box->priv->regex_pattern);
+	search_box->priv->regex_pattern = NULL;
+}
+
+static const gchar*
+search_box_get_text (SearchBox* search_box)
+{
+	if (search_box->priv->text == NULL)
+	{
+		search_box->priv->text = ianjuta_editor_get_text_all (search_box->priv->current_editor, NULL);
+		if (search_box->priv->text == NULL)
+			search_box->priv->text = g_strdup ("");
+		search_box->priv->text_length = strlen (search_box->priv->text);
+		search_box->priv->text_n_chars = g_utf8_strlen (search_box->priv->text,
+		                                                search_box->priv->text_length);
+		search_box->priv->text_offset = 0;
+		search_box->priv->text_index = 0;
+	}
+
+	return search_box->priv->text;
+}
+
+/* Convert between character offsets and byte indexes in the editor text,
+ * starting from the last converted position as searches are close */
+static gint
+search_box_offset_to_index (SearchBox* search_box, gint offset)
+{
+	const gchar* pos;
+
+	if ((offset < 0) || (offset > search_box->priv->text_n_chars))
+		offset = search_box->priv->text_n_chars;
+
+	pos = g_utf8_offset_to_pointer (search_box->priv->text + search_box->priv->text_index,
+	                                offset - search_box->priv->text_offset);
+	search_box->priv->text_offset = offset;
+	search_box->priv->text_index = pos - search_box->priv->text;
+
+	return search_box->priv->text_index;
+}
 
-	if (result)
+static gint
+search_box_index_to_offset (SearchBox* search_box, gint index)
+{
+	search_box->priv->text_offset +=
+		g_utf8_pointer_to_offset (search_box->priv->text + search_box->priv->text_index,
+		                          search_box->priv->text + index);
+	search_box->priv->text_index = index;
+
+	return search_box->priv->text_offset;
+}
+
+/* Search regex in text between the byte indexes start_index and end_index */
+static gboolean
+incremental_regex_search (GRegex* regex, const gchar* text, gint length,
+                          gint start_index, gint end_index,
+                          gint* start_pos, gint* end_pos,
+                          gboolean search_forward)
+{
+	GMatchInfo *match_info;
+	gboolean found = FALSE;
+
+	g_regex_match_full (regex, text, length, start_index, 0, &match_info, NULL);
+	while (g_match_info_matches (match_info))
 	{
+		gint match_start, match_end;
+
+		g_match_info_fetch_pos (match_info, 0, &match_start, &match_end);
+		if (match_end > end_index)
+			break;
+
+		*start_pos = match_start;
+		*end_pos = match_end;
+		found = TRUE;
 		if (search_forward)
-			g_match_info_fetch_pos(match_info, 0, start_pos, end_pos);
-		else
-		{
-			do
-			{
-				g_match_info_fetch_pos(match_info, 0, start_pos, end_pos);
-			}
-			while (g_match_info_next(match_info, NULL));
-		}
+			break;
 
-		*start_pos = g_utf8_pointer_to_offset(editor_text, &editor_text[*start_pos]);
-		*end_pos = g_utf8_pointer_to_offset(editor_text, &editor_text[*end_pos]);
+		g_match_info_next (match_info, NULL);
 	}
+	g_match_info_free (match_info);
 
-	if (regex)
-		g_regex_unref(regex);
-	if (match_info)
-		g_match_info_free (match_info);
+	return found;
+}
 
-	return result;
+static gboolean
+search_box_regex_search (SearchBox* search_box,
+                         IAnjutaEditorCell* search_start,
+                         IAnjutaEditorCell* search_end,
+                         gboolean search_forward,
+                         IAnjutaEditorCell** result_start,
+                         IAnjutaEditorCell** result_end)
+{
+	GRegex* regex = search_box_get_regex (search_box);
+	const gchar* text;
+	gint start_index, end_index;
+	gint start_pos, end_pos;
+
+	if (regex == NULL)
+		return FALSE;
 
+	text = search_box_get_text (search_box);
+	start_index = search_box_offset_to_index (search_box,
+	                                          ianjuta_iterable_get_position (IANJUTA_ITERABLE (search_start), NULL));
+	end_index = search_box_offset_to_index (search_box,
+	                                        ianjuta_iterable_get_position (IANJUTA_ITERABLE (search_end), NULL));
+
+	if (!incremental_regex_search (regex, text, search_box->priv->text_length,
+	                               start_index, end_index,
+	                               &start_pos, &end_pos, search_forward))
+		return FALSE;
+
+	*result_start = IANJUTA_EDITOR_CELL (ianjuta_editor_get_start_position (search_box->priv->current_editor,
+	                                                                        NULL));
+	*result_end = IANJUTA_EDITOR_CELL (ianjuta_editor_get_start_position (search_box->priv->current_editor,
+	                                                                      NULL));
+	ianjuta_iterable_set_position (IANJUTA_ITERABLE (*result_start),
+	                               search_box_index_to_offset (search_box, start_pos), NULL);
+	ianjuta_iterable_set_position (IANJUTA_ITERABLE (*result_end),
+	                               search_box_index_to_offset (search_box, end_pos), NULL);
+
+	return TRUE;
 }
 
 gboolean
@@ -354,9 +534,16 @@ search_box_incremental_search (SearchBox* search_box, gboolean search_forward,
 
 		if (search_box->priv->regex_mode)
 		{
+			GRegex* regex = search_box_get_regex (search_box);
+			gint length = strlen (selected_text);
+
 			/* Always look for first match */
-			if (incremental_regex_search (search_text, selected_text, &start_pos, &end_pos, TRUE))
+			if ((regex != NULL) &&
+			    incremental_regex_search (regex, selected_text, length, 0, length,
+			                              &start_pos, &end_pos, TRUE))
 			{
+				start_pos = g_utf8_pointer_to_offset (selected_text, selected_text + start_pos);
+				end_pos = g_utf8_pointer_to_offset (selected_text, selected_text + end_pos);
 				selected_have_search_text = TRUE;
 			}
 		}
@@ -412,45 +599,14 @@ search_box_incremental_search (SearchBox* search_box, gboolean search_forward,
 
 	gboolean result_set = FALSE;
 
-	gint start_pos, end_pos;
-	gchar * text_to_search;
-	gboolean result;
-
 	if (!found)
 	{
 		/* Try searching in current position */
 		if (search_box->priv->regex_mode)
 		{
-			text_to_search = ianjuta_editor_get_text (search_box->priv->current_editor,
-				                                      IANJUTA_ITERABLE (search_start),
-				                                      IANJUTA_ITERABLE (search_end), NULL);
-
-			result = incremental_regex_search (search_text, text_to_search, &start_pos, &end_pos, search_forward);
-
-			start_pos += ianjuta_iterable_get_position(IANJUTA_ITERABLE (search_start), NULL);
-			end_pos += ianjuta_iterable_get_position(IANJUTA_ITERABLE (search_start), NULL);
-
-			if (result && start_pos >= 0)
-			{
-				result_start = IANJUTA_EDITOR_CELL (ianjuta_editor_get_start_position (search_box->priv->current_editor,
-					                                                                   NULL));
-				result_end = IANJUTA_EDITOR_CELL (ianjuta_editor_get_start_position (search_box->priv->current_editor,
-					                                                                 NULL));
-
-				if (ianjuta_iterable_set_position(IANJUTA_ITERABLE(result_start), start_pos, NULL) &&
-					ianjuta_iterable_set_position(IANJUTA_ITERABLE(result_end), end_pos, NULL))
-				{
-					found = TRUE;
-				}
-
-				if (!found)
-				{
-					g_object_unref(result_start);
-					g_object_unref(result_end);
-				}
-			}
-
-			g_free(text_to_search);
+			found = search_box_regex_search (search_box, search_start, search_end,
+			                                 search_forward,
+			                                 &result_start, &result_end);
 		}
 		else
 		{
@@ -492,34 +648,9 @@ search_box_incremental_search (SearchBox* search_box, gboolean search_forward,
 		/* Try to search again */
 		if (search_box->priv->regex_mode)
 		{
-			text_to_search = ianjuta_editor_get_text (search_box->priv->current_editor,
-			                                          IANJUTA_ITERABLE(search_start),
-			                                          IANJUTA_ITERABLE(search_end), NULL);
-
-			result = incremental_regex_search (search_text, text_to_search, &start_pos, &end_pos, search_forward);
-
-			start_pos += ianjuta_iterable_get_position(IANJUTA_ITERABLE(search_start), NULL);
-			end_pos += ianjuta_iterable_get_position(IANJUTA_ITERABLE(search_start), NULL);
-
-			if (result && start_pos >= 0)
-			{
-				result_start = IANJUTA_EDITOR_CELL (ianjuta_editor_get_start_position (search_box->priv->current_editor,
-				                                                                       NULL));
-				result_end = IANJUTA_EDITOR_CELL (ianjuta_editor_get_start_position (search_box->priv->current_editor,
-				                                                                     NULL));
-
-				if (ianjuta_iterable_set_position(IANJUTA_ITERABLE(result_start), start_pos, NULL) &&
-				    ianjuta_iterable_set_position(IANJUTA_ITERABLE(result_end), end_pos, NULL))
-				{
-					result_set = TRUE;
-				}
-
-				if (!result_set)
-				{
-					g_object_unref(result_start);
-					g_object_unref(result_end);
-				}
-			}
+			result_set = search_box_regex_search (search_box, search_start, search_end,
+			                                      search_forward,
+			                                      &result_start, &result_end);
 		}
 		else
 		{
@@ -606,6 +737,7 @@ search_box_clear_highlight (SearchBox * search_box)
 	if (!search_box->priv->current_editor)
 		return;
 
+	search_box_stop_highlight (search_box);
 	ianjuta_indicable_clear(IANJUTA_INDICABLE(search_box->priv->current_editor), NULL);	
 	search_box->priv->highlight_complete = FALSE;
 }
@@ -622,6 +754,7 @@ search_box_toggle_highlight (SearchBox * search_box, gboolean status)
 
 	if (!status)
 	{
+		search_box_stop_highlight (search_box);
 		ianjuta_indicable_clear(IANJUTA_INDICABLE(search_box->priv->current_editor), NULL);
 		search_box->priv->highlight_complete = FALSE;
 	}
@@ -636,6 +769,8 @@ search_box_toggle_case_sensitive (SearchBox * search_box, gboolean status)
 	                             status);
 	                               
 	search_box->priv->case_sensitive = status;
+	g_free (search_box->priv->not_found);
+	search_box->priv->not_found = NULL;
 	search_box_clear_highlight(search_box);
 }
 
@@ -649,57 +784,206 @@ search_box_toggle_regex (SearchBox * search_box, gboolean status)
 	                             status);
 	
 	search_box->priv->regex_mode = status;
+	g_free (search_box->priv->not_found);
+	search_box->priv->not_found = NULL;
 	search_box_clear_highlight(search_box);
 
 }
 
-void
-search_box_search_highlight_all (SearchBox * search_box, gboolean search_forward)
+/* Highlight matches starting between the character offsets start and end,
+ * return the offset where the next range has to start */
+static gint
+search_box_highlight_range (SearchBox* search_box, gint start, gint end)
 {
-	IAnjutaEditorCell * highlight_start;
-	IAnjutaEditorSelection * selection;
-	gboolean entry_found;
-	
-	highlight_start = NULL;
-	ianjuta_indicable_clear(IANJUTA_INDICABLE(search_box->priv->current_editor), NULL);
+	IAnjutaEditor* editor = search_box->priv->current_editor;
+	IAnjutaIterable* result_begin;
+	IAnjutaIterable* result_end;
+	gint next = end;
 
-	/* Search through editor and highlight instances of search_entry */
-	while ((entry_found = search_box_incremental_search (search_box, search_forward, TRUE)) == TRUE)
+	if (search_box->priv->regex_mode)
 	{
-		IAnjutaEditorCell * result_begin, * result_end;
-		selection = IANJUTA_EDITOR_SELECTION (search_box->priv->current_editor);
+		GRegex* regex = search_box_get_regex (search_box);
+		GMatchInfo* match_info;
+		const gchar* text;
+		gint end_index;
+
+		if (regex == NULL)
+			return next;
+
+		text = search_box_get_text (search_box);
+		result_begin = ianjuta_editor_get_start_position (editor, NULL);
+		result_end = ianjuta_editor_get_start_position (editor, NULL);
+		end_index = search_box_offset_to_index (search_box, end);
+		g_regex_match_full (regex, text, search_box->priv->text_length,
+		                    search_box_offset_to_index (search_box, start), 0,
+		                    &match_info, NULL);
+		while (g_match_info_matches (match_info))
+		{
+			gint match_start, match_end;
 
-		result_begin = 
-			IANJUTA_EDITOR_CELL (ianjuta_editor_selection_get_start (selection, NULL));	
-		result_end = 
-			IANJUTA_EDITOR_CELL (ianjuta_editor_selection_get_end (selection, NULL));
+			g_match_info_fetch_pos (match_info, 0, &match_start, &match_end);
+			if (match_start >= end_index)
+			{
+				/* There is no match before this one, the next range starts
+				 * here, so the text before is not searched again */
+				next = MAX (next, search_box_index_to_offset (search_box, match_start));
+				break;
+			}
 
-		if (!highlight_start)
-		{
-			highlight_start = 
-				IANJUTA_EDITOR_CELL (ianjuta_iterable_clone (IANJUTA_ITERABLE (result_begin), NULL));
-		} 
-		else if (ianjuta_iterable_compare (IANJUTA_ITERABLE (result_begin),
-											IANJUTA_ITERABLE (highlight_start), NULL) == 0)
+			match_end = search_box_index_to_offset (search_box, match_end);
+			ianjuta_iterable_set_position (result_begin,
+			                               search_box_index_to_offset (search_box, match_start), NULL);
+			ianjuta_iterable_set_position (result_end, match_end, NULL);
+			ianjuta_indicable_set (IANJUTA_INDICABLE (editor),
+			                       result_begin, result_end,
+			                       IANJUTA_INDICABLE_IMPORTANT, NULL);
+			next = MAX (next, match_end);
+
+			g_match_info_next (match_info, NULL);
+		}
+		/* No more match, the whole text has been searched */
+		if (!g_match_info_matches (match_info))
+			next = MAX (next, search_box->priv->text_n_chars);
+		g_match_info_free (match_info);
+	}
+	else
+	{
+		const gchar* search_text = gtk_entry_get_text (GTK_ENTRY (search_box->priv->search_entry));
+		IAnjutaIterable* search_start;
+		IAnjutaIterable* search_end;
+
+		search_start = ianjuta_editor_get_start_position (editor, NULL);
+		search_end = ianjuta_editor_get_start_position (editor, NULL);
+		ianjuta_iterable_set_position (search_start, start, NULL);
+		/* Matches starting before end can finish after it */
+		end += g_utf8_strlen (search_text, -1);
+		if (end < ianjuta_iterable_get_length (search_end, NULL))
+			ianjuta_iterable_set_position (search_end, end, NULL);
+		else
+			ianjuta_iterable_last (search_end, NULL);
+
+		while (ianjuta_editor_search_forward (IANJUTA_EDITOR_SEARCH (editor),
+		                                      search_text, search_box->priv->case_sensitive,
+		                                      IANJUTA_EDITOR_CELL (search_start),
+		                                      IANJUTA_EDITOR_CELL (search_end),
+		                                      (IAnjutaEditorCell **)&result_begin,
+		                                      (IAnjutaEditorCell **)&result_end, NULL))
 		{
+			gboolean in_range = ianjuta_iterable_get_position (result_begin, NULL) < next;
+
+			if (in_range)
+			{
+				ianjuta_indicable_set (IANJUTA_INDICABLE (editor),
+				                       result_begin, result_end,
+				                       IANJUTA_INDICABLE_IMPORTANT, NULL);
+				ianjuta_iterable_assign (search_start, result_end, NULL);
+			}
 			g_object_unref (result_begin);
 			g_object_unref (result_end);
-			g_object_unref (highlight_start);
-			highlight_start = NULL;
-			break;
+			if (!in_range)
+				break;
 		}
+		next = MAX (next, ianjuta_iterable_get_position (search_start, NULL));
+		g_object_unref (search_start);
+		g_object_unref (search_end);
+		return next;
+	}
 
-		ianjuta_indicable_set(IANJUTA_INDICABLE(search_box->priv->current_editor), 
-								IANJUTA_ITERABLE (result_begin), 
-								IANJUTA_ITERABLE (result_end),
-								IANJUTA_INDICABLE_IMPORTANT, NULL);
-		g_object_unref (result_begin);
-		g_object_unref (result_end);
+	g_object_unref (result_begin);
+	g_object_unref (result_end);
+
+	return next;
+}
+
+static gboolean
+search_box_highlight_idle (SearchBox* search_box)
+{
+	IAnjutaIterable* position;
+	gint length;
+	gint end;
+
+	position = ianjuta_editor_get_start_position (search_box->priv->current_editor, NULL);
+	length = ianjuta_iterable_get_length (position, NULL);
+	g_object_unref (position);
+
+	/* Skip the region already highlighted */
+	if ((search_box->priv->highlight_pos >= search_box->priv->highlight_skip_start) &&
+	    (search_box->priv->highlight_pos < search_box->priv->highlight_skip_end))
+		search_box->priv->highlight_pos = search_box->priv->highlight_skip_end;
+
+	if (search_box->priv->highlight_pos >= length)
+	{
+		search_box->priv->highlight_idle = 0;
+		return FALSE;
 	}
-	if (highlight_start)
-		g_object_unref (highlight_start);
+
+	end = MIN (search_box->priv->highlight_pos + HIGHLIGHT_CHUNK_SIZE, length);
+	if (search_box->priv->highlight_pos < search_box->priv->highlight_skip_start)
+		end = MIN (end, search_box->priv->highlight_skip_start);
+	search_box->priv->highlight_pos =
+		search_box_highlight_range (search_box, search_box->priv->highlight_pos, end);
+
+	return TRUE;
+}
+
+void
+search_box_search_highlight_all (SearchBox * search_box, gboolean search_forward)
+{
+	const gchar* search_text = gtk_entry_get_text (GTK_ENTRY (search_box->priv->search_entry));
+	IAnjutaEditor* editor = search_box->priv->current_editor;
+	IAnjutaIterable* position;
+	gint line;
+	gint length;
+
+	if (!editor)
+		return;
+
+	search_box_stop_highlight (search_box);
+	ianjuta_indicable_clear(IANJUTA_INDICABLE(editor), NULL);
 	search_box->priv->highlight_complete = TRUE;
 
+	if (!search_text || !strlen (search_text))
+		return;
+
+	/* Highlight the lines around the cursor first, they are visible */
+	line = ianjuta_editor_get_lineno (editor, NULL);
+	position = ianjuta_editor_get_line_begin_position (editor,
+	                                                   MAX (1, line - HIGHLIGHT_VISIBLE_LINES),
+	                                                   NULL);
+	length = ianjuta_iterable_get_length (position, NULL);
+	search_box->priv->highlight_skip_start = ianjuta_iterable_get_position (position, NULL);
+	g_object_unref (position);
+	position = ianjuta_editor_get_line_begin_position (editor,
+	                                                   line + HIGHLIGHT_VISIBLE_LINES,
+	                                                   NULL);
+	search_box->priv->highlight_skip_end = ianjuta_iterable_get_position (position, NULL);
+	g_object_unref (position);
+	if ((search_box->priv->highlight_skip_end < search_box->priv->highlight_skip_start) ||
+	    (search_box->priv->highlight_skip_end > length))
+		search_box->priv->highlight_skip_end = length;
+
+	search_box->priv->highlight_skip_end =
+		search_box_highlight_range (search_box,
+		                            search_box->priv->highlight_skip_start,
+		                            search_box->priv->highlight_skip_end);
+
+	/* Then the rest of the text when idle */
+	search_box->priv->highlight_pos = 0;
+	search_box->priv->highlight_idle =
+		g_idle_add ((GSourceFunc) search_box_highlight_idle, search_box);
+
+	/* Select the next match */
+	search_box_incremental_search (search_box, search_forward, TRUE);
+}
+
+/* A plain text cannot be found if its beginning is not. It is not true for a
+ * regular expression, "a" is not found in "b" but "a|b" is */
+static gboolean
+search_box_is_not_found (SearchBox* search_box, const gchar* search_text)
+{
+	return !search_box->priv->regex_mode &&
+		(search_box->priv->not_found != NULL) &&
+		g_str_has_prefix (search_text, search_box->priv->not_found);
 }
 
 static void
@@ -709,7 +993,24 @@ on_search_box_entry_changed (GtkWidget * widget, SearchBox * search_box)
 	{
 		GtkEntryBuffer* buffer = gtk_entry_get_buffer (GTK_ENTRY(widget));
 		if (gtk_entry_buffer_get_length (buffer))
-			search_box_incremental_search (search_box, TRUE, TRUE);
+		{
+			const gchar* search_text = gtk_entry_buffer_get_text (buffer);
+
+			if (search_box_is_not_found (search_box, search_text))
+			{
+				search_box_set_entry_color (search_box, FALSE);
+			}
+			else if (search_box_incremental_search (search_box, TRUE, TRUE))
+			{
+				g_free (search_box->priv->not_found);
+				search_box->priv->not_found = NULL;
+			}
+			else
+			{
+				g_free (search_box->priv->not_found);
+				search_box->priv->not_found = g_strdup (search_text);
+			}
+		}
 		else
 		{
 			/* clear selection */
@@ -770,24 +1071,20 @@ search_box_replace (SearchBox * search_box, GtkWidget * widget,
 	{
 		if (search_box->priv->regex_mode)
 		{
-			GRegex * regex;
+			GRegex * regex = search_box_get_regex (search_box);
 			gchar * replacement_text;
-			gint start_pos, end_pos;
 			GError * err = NULL;
-			gboolean result = incremental_regex_search (search_text, selection_text, &start_pos, &end_pos, TRUE);
-				
-			if (result)
+
+			if (regex && g_regex_match (regex, selection_text, 0, NULL))
 			{
-				regex = g_regex_new (search_text, 0, 0, NULL);
 				replacement_text = g_regex_replace(regex, selection_text, strlen(selection_text), 0, 
 													replace_text, 0, &err);
 				if (err)
 				{
 					g_message ("%s",err->message);
 					g_error_free (err);
-					g_regex_unref(regex);
 				}
-                else
+				else
 				{
 					if (undo)
 						ianjuta_document_begin_undo_action (IANJUTA_DOCUMENT (selection), NULL);
@@ -798,10 +1095,7 @@ search_box_replace (SearchBox * search_box, GtkWidget * widget,
 					replace_successful = TRUE;
 				}
 
-				if (regex)
-					g_regex_unref(regex);
-				if (replacement_text)			
-					g_free(replacement_text);
+				g_free(replacement_text);
 			}
 		}
 		else if ((search_box->priv->case_sensitive && g_str_equal (selection_text, search_text)) ||
@@ -1063,6 +1357,11 @@ search_box_init (SearchBox *search_box)
 static void
 search_box_finalize (GObject *object)
 {
+	SearchBox* search_box = SEARCH_BOX (object);
+
+	search_box_stop_highlight (search_box);
+	search_box_clear_text (search_box);
+	search_box_clear_regex (search_box);
 
 	G_OBJECT_CLASS (search_box_parent_class)->finalize (object);
 }
@@ -18,6 +18,7 @@
  */
 
 #include "search-file-command.h"
+#include <glib/gstdio.h>
 #include <string.h>
 
 struct _SearchFileCommandPrivate
@@ -28,9 +29,21 @@ struct _SearchFileCommandPrivate
 	gboolean regex;
 	gboolean case_sensitive;
 
+	/* Index filled with the files read */
+	SearchIndex* index;
+
 	gint n_matches;
+	GList* matches;
 };
 
+/* Position of the last match, to compute line numbers in one pass */
+typedef struct
+{
+	gsize offset;
+	gsize line_start;
+	gint line;
+} SearchFileLocation;
+
 enum
 {
 	PROP_0,
@@ -41,69 +54,522 @@ enum
 	PROP_REGEX
 };
 
-#define BUFFER_SIZE 1024
+/* Files having a null byte in their beginning are considered binary */
+#define BINARY_CHECK_SIZE 8000
+
+/* Only the first matches of a file are kept, the others are counted */
+#define MAX_MATCHES 1000
+
+/* Maximum length of a match preview in bytes */
+#define PREVIEW_SIZE 200
+
+/* Files are replaced by blocks of REPLACE_CHUNK_SIZE bytes, keeping
+ * REPLACE_CONTEXT_SIZE bytes before and after the matched text for
+ * look-around assertions and matches crossing blocks */
+#define REPLACE_CHUNK_SIZE 65536
+#define REPLACE_CONTEXT_SIZE 4096
 
 G_DEFINE_TYPE (SearchFileCommand, search_file_command, ANJUTA_TYPE_ASYNC_COMMAND);
 
+static gchar*
+search_file_command_load (SearchFileCommand* cmd, gsize *length, GError **error)
+{
+	gchar* content;
+
+	/* TODO: Non-UTF8 files... */
+	if (!g_file_load_contents (cmd->priv->file, NULL, &content, length, NULL, error))
+	{
+		return NULL;
+	}
+
+	return content;
+}
+
+static void
+search_file_command_match_free (SearchFileMatch* match)
+{
+	g_free (match->preview);
+	g_free (match);
+}
+
+static void
+search_file_command_clear_matches (SearchFileCommand* cmd)
+{
+	g_list_foreach (cmd->priv->matches, (GFunc)search_file_command_match_free, NULL);
+	g_list_free (cmd->priv->matches);
+	cmd->priv->matches = NULL;
+}
+
+/* Record the match between start and end, matches have to be added in
+ * order */
 static void
-search_file_command_save (SearchFileCommand* cmd, const gchar* new_content, GError **error)
+search_file_command_add_match (SearchFileCommand* cmd,
+                               const gchar* content, gsize length,
+                               gsize start, gsize end,
+                               SearchFileLocation* location)
+{
+	SearchFileMatch* match;
+	const gchar* line_end;
+	const gchar* valid_end;
+	gsize preview_length;
+
+	/* Count lines since the previous match */
+	while (location->offset < start)
+	{
+		const gchar* eol = memchr (content + location->offset, '\n', start - location->offset);
+
+		if (eol == NULL)
+		{
+			location->offset = start;
+			break;
+		}
+		location->line++;
+		location->offset = eol - content + 1;
+		location->line_start = location->offset;
+	}
+
+	match = g_new0 (SearchFileMatch, 1);
+	match->line = location->line;
+	match->column = g_utf8_strlen (content + location->line_start, start - location->line_start);
+	match->length = g_utf8_strlen (content + start, end - start);
+
+	line_end = memchr (content + location->line_start, '\n', length - location->line_start);
+	preview_length = (line_end != NULL ? line_end - content : length) - location->line_start;
+	if ((preview_length > 0) && (content[location->line_start + preview_length - 1] == '\r'))
+		preview_length--;
+	preview_length = MIN (preview_length, PREVIEW_SIZE);
+	g_utf8_validate (content + location->line_start, preview_length, &valid_end);
+	match->preview = g_strchug (g_strndup (content + location->line_start,
+	                                       valid_end - (content + location->line_start)));
+
+	cmd->priv->matches = g_list_prepend (cmd->priv->matches, match);
+}
+
+static gboolean
+search_file_command_is_binary (const gchar* content, gsize length)
+{
+	return memchr (content, '\0', MIN (length, BINARY_CHECK_SIZE)) != NULL;
+}
+
+/* Move pos back to the beginning of the character containing it, so a
+ * block never ends in the middle of a multibyte character */
+static gsize
+search_file_command_char_boundary (const gchar* content, gsize pos)
+{
+	const gchar* prev;
+
+	prev = g_utf8_find_prev_char (content, content + pos);
+	if ((prev != NULL) && (prev + g_utf8_skip[*(const guchar *)prev] > content + pos))
+		return prev - content;
+
+	return pos;
+}
+
+/* Plain strings are searched without GRegex, only ASCII characters can be
+ * compared without case this way */
+static gboolean
+search_file_command_is_literal (SearchFileCommand* cmd)
+{
+	const gchar* ptr;
+
+	if (cmd->priv->regex || (cmd->priv->replace != NULL)) return FALSE;
+	if (*cmd->priv->pattern == '\0') return FALSE;
+	if (cmd->priv->case_sensitive) return TRUE;
+
+	for (ptr = cmd->priv->pattern; *ptr != '\0'; ptr++)
+	{
+		if ((guchar)*ptr >= 0x80) return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* Count non overlapping occurrences of pattern using the Boyer-Moore-Horspool
+ * algorithm, the offsets of the first ones are added to offsets */
+static gint
+search_file_command_count_literal (const gchar* content, gsize length,
+                                   const gchar* pattern, gboolean case_sensitive,
+                                   GArray* offsets)
+{
+	const guchar* text = (const guchar *)content;
+	guchar short_needle[256];
+	guchar* needle;
+	guchar fold[256];
+	gsize skip[256];
+	gsize pattern_length;
+	gsize last;
+	gsize pos;
+	gsize i;
+	gint n_matches = 0;
+
+	pattern_length = strlen (pattern);
+	if ((pattern_length == 0) || (pattern_length > length)) return 0;
+
+	for (i = 0; i < 256; i++)
+		fold[i] = case_sensitive ? i : g_ascii_tolower (i);
+
+	/* Compare with a folded copy of the pattern */
+	needle = pattern_length > sizeof (short_needle) ? g_malloc (pattern_length) : short_needle;
+	for (i = 0; i < pattern_length; i++)
+		needle[i] = fold[(guchar)pattern[i]];
+
+	last = pattern_length - 1;
+	for (i = 0; i < 256; i++)
+		skip[i] = pattern_length;
+	for (i = 0; i < last; i++)
+	{
+		skip[needle[i]] = last - i;
+		if (!case_sensitive) skip[g_ascii_toupper (needle[i])] = last - i;
+	}
+
+	for (pos = 0; pos + pattern_length <= length;)
+	{
+		guchar c = fold[text[pos + last]];
+
+		if ((c == needle[last]) && (fold[text[pos]] == needle[0]))
+		{
+			for (i = 1; (i < last) && (fold[text[pos + i]] == needle[i]); i++);
+			if (i >= last)
+			{
+				if ((offsets != NULL) && (offsets->len < MAX_MATCHES))
+					g_array_append_val (offsets, pos);
+				n_matches++;
+				pos += pattern_length;
+				continue;
+			}
+		}
+		pos += skip[text[pos + last]];
+	}
+	if (needle != short_needle) g_free (needle);
+
+	return n_matches;
+}
+
+/* Search a plain string directly in the file content. Return FALSE if the
+ * file is not a local file.
+ * Mapped memory cannot be read anymore if the file is truncated meanwhile,
+ * so only files which cannot be written are mapped, the other ones are read
+ * in a buffer. */
+static gboolean
+search_file_command_run_literal (SearchFileCommand* cmd, GError **error)
+{
+	GMappedFile* mapped = NULL;
+	gchar* buffer = NULL;
+	gchar* path;
+	GStatBuf buf;
+	const gchar* content;
+	gsize length;
+
+	path = g_file_get_path (cmd->priv->file);
+	if (path == NULL) return FALSE;
+
+	if ((g_stat (path, &buf) == 0) && !(buf.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)))
+	{
+		mapped = g_mapped_file_new (path, FALSE, error);
+		g_free (path);
+		if (mapped == NULL) return TRUE;
+		content = g_mapped_file_get_contents (mapped);
+		length = g_mapped_file_get_length (mapped);
+	}
+	else
+	{
+		gboolean ok;
+
+		ok = g_file_get_contents (path, &buffer, &length, error);
+		g_free (path);
+		if (!ok) return TRUE;
+		content = buffer;
+	}
+
+	if ((content != NULL) && !search_file_command_is_binary (content, length))
+	{
+		GArray* offsets = g_array_new (FALSE, FALSE, sizeof (gsize));
+		SearchFileLocation location = {0, 0, 1};
+		gsize pattern_length = strlen (cmd->priv->pattern);
+		guint i;
+
+		cmd->priv->n_matches = search_file_command_count_literal (content, length,
+		                                                          cmd->priv->pattern,
+		                                                          cmd->priv->case_sensitive,
+		                                                          offsets);
+		for (i = 0; i < offsets->len; i++)
+		{
+			gsize start = g_array_index (offsets, gsize, i);
+
+			search_file_command_add_match (cmd, content, length,
+			                               start, start + pattern_length,
+			                               &location);
+		}
+		g_array_free (offsets, TRUE);
+		cmd->priv->matches = g_list_reverse (cmd->priv->matches);
+	}
+	if ((content != NULL) && (cmd->priv->index != NULL))
+		search_index_add_data (cmd->priv->index, cmd->priv->file, content, length);
+	if (mapped != NULL) g_mapped_file_unref (mapped);
+	g_free (buffer);
+
+	return TRUE;
+}
+
+/* Create a new temporary file in the same directory than file, so it can
+ * be renamed atomically */
+static GFileOutputStream*
+search_file_command_create_temp (SearchFileCommand* cmd, GFile** temp, GError **error)
+{
+	GFile* parent;
+	gchar* basename;
+	GFileOutputStream* ostream = NULL;
+
+	parent = g_file_get_parent (cmd->priv->file);
+	basename = g_file_get_basename (cmd->priv->file);
+	while (ostream == NULL)
+	{
+		gchar* name;
+
+		name = g_strdup_printf (".%s.%08x", basename, g_random_int ());
+		*temp = g_file_get_child (parent, name);
+		g_free (name);
+		ostream = g_file_create (*temp, G_FILE_CREATE_PRIVATE, NULL, error);
+		if (ostream == NULL)
+		{
+			g_object_unref (*temp);
+			*temp = NULL;
+			if (!g_error_matches (*error, G_IO_ERROR, G_IO_ERROR_EXISTS))
+				break;
+			g_clear_error (error);
+		}
+	}
+	g_free (basename);
+	g_object_unref (parent);
+
+	return ostream;
+}
+
+/* Copy the original file in a backup file with a ~ suffix */
+static gboolean
+search_file_command_backup (SearchFileCommand* cmd, GError **error)
 {
+	GFile* parent;
+	GFile* backup;
+	gchar* basename;
+	gchar* name;
+	gboolean ok;
+
+	parent = g_file_get_parent (cmd->priv->file);
+	basename = g_file_get_basename (cmd->priv->file);
+	name = g_strconcat (basename, "~", NULL);
+	backup = g_file_get_child (parent, name);
+	ok = g_file_copy (cmd->priv->file, backup, G_FILE_COPY_OVERWRITE | G_FILE_COPY_ALL_METADATA,
+	                  NULL, NULL, NULL, error);
+	g_object_unref (backup);
+	g_free (name);
+	g_free (basename);
+	g_object_unref (parent);
+
+	return ok;
+}
+
+/* Replace the file by the temporary one. A rename would break symbolic
+ * and hard links, so the content is copied into such files instead.
+ * Return TRUE if the temporary file has been renamed */
+static gboolean
+search_file_command_replace_file (SearchFileCommand* cmd, GFile* temp, GError **error)
+{
+	GFileInfo* info;
+	gboolean linked = FALSE;
+	GFileInputStream* istream;
 	GFileOutputStream* ostream;
 
-	ostream = g_file_replace (cmd->priv->file,
-	                          NULL,
-	                          TRUE,
-	                          G_FILE_CREATE_NONE,
-	                          NULL,
-	                          error);
-	if (*error)
+	info = g_file_query_info (cmd->priv->file,
+	                          G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK ","
+	                          G_FILE_ATTRIBUTE_UNIX_NLINK,
+	                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+	                          NULL, NULL);
+	if (info != NULL)
 	{
-		return;
+		linked = g_file_info_get_is_symlink (info) ||
+			(g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_NLINK) > 1);
+		g_object_unref (info);
 	}
-	/* TODO: Convert to original encoding */
-	g_output_stream_write_all (G_OUTPUT_STREAM(ostream),
-	                           new_content,
-	                           strlen(new_content),
-	                           NULL,
-	                           NULL,
-	                           error);
-	g_object_unref (ostream);
+
+	if (!linked)
+	{
+		/* Keep a backup like g_file_replace, then keep permissions and
+		 * replace the file in one step */
+		if (!search_file_command_backup (cmd, error)) return FALSE;
+		g_file_copy_attributes (cmd->priv->file, temp, G_FILE_COPY_ALL_METADATA, NULL, NULL);
+		return g_file_move (temp, cmd->priv->file, G_FILE_COPY_OVERWRITE, NULL, NULL, NULL, error);
+	}
+
+	istream = g_file_read (temp, NULL, error);
+	if (istream == NULL) return FALSE;
+
+	ostream = g_file_replace (cmd->priv->file, NULL, TRUE, G_FILE_CREATE_NONE, NULL, error);
+	if (ostream != NULL)
+	{
+		g_output_stream_splice (G_OUTPUT_STREAM (ostream), G_INPUT_STREAM (istream),
+		                        G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE |
+		                        G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+		                        NULL, error);
+		g_object_unref (ostream);
+	}
+	g_object_unref (istream);
+
+	return FALSE;
 }
 
-static gchar*
-search_file_command_load (SearchFileCommand* cmd, GError **error)
+/* Replace all matches of regex reading the file by blocks and writing the
+ * result in a temporary file, which replaces the original file if
+ * something has changed */
+static void
+search_file_command_run_replace (SearchFileCommand* cmd, GRegex* regex, GError **error)
 {
-	GString* content;
 	GFileInputStream* istream;
-	gchar buffer[BUFFER_SIZE];
-	gssize bytes_read;
-	
+	GFileOutputStream* ostream;
+	GFile* temp = NULL;
+	gboolean moved = FALSE;
+	GString* buffer;
+	gsize pos = 0;
+	gsize offset = 0;
+	gssize empty_match = -1;
+	gboolean eof = FALSE;
+
 	istream = g_file_read (cmd->priv->file, NULL, error);
-	if (*error)
+	if (istream == NULL) return;
+
+	ostream = search_file_command_create_temp (cmd, &temp, error);
+	if (ostream == NULL)
 	{
-		return NULL;
+		g_object_unref (istream);
+		return;
 	}
-	
-	/* Read file into buffer */
-	content = g_string_new (NULL);
-	while ((bytes_read = g_input_stream_read (G_INPUT_STREAM (istream),
-	                                          buffer,
-	                                          BUFFER_SIZE - 1,
-	                                          NULL,
-	                                          error)))
+
+	buffer = g_string_sized_new (REPLACE_CHUNK_SIZE + 2 * REPLACE_CONTEXT_SIZE);
+	while (!eof)
 	{
-		if (*error)
+		GMatchInfo* match_info;
+		GRegexMatchFlags flags = 0;
+		gsize length = buffer->len;
+		gsize read;
+		gsize limit;
+
+		g_string_set_size (buffer, length + REPLACE_CHUNK_SIZE);
+		if (!g_input_stream_read_all (G_INPUT_STREAM (istream),
+		                              buffer->str + length, REPLACE_CHUNK_SIZE,
+		                              &read, NULL, error))
+			break;
+		g_string_set_size (buffer, length + read);
+		eof = read < REPLACE_CHUNK_SIZE;
+
+		/* Skip binary files */
+		if ((offset == 0) && search_file_command_is_binary (buffer->str, buffer->len))
+		{
+			cmd->priv->n_matches = 0;
+			break;
+		}
+
+		/* Wait for the following text before replacing matches near
+		 * the end of the buffer */
+		if (eof)
+		{
+			length = buffer->len;
+			limit = length;
+		}
+		else
+		{
+			length = search_file_command_char_boundary (buffer->str, buffer->len);
+			limit = search_file_command_char_boundary (buffer->str, buffer->len - REPLACE_CONTEXT_SIZE);
+		}
+		if (offset != 0) flags |= G_REGEX_MATCH_NOTBOL;
+		if (!eof) flags |= G_REGEX_MATCH_NOTEOL;
+
+		g_regex_match_full (regex, buffer->str, length, pos, flags, &match_info, NULL);
+		while (g_match_info_matches (match_info))
+		{
+			gint start;
+			gint end;
+			gchar* replacement;
+
+			g_match_info_fetch_pos (match_info, 0, &start, &end);
+			if ((gsize)start >= limit) break;
+
+			/* A match reaching the end of the block could be longer
+			 * with the following text, keep it for the next block */
+			if (!eof && ((gsize)end >= length))
+			{
+				limit = start;
+				break;
+			}
+
+			/* An empty match could be found again at the same position
+			 * after reading the next block */
+			if ((start == end) && (start == empty_match))
+			{
+				g_match_info_next (match_info, NULL);
+				continue;
+			}
+
+			if (cmd->priv->regex)
+			{
+				replacement = g_match_info_expand_references (match_info, cmd->priv->replace, error);
+				if (replacement == NULL) break;
+			}
+			else
+			{
+				replacement = g_strdup (cmd->priv->replace);
+			}
+
+			if (!g_output_stream_write_all (G_OUTPUT_STREAM (ostream),
+			                                buffer->str + pos, start - pos,
+			                                NULL, NULL, error) ||
+			    !g_output_stream_write_all (G_OUTPUT_STREAM (ostream),
+			                                replacement, strlen (replacement),
+			                                NULL, NULL, error))
+			{
+				g_free (replacement);
+				break;
+			}
+			g_free (replacement);
+
+			cmd->priv->n_matches++;
+			pos = end;
+			empty_match = start == end ? end : -1;
+			g_match_info_next (match_info, NULL);
+		}
+		g_match_info_free (match_info);
+		if (*error != NULL) break;
+
+		/* Write the text without match, keeping some context */
+		if (pos < limit)
+		{
+			if (!g_output_stream_write_all (G_OUTPUT_STREAM (ostream),
+			                                buffer->str + pos, limit - pos,
+			                                NULL, NULL, error))
+				break;
+			pos = limit;
+		}
+		if (pos > REPLACE_CONTEXT_SIZE)
 		{
-			g_string_free (content, TRUE);
-			g_object_unref (istream);
-			return NULL;
+			gsize discard = search_file_command_char_boundary (buffer->str, pos - REPLACE_CONTEXT_SIZE);
+
+			g_string_erase (buffer, 0, discard);
+			offset += discard;
+			pos -= discard;
+			if (empty_match >= 0) empty_match -= discard;
 		}
-		/* TODO: Non-UTF8 files... */
-		g_string_append_len (content, buffer, bytes_read);
 	}
+	g_string_free (buffer, TRUE);
 	g_object_unref (istream);
 
-	return g_string_free (content, FALSE);
+	if (*error == NULL)
+		g_output_stream_close (G_OUTPUT_STREAM (ostream), NULL, error);
+	g_object_unref (ostream);
+
+	if ((*error == NULL) && (cmd->priv->n_matches > 0))
+		moved = search_file_command_replace_file (cmd, temp, error);
+	if (!moved)
+		g_file_delete (temp, NULL, NULL);
+	g_object_unref (temp);
 }
 
 static guint
@@ -112,80 +578,102 @@ search_file_command_run (AnjutaCommand* anjuta_cmd)
 	SearchFileCommand* cmd = SEARCH_FILE_COMMAND(anjuta_cmd);
 	GError* error = NULL;
 	gchar* pattern;
-	gchar* replace;
 	gchar* content;
+	gsize length;
 	GRegexCompileFlags flags = G_REGEX_MULTILINE;
 	GRegex *regex;
 	GMatchInfo *match_info;
+	SearchFileLocation location = {0, 0, 1};
 	
 	g_return_val_if_fail (cmd->priv->file != NULL && G_IS_FILE (cmd->priv->file), 1);
 	g_return_val_if_fail (cmd->priv->pattern != NULL, 1);
 	cmd->priv->n_matches = 0;
-	
-	content = search_file_command_load (cmd, &error);
-	if (error)
+	search_file_command_clear_matches (cmd);
+
+	if (search_file_command_is_literal (cmd) &&
+	    search_file_command_run_literal (cmd, &error))
 	{
-		int code = error->code;
-		g_error_free (error);
-		return code;
+		if (error)
+		{
+			int code = error->code;
+			g_error_free (error);
+			return code;
+		}
+		return 0;
 	}
-	
+
 	if (!cmd->priv->regex)
-	{
 		pattern = g_regex_escape_string (cmd->priv->pattern, -1);
-		if (cmd->priv->replace)
-			replace = g_regex_escape_string (cmd->priv->replace, -1);
-		else
-			replace = NULL;
-	}
 	else
-	{
 		pattern = g_strdup (cmd->priv->pattern);
-		if (cmd->priv->replace)
-			replace = g_strdup (cmd->priv->replace);
-		else
-			replace = NULL;
-	}
 
 	if (!cmd->priv->case_sensitive)
 		flags |= G_REGEX_CASELESS;
 
 	regex = g_regex_new (pattern, flags, 0, &error);
+	g_free (pattern);
 	if (error)
 	{
 		anjuta_command_set_error_message(anjuta_cmd, error->message);
 		g_error_free (error);
-		g_free (content);
 		return 1;
 	}
-	g_regex_match (regex, content, 0, &match_info);
-	while (g_match_info_matches (match_info))
+
+	/* Matches are not kept when replacing, they are changed */
+	if (cmd->priv->replace)
 	{
-		cmd->priv->n_matches++;
-		g_match_info_next (match_info, NULL);
+		search_file_command_run_replace (cmd, regex, &error);
+		g_regex_unref (regex);
+		if (error)
+		{
+			anjuta_async_command_set_error_message (anjuta_cmd, error->message);
+			g_error_free (error);
+			return 1;
+		}
+		return 0;
 	}
-	g_match_info_free (match_info);
 	
-	if (replace && cmd->priv->n_matches)
+	content = search_file_command_load (cmd, &length, &error);
+	if (error)
+	{
+		int code = error->code;
+		g_error_free (error);
+		g_regex_unref (regex);
+		return code;
+	}
+
+	/* Files are read anyway, index them too */
+	if (cmd->priv->index != NULL)
+		search_index_add_data (cmd->priv->index, cmd->priv->file, content, length);
+
+	/* Skip binary files */
+	if (search_file_command_is_binary (content, length))
 	{
-		gchar* new_content;
-		
-		new_content = g_regex_replace (regex, content, -1, 0, replace, 0, NULL);
+		g_free (content);
+		g_regex_unref (regex);
+		return 0;
+	}
 
-		search_file_command_save (cmd, new_content, &error);
-		g_free (new_content);
+	g_regex_match (regex, content, 0, &match_info);
+	while (g_match_info_matches (match_info))
+	{
+		gint start;
+		gint end;
 
-		if (error)
+		if ((cmd->priv->n_matches < MAX_MATCHES) &&
+		    g_match_info_fetch_pos (match_info, 0, &start, &end))
 		{
-			anjuta_async_command_set_error_message (anjuta_cmd, error->message);
-			return 1;
+			search_file_command_add_match (cmd, content, length,
+			                               start, end, &location);
 		}
+		cmd->priv->n_matches++;
+		g_match_info_next (match_info, NULL);
 	}
+	g_match_info_free (match_info);
+	cmd->priv->matches = g_list_reverse (cmd->priv->matches);
 
 	g_regex_unref (regex);
 	g_free (content);
-	g_free (pattern);
-	g_free (replace);
 
 	return 0;
 }
@@ -205,6 +693,7 @@ search_file_command_finalize (GObject *object)
 		g_object_unref (cmd->priv->file);
 	g_free (cmd->priv->pattern);
 	g_free (cmd->priv->replace);
+	search_file_command_clear_matches (cmd);
 
 	G_OBJECT_CLASS (search_file_command_parent_class)->finalize (object);
 }
@@ -345,4 +834,23 @@ search_file_command_get_n_matches (SearchFileCommand* cmd)
 	g_return_val_if_fail (cmd != NULL && SEARCH_IS_FILE_COMMAND (cmd), 0);
 
 	return cmd->priv->n_matches;
-}
\ No newline at end of file
+}
+
+/* The index has to stay valid until the command is finished */
+void
+search_file_command_set_index (SearchFileCommand* cmd, SearchIndex* index)
+{
+	g_return_if_fail (cmd != NULL && SEARCH_IS_FILE_COMMAND (cmd));
+
+	cmd->priv->index = index;
+}
+
+/* Return the matches found in the file, at most MAX_MATCHES of them. The list
+ * belongs to the command */
+GList*
+search_file_command_get_matches (SearchFileCommand* cmd)
+{
+	g_return_val_if_fail (cmd != NULL && SEARCH_IS_FILE_COMMAND (cmd), NULL);
+
+	return cmd->priv->matches;
+}
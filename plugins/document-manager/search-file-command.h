@@ -23,6 +23,8 @@
 #include <libanjuta/anjuta-async-command.h>
 #include <gio/gio.h>
 
+#include "search-index.h"
+
 G_BEGIN_DECLS
 
 #define SEARCH_TYPE_FILE_COMMAND             (search_file_command_get_type ())
@@ -32,10 +34,19 @@ G_BEGIN_DECLS
 #define SEARCH_IS_FILE_COMMAND_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), SEARCH_TYPE_FILE_COMMAND))
 #define SEARCH_FILE_COMMAND_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), SEARCH_TYPE_FILE_COMMAND, SearchFileCommandClass))
 
+typedef struct _SearchFileMatch SearchFileMatch;
 typedef struct _SearchFileCommandClass SearchFileCommandClass;
 typedef struct _SearchFileCommand SearchFileCommand;
 typedef struct _SearchFileCommandPrivate SearchFileCommandPrivate;
 
+struct _SearchFileMatch
+{
+	gint line;			/* Starting at 1 */
+	gint column;		/* In characters, starting at 0 */
+	gint length;		/* In characters */
+	gchar* preview;		/* Line containing the match */
+};
+
 struct _SearchFileCommandClass
 {
 	AnjutaAsyncCommandClass parent_class;
@@ -55,6 +66,8 @@ SearchFileCommand* search_file_command_new (GFile* file,
                                             gboolean case_sensitive,
                                             gboolean regex);
 gint search_file_command_get_n_matches (SearchFileCommand* cmd);
+GList* search_file_command_get_matches (SearchFileCommand* cmd);
+void search_file_command_set_index (SearchFileCommand* cmd, SearchIndex* index);
 
 G_END_DECLS
 
@@ -20,6 +20,7 @@
 #include "search-files.h"
 #include "search-file-command.h"
 #include "search-filter-file-command.h"
+#include "search-index.h"
 #include <libanjuta/anjuta-command-queue.h>
 #include <libanjuta/interfaces/ianjuta-project-manager.h>
 #include <libanjuta/interfaces/ianjuta-project-chooser.h>
@@ -29,6 +30,12 @@
 
 #define TEXT_MIME_TYPE "text/*"
 
+/* Number of files checked by each filter command */
+#define FILTER_BATCH_SIZE 256
+
+#define PREF_SCHEMA "org.gnome.anjuta.document-manager"
+#define PREF_SEARCH_INDEX "search-files-index"
+
 struct _SearchFilesPrivate
 {
 	GtkBuilder* builder;
@@ -47,6 +54,7 @@ struct _SearchFilesPrivate
 
 	GtkWidget* case_check;
 	GtkWidget* regex_check;
+	GtkWidget* index_check;
 
 	GtkWidget* spinner_busy;
 
@@ -68,6 +76,22 @@ struct _SearchFilesPrivate
 	/* Project uri of last search */
 	GFile* project_file;
 
+	/* Commands running for the current search */
+	AnjutaCommandQueue* queue;
+	gboolean cancelled;
+
+	/* Match to select in the next opened editor */
+	gint goto_line;
+	gint goto_column;
+	gint goto_length;
+
+	/* Trigram index of the project files, if enabled */
+	SearchIndex* index;
+	GSettings* settings;
+
+	/* Thread updating the index when project files are added or removed */
+	GThreadPool* index_pool;
+
 	gboolean busy;
 };
 
@@ -88,6 +112,9 @@ enum
 	COLUMN_FILE,
 	COLUMN_ERROR_TOOLTIP,
 	COLUMN_ERROR_CODE,
+	COLUMN_LINE,
+	COLUMN_COLUMN,
+	COLUMN_LENGTH,
 	N_COLUMNS
 };
 
@@ -134,7 +161,10 @@ search_files_update_ui (SearchFiles* sf)
 		gtk_widget_show (sf->priv->spinner_busy);
 	}
 
-	gtk_widget_set_sensitive (sf->priv->search_button, can_search);
+	/* The search button stops the current search */
+	gtk_button_set_label (GTK_BUTTON (sf->priv->search_button),
+	                      sf->priv->busy ? GTK_STOCK_STOP : GTK_STOCK_FIND);
+	gtk_widget_set_sensitive (sf->priv->search_button, can_search || sf->priv->busy);
 	gtk_widget_set_sensitive (sf->priv->replace_button, can_replace);
 	gtk_widget_set_sensitive (sf->priv->search_entry, !sf->priv->busy);
 	gtk_widget_set_sensitive (sf->priv->replace_entry, !sf->priv->busy);
@@ -157,22 +187,146 @@ search_files_check_column_toggled (GtkCellRendererToggle* renderer,
 
 	gtk_tree_path_free(tree_path);
 
+	/* Only files can be selected */
+	if (gtk_tree_store_iter_depth (GTK_TREE_STORE (sf->priv->files_model), &iter) > 0)
+		return;
+
 	gtk_tree_model_get (sf->priv->files_model, &iter,
 	                    COLUMN_SELECTED, &state, -1);
 
-	gtk_list_store_set (GTK_LIST_STORE (sf->priv->files_model), &iter,
+	gtk_tree_store_set (GTK_TREE_STORE (sf->priv->files_model), &iter,
 	                    COLUMN_SELECTED, !state,
 	                    -1);
 }
 
+typedef struct
+{
+	GFile* file;
+	gboolean removed;
+} SearchFilesIndexTask;
+
+static void
+search_files_index_thread (SearchFilesIndexTask* task, SearchIndex* index)
+{
+	if (task->removed)
+		search_index_remove_file (index, task->file);
+	else
+		search_index_add_file (index, task->file);
+	g_object_unref (task->file);
+	g_free (task);
+}
+
+/* Update the index in a thread, reading a file can be slow */
+static void
+search_files_update_index (SearchFiles* sf, GFile* file, gboolean removed)
+{
+	SearchFilesIndexTask* task;
+
+	if (sf->priv->index == NULL) return;
+
+	/* Only one thread, so changes are applied in order */
+	if (sf->priv->index_pool == NULL)
+	{
+		sf->priv->index_pool = g_thread_pool_new ((GFunc)search_files_index_thread,
+		                                          sf->priv->index, 1, FALSE, NULL);
+	}
+
+	task = g_new (SearchFilesIndexTask, 1);
+	task->file = g_object_ref (file);
+	task->removed = removed;
+	g_thread_pool_push (sf->priv->index_pool, task, NULL);
+}
+
+/* Wait until all pending changes are in the index */
+static void
+search_files_wait_index (SearchFiles* sf)
+{
+	if (sf->priv->index_pool != NULL)
+	{
+		g_thread_pool_free (sf->priv->index_pool, FALSE, TRUE);
+		sf->priv->index_pool = NULL;
+	}
+}
+
+/* Return the index of the current project, loading it if needed, or NULL if
+ * it is disabled */
+static SearchIndex*
+search_files_get_index (SearchFiles* sf)
+{
+	if (sf->priv->index != NULL)
+	{
+		if ((sf->priv->project_file != NULL) &&
+		    g_file_equal (search_index_get_directory (sf->priv->index),
+		                  sf->priv->project_file) &&
+		    gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (sf->priv->index_check)))
+		{
+			return sf->priv->index;
+		}
+		search_files_wait_index (sf);
+		search_index_save (sf->priv->index);
+		search_index_free (sf->priv->index);
+		sf->priv->index = NULL;
+	}
+
+	if ((sf->priv->project_file != NULL) &&
+	    gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (sf->priv->index_check)))
+	{
+		sf->priv->index = search_index_new (sf->priv->project_file);
+		search_index_load (sf->priv->index);
+	}
+
+	return sf->priv->index;
+}
+
 static void
 search_files_finished (SearchFiles* sf, AnjutaCommandQueue* queue)
 {
+	if (sf->priv->index != NULL)
+		search_index_save (sf->priv->index);
 	g_object_unref (queue);
+	sf->priv->queue = NULL;
 	sf->priv->busy = FALSE;
 	search_files_update_ui(sf);
 }
 
+static void
+search_files_clear_matches (SearchFiles* sf, GtkTreeIter* iter)
+{
+	GtkTreeIter child;
+
+	while (gtk_tree_model_iter_children (sf->priv->files_model, &child, iter))
+		gtk_tree_store_remove (GTK_TREE_STORE (sf->priv->files_model), &child);
+}
+
+/* Add one child row per match below the file row */
+static void
+search_files_add_matches (SearchFiles* sf, GtkTreeIter* iter, GFile* file, GList* matches)
+{
+	GList* item;
+
+	for (item = matches; item != NULL; item = g_list_next (item))
+	{
+		SearchFileMatch* match = (SearchFileMatch *)item->data;
+		GtkTreeIter child;
+		gchar* text;
+
+		text = g_strdup_printf ("%d: %s", match->line, match->preview);
+		gtk_tree_store_append (GTK_TREE_STORE (sf->priv->files_model), &child, iter);
+		gtk_tree_store_set (GTK_TREE_STORE (sf->priv->files_model), &child,
+		                    COLUMN_SELECTED, FALSE,
+		                    COLUMN_FILENAME, text,
+		                    COLUMN_FILE, file,
+		                    COLUMN_COUNT, 1,
+		                    COLUMN_SPINNER, FALSE,
+		                    COLUMN_PULSE, FALSE,
+		                    COLUMN_LINE, match->line,
+		                    COLUMN_COLUMN, match->column,
+		                    COLUMN_LENGTH, match->length,
+		                    -1);
+		g_free (text);
+	}
+}
+
 static void
 search_files_command_finished (SearchFileCommand* cmd,
                                guint return_code,
@@ -187,26 +341,34 @@ search_files_command_finished (SearchFileCommand* cmd,
 	path = gtk_tree_row_reference_get_path(tree_ref);
 
 	gtk_tree_model_get_iter(sf->priv->files_model, &iter, path);
-	gtk_list_store_set (GTK_LIST_STORE (sf->priv->files_model),
+	gtk_tree_store_set (GTK_TREE_STORE (sf->priv->files_model),
 	                    &iter,
 	                    COLUMN_COUNT, search_file_command_get_n_matches(cmd),
 	                    COLUMN_ERROR_CODE, return_code,
 	                    COLUMN_ERROR_TOOLTIP, NULL,
 	                    -1);
-	gtk_tree_row_reference_free(tree_ref);
 	gtk_tree_path_free(path);
 
+	search_files_clear_matches (sf, &iter);
+	if (return_code == 0)
+	{
+		GFile* file;
+
+		g_object_get (cmd, "file", &file, NULL);
+		search_files_add_matches (sf, &iter, file,
+		                          search_file_command_get_matches (cmd));
+		g_object_unref (file);
+	}
+
 	if (return_code)
 	{
-		gtk_list_store_set (GTK_LIST_STORE (sf->priv->files_model),
+		gtk_tree_store_set (GTK_TREE_STORE (sf->priv->files_model),
 		                    &iter,
 		                    COLUMN_ERROR_CODE, return_code,
 		                    COLUMN_ERROR_TOOLTIP,
 		                    anjuta_command_get_error_message(ANJUTA_COMMAND(cmd)),
 		                    -1);
 	}
-
-	g_object_unref (cmd);
 }
 
 static void
@@ -219,6 +381,16 @@ search_files_search (SearchFiles* sf)
 		AnjutaCommandQueue* queue = anjuta_command_queue_new(ANJUTA_COMMAND_QUEUE_EXECUTE_MANUAL);
 		const gchar* pattern =
 			gtk_entry_get_text (GTK_ENTRY (sf->priv->search_entry));
+		SearchIndex* index = search_files_get_index (sf);
+		GHashTable* candidates = NULL;
+
+		/* Only files possibly matching or not indexed have to be read */
+		if (index != NULL)
+		{
+			candidates = search_index_find (index, pattern,
+			                                gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON (sf->priv->case_check)),
+			                                gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON (sf->priv->regex_check)));
+		}
 		do
 		{
 			GFile* file;
@@ -238,6 +410,23 @@ search_files_search (SearchFiles* sf)
 			gtk_tree_model_get (sf->priv->files_model, &iter,
 			                    COLUMN_FILE, &file,
 			                    COLUMN_SELECTED, &selected, -1);
+			if (selected && (candidates != NULL) &&
+			    search_index_is_up_to_date (index, file))
+			{
+				gchar* filename = g_file_get_path (file);
+
+				if (g_hash_table_lookup (candidates, filename) == NULL)
+				{
+					search_files_clear_matches (sf, &iter);
+					gtk_tree_store_set (GTK_TREE_STORE (sf->priv->files_model), &iter,
+					                    COLUMN_COUNT, 0,
+					                    COLUMN_ERROR_CODE, 0,
+					                    COLUMN_ERROR_TOOLTIP, NULL,
+					                    -1);
+					selected = FALSE;
+				}
+				g_free (filename);
+			}
 			if (selected)
 			{
 				GtkTreePath* path;
@@ -254,22 +443,34 @@ search_files_search (SearchFiles* sf)
 				                                                 NULL,
 				                                                 sf->priv->case_sensitive,
 				                                                 sf->priv->regex);
-				g_object_set_data (G_OBJECT (cmd), "__tree_ref",
-				                   ref);
+				search_file_command_set_index (cmd, index);
+				g_object_set_data_full (G_OBJECT (cmd), "__tree_ref",
+				                        ref, (GDestroyNotify)gtk_tree_row_reference_free);
 
 				g_signal_connect (cmd, "command-finished",
 				                  G_CALLBACK(search_files_command_finished), sf);
 
 				anjuta_command_queue_push(queue,
 				                          ANJUTA_COMMAND(cmd));
+				g_object_unref (cmd);
 			}
 			g_object_unref (file);
 		}
 		while (gtk_tree_model_iter_next(sf->priv->files_model, &iter));
+		if (candidates != NULL)
+			g_hash_table_destroy (candidates);
 
 		g_signal_connect_swapped (queue, "finished", G_CALLBACK (search_files_finished), sf);
 
-		anjuta_command_queue_start (queue);
+		/* Files are independent, search them on all processors */
+		anjuta_command_queue_set_max_running (queue, 0);
+		sf->priv->queue = queue;
+		if (!anjuta_command_queue_start (queue))
+		{
+			/* No file selected */
+			search_files_finished (sf, queue);
+			return;
+		}
 		gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE (sf->priv->files_model),
 		                                     COLUMN_COUNT,
 		                                     GTK_SORT_DESCENDING);
@@ -326,14 +527,15 @@ search_files_replace_clicked (SearchFiles* sf)
 				                                                 replace,
 				                                                 sf->priv->case_sensitive,
 				                                                 sf->priv->regex);
-				g_object_set_data (G_OBJECT (cmd), "__tree_ref",
-				                   ref);
+				g_object_set_data_full (G_OBJECT (cmd), "__tree_ref",
+				                        ref, (GDestroyNotify)gtk_tree_row_reference_free);
 
 				g_signal_connect (cmd, "command-finished",
 				                  G_CALLBACK(search_files_command_finished), sf);
 
 				anjuta_command_queue_push(queue,
 				                          ANJUTA_COMMAND(cmd));
+				g_object_unref (cmd);
 			}
 			g_object_unref (file);
 		}
@@ -341,7 +543,15 @@ search_files_replace_clicked (SearchFiles* sf)
 
 		g_signal_connect_swapped (queue, "finished", G_CALLBACK (search_files_finished), sf);
 
-		anjuta_command_queue_start (queue);
+		/* Files are independent, search them on all processors */
+		anjuta_command_queue_set_max_running (queue, 0);
+		sf->priv->queue = queue;
+		if (!anjuta_command_queue_start (queue))
+		{
+			/* No file selected */
+			search_files_finished (sf, queue);
+			return;
+		}
 		gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE (sf->priv->files_model),
 		                                     COLUMN_COUNT,
 		                                     GTK_SORT_DESCENDING);
@@ -352,39 +562,50 @@ search_files_replace_clicked (SearchFiles* sf)
 }
 
 static void
-search_files_filter_command_finished (SearchFilterFileCommand* cmd,
-                                      guint return_code,
-                                      SearchFiles* sf)
+search_files_filter_data_arrived (SearchFilterFileCommand* cmd,
+                                  SearchFiles* sf)
 {
-	GFile* file;
-	GtkTreeIter iter;
-	gchar* display_name = NULL;
+	GList* files;
+	GList* item;
 
-	if (return_code)
-		return;
-
-	g_object_get (cmd, "file", &file, NULL);
-
-	if (sf->priv->project_file)
+	files = search_filter_file_command_take_files (cmd);
+	for (item = files; item != NULL; item = g_list_next (item))
 	{
-		display_name = g_file_get_relative_path (sf->priv->project_file,
-		                                         G_FILE (file));
+		GFile* file = G_FILE (item->data);
+		GtkTreeIter iter;
+		gchar* display_name = NULL;
+
+		if (sf->priv->project_file)
+		{
+			display_name = g_file_get_relative_path (sf->priv->project_file,
+			                                         file);
+		}
+		if (!display_name)
+			display_name = g_file_get_path (file);
+
+		gtk_tree_store_append(GTK_TREE_STORE (sf->priv->files_model),
+		                      &iter, NULL);
+		gtk_tree_store_set (GTK_TREE_STORE (sf->priv->files_model), &iter,
+		                    COLUMN_SELECTED, TRUE,
+		                    COLUMN_FILENAME, display_name,
+		                    COLUMN_FILE, file,
+		                    COLUMN_COUNT, 0,
+		                    COLUMN_SPINNER, FALSE,
+		                    COLUMN_PULSE, FALSE, -1);
+
+		g_object_unref (file);
+		g_free (display_name);
 	}
-	if (!display_name)
-		display_name = g_file_get_path (G_FILE(file));
-
-	gtk_list_store_append(GTK_LIST_STORE (sf->priv->files_model),
-	                      &iter);
-	gtk_list_store_set (GTK_LIST_STORE (sf->priv->files_model), &iter,
-	                    COLUMN_SELECTED, TRUE,
-	                    COLUMN_FILENAME, display_name,
-	                    COLUMN_FILE, file,
-	                    COLUMN_COUNT, 0,
-	                    COLUMN_SPINNER, FALSE,
-	                    COLUMN_PULSE, FALSE, -1);
+	g_list_free (files);
+}
 
-	g_object_unref (file);
-	g_free (display_name);
+static void
+search_files_filter_command_finished (SearchFilterFileCommand* cmd,
+                                      guint return_code,
+                                      SearchFiles* sf)
+{
+	/* Get files not notified yet */
+	search_files_filter_data_arrived (cmd, sf);
 }
 
 static void
@@ -392,7 +613,16 @@ search_files_filter_finished (AnjutaCommandQueue* queue,
                               SearchFiles* sf)
 {
 	g_object_unref (queue);
-	search_files_search (sf);
+	sf->priv->queue = NULL;
+	if (sf->priv->cancelled)
+	{
+		sf->priv->busy = FALSE;
+		search_files_update_ui (sf);
+	}
+	else
+	{
+		search_files_search (sf);
+	}
 }
 
 void
@@ -410,8 +640,18 @@ search_files_search_clicked (SearchFiles* sf)
 
 	g_return_if_fail (sf != NULL && SEARCH_IS_FILES (sf));
 
+	/* Stop the current search, results found so far are kept */
+	if (sf->priv->busy)
+	{
+		sf->priv->cancelled = TRUE;
+		if (sf->priv->queue != NULL)
+			anjuta_command_queue_cancel (sf->priv->queue);
+		return;
+	}
+	sf->priv->cancelled = FALSE;
+
 	/* Clear store */
-	gtk_list_store_clear(GTK_LIST_STORE (sf->priv->files_model));
+	gtk_tree_store_clear(GTK_TREE_STORE (sf->priv->files_model));
 	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE (sf->priv->files_model),
 	                                     COLUMN_FILENAME,
 	                                     GTK_SORT_DESCENDING);
@@ -453,18 +693,34 @@ search_files_search_clicked (SearchFiles* sf)
 	{
 		/* Queue file filtering */
 		queue = anjuta_command_queue_new(ANJUTA_COMMAND_QUEUE_EXECUTE_MANUAL);
+		anjuta_command_queue_set_max_running (queue, 0);
 		g_signal_connect (queue, "finished",
 	    	              G_CALLBACK (search_files_filter_finished), sf);
-		for (file = files; file != NULL; file = g_list_next (file))
+		/* Each command checks a batch of files */
+		for (file = files; file != NULL;)
 		{
-			SearchFilterFileCommand* cmd =
-				search_filter_file_command_new(G_FILE (file->data),
-			    	                           mime_types);
+			GList* batch = NULL;
+			SearchFilterFileCommand* cmd;
+			guint i;
+
+			for (i = 0; (i < FILTER_BATCH_SIZE) && (file != NULL); i++)
+			{
+				batch = g_list_prepend (batch, file->data);
+				file = g_list_next (file);
+			}
+			batch = g_list_reverse (batch);
+			cmd = search_filter_file_command_new(batch, mime_types);
+			g_list_free (batch);
+
+			g_signal_connect (cmd, "data-arrived",
+			                  G_CALLBACK (search_files_filter_data_arrived), sf);
 			g_signal_connect (cmd, "command-finished",
-		    	              G_CALLBACK (search_files_filter_command_finished), sf);
+			                  G_CALLBACK (search_files_filter_command_finished), sf);
 			anjuta_command_queue_push(queue, ANJUTA_COMMAND(cmd));
+			g_object_unref (cmd);
 		}
 		sf->priv->busy = TRUE;
+		sf->priv->queue = queue;
 		search_files_update_ui(sf);
 		anjuta_command_queue_start (queue);
 
@@ -475,6 +731,18 @@ search_files_search_clicked (SearchFiles* sf)
 	g_free (mime_types);
 }
 
+static void
+search_files_element_added (SearchFiles* sf, GFile* file)
+{
+	search_files_update_index (sf, file, FALSE);
+}
+
+static void
+search_files_element_removed (SearchFiles* sf, GFile* file)
+{
+	search_files_update_index (sf, file, TRUE);
+}
+
 static void
 search_files_render_count (GtkTreeViewColumn *tree_column,
                            GtkCellRenderer *cell,
@@ -485,6 +753,13 @@ search_files_render_count (GtkTreeViewColumn *tree_column,
 	int count;
 	gchar* count_str;
 
+	/* Nothing to display for matches */
+	if (gtk_tree_store_iter_depth (GTK_TREE_STORE (tree_model), iter) > 0)
+	{
+		g_object_set (cell, "text", NULL, NULL);
+		return;
+	}
+
 	gtk_tree_model_get (tree_model, iter,
 	                    COLUMN_COUNT, &count,
 	                    -1);
@@ -493,6 +768,71 @@ search_files_render_count (GtkTreeViewColumn *tree_column,
 	g_free (count_str);
 }
 
+static void
+search_files_render_selected (GtkTreeViewColumn *tree_column,
+                              GtkCellRenderer *cell,
+                              GtkTreeModel *tree_model,
+                              GtkTreeIter *iter,
+                              gpointer data)
+{
+	g_object_set (cell, "visible",
+	              gtk_tree_store_iter_depth (GTK_TREE_STORE (tree_model), iter) == 0,
+	              NULL);
+}
+
+/* Sort files using the column but keep matches in the file order */
+static gint
+search_files_compare (GtkTreeModel* model,
+                      GtkTreeIter* a,
+                      GtkTreeIter* b,
+                      gpointer data)
+{
+	gint column = GPOINTER_TO_INT (data);
+	gint result;
+
+	if (gtk_tree_store_iter_depth (GTK_TREE_STORE (model), a) > 0)
+	{
+		gint line_a, line_b;
+		gint column_a, column_b;
+		gint sort_column;
+		GtkSortType order;
+
+		gtk_tree_model_get (model, a, COLUMN_LINE, &line_a, COLUMN_COLUMN, &column_a, -1);
+		gtk_tree_model_get (model, b, COLUMN_LINE, &line_b, COLUMN_COLUMN, &column_b, -1);
+		result = line_a != line_b ? line_a - line_b : column_a - column_b;
+
+		/* The result is reversed by the tree model in descending order */
+		gtk_tree_sortable_get_sort_column_id (GTK_TREE_SORTABLE (model), &sort_column, &order);
+
+		return order == GTK_SORT_DESCENDING ? -result : result;
+	}
+
+	if (column == COLUMN_FILENAME)
+	{
+		gchar* name_a;
+		gchar* name_b;
+
+		gtk_tree_model_get (model, a, COLUMN_FILENAME, &name_a, -1);
+		gtk_tree_model_get (model, b, COLUMN_FILENAME, &name_b, -1);
+		if ((name_a != NULL) && (name_b != NULL))
+			result = g_utf8_collate (name_a, name_b);
+		else
+			result = g_strcmp0 (name_a, name_b);
+		g_free (name_a);
+		g_free (name_b);
+	}
+	else
+	{
+		gint value_a, value_b;
+
+		gtk_tree_model_get (model, a, column, &value_a, -1);
+		gtk_tree_model_get (model, b, column, &value_b, -1);
+		result = value_a - value_b;
+	}
+
+	return result;
+}
+
 static void
 search_files_editor_loaded (SearchFiles* sf, IAnjutaEditor* editor)
 {
@@ -517,7 +857,29 @@ search_files_editor_loaded (SearchFiles* sf, IAnjutaEditor* editor)
 	search_box_toggle_regex(sf->priv->search_box,
 	                        sf->priv->regex);
 	search_box_search_highlight_all(sf->priv->search_box, TRUE);
-	search_box_incremental_search(sf->priv->search_box, TRUE, FALSE);
+	/* Select the activated match rather than the next one */
+	if (sf->priv->goto_line > 0)
+	{
+		IAnjutaIterable* start;
+		IAnjutaIterable* end;
+
+		start = ianjuta_editor_get_line_begin_position (editor, sf->priv->goto_line, NULL);
+		ianjuta_iterable_set_position (start,
+		                               ianjuta_iterable_get_position (start, NULL) + sf->priv->goto_column,
+		                               NULL);
+		end = ianjuta_iterable_clone (start, NULL);
+		ianjuta_iterable_set_position (end,
+		                               ianjuta_iterable_get_position (start, NULL) + sf->priv->goto_length,
+		                               NULL);
+		ianjuta_editor_selection_set (IANJUTA_EDITOR_SELECTION (editor), start, end, TRUE, NULL);
+		g_object_unref (start);
+		g_object_unref (end);
+		sf->priv->goto_line = 0;
+	}
+	else
+	{
+		search_box_incremental_search(sf->priv->search_box, TRUE, FALSE);
+	}
 
 	gtk_widget_show (GTK_WIDGET(sf->priv->search_box));
 }
@@ -535,7 +897,11 @@ search_files_result_activated (GtkTreeView* files_tree,
 
 	gtk_tree_model_get_iter (sf->priv->files_model, &iter, path);
 	gtk_tree_model_get (sf->priv->files_model, &iter,
-	                    COLUMN_FILE, &file, -1);
+	                    COLUMN_FILE, &file,
+	                    COLUMN_LINE, &sf->priv->goto_line,
+	                    COLUMN_COLUMN, &sf->priv->goto_column,
+	                    COLUMN_LENGTH, &sf->priv->goto_length,
+	                    -1);
 
 	/* Check if document is open */
 	editor = anjuta_docman_get_document_for_file(sf->priv->docman, file);
@@ -549,7 +915,7 @@ search_files_result_activated (GtkTreeView* files_tree,
 	else
 	{
 		IAnjutaEditor* real_editor =
-			anjuta_docman_goto_file_line(sf->priv->docman, file, 0);
+			anjuta_docman_goto_file_line(sf->priv->docman, file, sf->priv->goto_line);
 		if (real_editor)
 			g_signal_connect_swapped (real_editor, "opened",
 			                          G_CALLBACK (search_files_editor_loaded), sf);
@@ -585,6 +951,11 @@ search_files_init_tree (SearchFiles* sf)
 	                                   selection_renderer,
 	                                   "active",
 	                                   COLUMN_SELECTED);
+	gtk_tree_view_column_set_cell_data_func(column_select,
+	                                        selection_renderer,
+	                                        search_files_render_selected,
+	                                        NULL,
+	                                        NULL);
 	g_signal_connect (selection_renderer, "toggled",
 	                  G_CALLBACK(search_files_check_column_toggled), sf);
 	gtk_tree_view_column_set_sort_column_id(column_select,
@@ -636,7 +1007,7 @@ search_files_init_tree (SearchFiles* sf)
 	gtk_tree_view_column_set_sort_column_id(column_count,
 	                                        COLUMN_COUNT);
 
-	sf->priv->files_model = GTK_TREE_MODEL (gtk_list_store_new (N_COLUMNS,
+	sf->priv->files_model = GTK_TREE_MODEL (gtk_tree_store_new (N_COLUMNS,
 	                                                            G_TYPE_BOOLEAN,
 	                                                            G_TYPE_STRING,
 	                                                            G_TYPE_INT,
@@ -644,7 +1015,19 @@ search_files_init_tree (SearchFiles* sf)
 	                                                            G_TYPE_BOOLEAN,
 	                                                            G_TYPE_FILE,
 	                                                            G_TYPE_STRING,
+	                                                            G_TYPE_INT,
+	                                                            G_TYPE_INT,
+	                                                            G_TYPE_INT,
 	                                                            G_TYPE_INT));
+	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (sf->priv->files_model),
+	                                 COLUMN_SELECTED, search_files_compare,
+	                                 GINT_TO_POINTER (COLUMN_SELECTED), NULL);
+	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (sf->priv->files_model),
+	                                 COLUMN_FILENAME, search_files_compare,
+	                                 GINT_TO_POINTER (COLUMN_FILENAME), NULL);
+	gtk_tree_sortable_set_sort_func (GTK_TREE_SORTABLE (sf->priv->files_model),
+	                                 COLUMN_COUNT, search_files_compare,
+	                                 GINT_TO_POINTER (COLUMN_COUNT), NULL);
 	gtk_tree_sortable_set_sort_column_id(GTK_TREE_SORTABLE (sf->priv->files_model),
 	                                     COLUMN_FILENAME,
 	                                     GTK_SORT_DESCENDING);
@@ -785,6 +1168,8 @@ search_files_init (SearchFiles* sf)
 	                                                             "case_check"));
 	sf->priv->regex_check = GTK_WIDGET (gtk_builder_get_object(sf->priv->builder,
 	                                                           "regex_check"));
+	sf->priv->index_check = GTK_WIDGET (gtk_builder_get_object(sf->priv->builder,
+	                                                           "index_check"));
 	sf->priv->spinner_busy = GTK_WIDGET (gtk_builder_get_object(sf->priv->builder,
 	                                                            "spinner_busy"));
 
@@ -793,6 +1178,11 @@ search_files_init (SearchFiles* sf)
 
 	search_files_init_tree(sf);
 
+	sf->priv->settings = g_settings_new (PREF_SCHEMA);
+	g_settings_bind (sf->priv->settings, PREF_SEARCH_INDEX,
+	                 sf->priv->index_check, "active",
+	                 G_SETTINGS_BIND_DEFAULT);
+
 	gtk_builder_connect_signals(sf->priv->builder, sf);
 
 	g_object_ref (sf->priv->main_box);
@@ -807,6 +1197,13 @@ search_files_finalize (GObject* object)
 
 	g_object_unref (sf->priv->main_box);
 	g_object_unref (sf->priv->builder);
+	g_object_unref (sf->priv->settings);
+	if (sf->priv->index)
+	{
+		search_files_wait_index (sf);
+		search_index_save (sf->priv->index);
+		search_index_free (sf->priv->index);
+	}
 	if (sf->priv->project_file)
 		g_object_unref (sf->priv->project_file);
 	g_free (sf->priv->last_search_string);
@@ -843,6 +1240,7 @@ search_files_new (AnjutaDocman* docman, SearchBox* search_box)
 	AnjutaShell* shell = docman->shell;
 	GObject* obj = g_object_new (SEARCH_TYPE_FILES, NULL);
 	SearchFiles* sf = SEARCH_FILES(obj);
+	IAnjutaProjectManager* pm;
 
 	anjuta_shell_add_widget(shell, sf->priv->main_box,
 	                        "search_files",
@@ -853,6 +1251,18 @@ search_files_new (AnjutaDocman* docman, SearchBox* search_box)
 	sf->priv->docman = docman;
 	sf->priv->search_box = search_box;
 
+	/* Keep the index in sync with the project files */
+	pm = anjuta_shell_get_interface (shell, IAnjutaProjectManager, NULL);
+	if (pm != NULL)
+	{
+		g_signal_connect_object (pm, "element-added",
+		                         G_CALLBACK (search_files_element_added), sf,
+		                         G_CONNECT_SWAPPED);
+		g_signal_connect_object (pm, "element-removed",
+		                         G_CALLBACK (search_files_element_removed), sf,
+		                         G_CONNECT_SWAPPED);
+	}
+
 	gtk_widget_show (sf->priv->main_box);
 
 	search_files_type_combo_init(sf);
@@ -19,65 +19,203 @@
 
 #include "search-filter-file-command.h"
 #include <libanjuta/anjuta-debug.h>
+#include <glib/gstdio.h>
 
 struct _SearchFilterFileCommandPrivate
 {
-	GFile* file;
+	GList* files;
 	gchar* mime_types;
+
+	/* Files of the right type, protected by the command lock */
+	GList* accepted;
+
+	gint cancelled;
 };
 
 enum
 {
 	PROP_0,
 
-	PROP_FILE,
+	PROP_FILES,
 	PROP_MIME_TYPES
 };
 
+/* Content types found by reading files, they are kept for all searches */
+typedef struct
+{
+	gint64 mtime;
+	gchar* content_type;
+} SearchFilterCacheEntry;
+
+G_LOCK_DEFINE_STATIC (cache);
+static GHashTable* content_type_cache = NULL;
+
+static void
+search_filter_cache_entry_free (SearchFilterCacheEntry* entry)
+{
+	g_free (entry->content_type);
+	g_free (entry);
+}
+
+/* The cache has to be locked */
+static GHashTable*
+search_filter_get_cache (void)
+{
+	if (content_type_cache == NULL)
+	{
+		content_type_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+		                                            (GDestroyNotify)search_filter_cache_entry_free);
+	}
+
+	return content_type_cache;
+}
+
+/* Return the content type of file. It is guessed from the file name when it
+ * is not ambiguous, else it is read from the file and cached with its
+ * modification time */
+static gchar*
+search_filter_file_command_get_content_type (GFile* file, GError** error)
+{
+	gchar* path;
+	gchar* content_type;
+	gboolean uncertain;
+	GStatBuf buf;
+	GFileInfo* file_info;
+
+	/* Missing files are reported by g_file_query_info */
+	path = g_file_get_path (file);
+	if ((path != NULL) && (g_stat (path, &buf) == 0))
+	{
+		SearchFilterCacheEntry* entry;
 
+		content_type = g_content_type_guess (path, NULL, 0, &uncertain);
+		if (!uncertain)
+		{
+			g_free (path);
+			return content_type;
+		}
+		g_free (content_type);
+
+		G_LOCK (cache);
+		entry = g_hash_table_lookup (search_filter_get_cache (), path);
+		content_type = (entry != NULL) && (entry->mtime == buf.st_mtime) ?
+			g_strdup (entry->content_type) : NULL;
+		G_UNLOCK (cache);
+		if (content_type != NULL)
+		{
+			g_free (path);
+			return content_type;
+		}
+	}
+
+	file_info = g_file_query_info (file,
+	                               G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
+	                               G_FILE_ATTRIBUTE_TIME_MODIFIED,
+	                               G_FILE_QUERY_INFO_NONE,
+	                               NULL, error);
+	if (file_info == NULL)
+	{
+		g_free (path);
+		return NULL;
+	}
+	content_type = g_strdup (g_file_info_get_content_type (file_info));
+
+	if ((path != NULL) && (content_type != NULL))
+	{
+		SearchFilterCacheEntry* entry = g_new0 (SearchFilterCacheEntry, 1);
+
+		entry->mtime = g_file_info_get_attribute_uint64 (file_info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+		entry->content_type = g_strdup (content_type);
+		G_LOCK (cache);
+		g_hash_table_insert (search_filter_get_cache (), path, entry);
+		G_UNLOCK (cache);
+		path = NULL;
+	}
+	g_free (path);
+	g_object_unref (file_info);
+
+	return content_type;
+}
 
 static guint
 search_filter_file_command_run (AnjutaCommand* anjuta_cmd)
 {
 	SearchFilterFileCommand* cmd = SEARCH_FILTER_FILE_COMMAND (anjuta_cmd);
-	
-	gchar** mime_types = g_strsplit (cmd->priv->mime_types, ",", -1);
-	gchar** mime_type;
-	guint retval = 1;
+	gchar** mime_types;
+	gchar** content_types;
+	GHashTable* results;
+	GList* item;
+	guint i;
 
-	GFileInfo* file_info;
-	GError* error = NULL;
+	/* Convert the mime types only once */
+	mime_types = g_strsplit (cmd->priv->mime_types, ",", -1);
+	content_types = g_new0 (gchar*, g_strv_length (mime_types) + 1);
+	for (i = 0; mime_types[i] != NULL; i++)
+		content_types[i] = g_content_type_from_mime_type (mime_types[i]);
+	g_strfreev (mime_types);
 
-	file_info = g_file_query_info (cmd->priv->file,
-	                               G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
-	                               G_FILE_QUERY_INFO_NONE,
-	                               NULL, &error);
+	/* Content type -> accepted or not */
+	results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
-	if (file_info)
+	for (item = cmd->priv->files; item != NULL; item = g_list_next (item))
 	{
-		for (mime_type = mime_types; mime_type && *mime_type; mime_type++)
+		GFile* file = G_FILE (item->data);
+		gchar* content_type;
+		gpointer accepted;
+		GError* error = NULL;
+
+		if (g_atomic_int_get (&cmd->priv->cancelled))
+			break;
+
+		content_type = search_filter_file_command_get_content_type (file, &error);
+		if (content_type == NULL)
 		{
-			gchar* content_type = g_content_type_from_mime_type (*mime_type);
-			if (g_content_type_is_a (g_file_info_get_content_type (file_info),
-				                     content_type))
+			if (error != NULL)
 			{
-				retval = 0;
-				g_free (content_type);
-				break;
+				DEBUG_PRINT ("Couldn't query mime-type: %s", error->message);
+				g_error_free (error);
 			}
+			continue;
+		}
+
+		if (!g_hash_table_lookup_extended (results, content_type, NULL, &accepted))
+		{
+			accepted = GINT_TO_POINTER (FALSE);
+			for (i = 0; content_types[i] != NULL; i++)
+			{
+				if (g_content_type_is_a (content_type, content_types[i]))
+				{
+					accepted = GINT_TO_POINTER (TRUE);
+					break;
+				}
+			}
+			g_hash_table_insert (results, content_type, accepted);
+		}
+		else
+		{
+			g_free (content_type);
+		}
+
+		if (GPOINTER_TO_INT (accepted))
+		{
+			anjuta_async_command_lock (ANJUTA_ASYNC_COMMAND (cmd));
+			cmd->priv->accepted = g_list_prepend (cmd->priv->accepted, g_object_ref (file));
+			anjuta_async_command_unlock (ANJUTA_ASYNC_COMMAND (cmd));
+			anjuta_command_notify_data_arrived (anjuta_cmd);
 		}
-		g_object_unref (file_info);
-	}
-	else
-	{
-		int code = error->code;
-		DEBUG_PRINT ("Couldn't query mime-type: %s", error->message);
-		g_error_free (error);
-		return code;
 	}
-	g_strfreev(mime_types);
-	
-	return retval;
+	g_hash_table_destroy (results);
+	g_strfreev (content_types);
+
+	return 0;
+}
+
+static void
+search_filter_file_command_cancel (AnjutaCommand* anjuta_cmd)
+{
+	SearchFilterFileCommand* cmd = SEARCH_FILTER_FILE_COMMAND (anjuta_cmd);
+
+	g_atomic_int_set (&cmd->priv->cancelled, TRUE);
 }
 
 G_DEFINE_TYPE (SearchFilterFileCommand, search_filter_file_command, ANJUTA_TYPE_ASYNC_COMMAND);
@@ -95,8 +233,10 @@ search_filter_file_command_finalize (GObject *object)
 {
 	SearchFilterFileCommand* cmd = SEARCH_FILTER_FILE_COMMAND(object);
 
-	if (cmd->priv->file)
-		g_object_unref (cmd->priv->file);
+	g_list_foreach (cmd->priv->files, (GFunc)g_object_unref, NULL);
+	g_list_free (cmd->priv->files);
+	g_list_foreach (cmd->priv->accepted, (GFunc)g_object_unref, NULL);
+	g_list_free (cmd->priv->accepted);
 	g_free (cmd->priv->mime_types);
 
 	G_OBJECT_CLASS (search_filter_file_command_parent_class)->finalize (object);
@@ -113,10 +253,11 @@ search_filter_file_command_set_property (GObject *object, guint prop_id, const G
 
 	switch (prop_id)
 	{
-	case PROP_FILE:
-		if (cmd->priv->file)
-			g_object_unref (cmd->priv->file);
-		cmd->priv->file = G_FILE(g_value_dup_object (value));
+	case PROP_FILES:
+		g_list_foreach (cmd->priv->files, (GFunc)g_object_unref, NULL);
+		g_list_free (cmd->priv->files);
+		cmd->priv->files = g_list_copy (g_value_get_pointer (value));
+		g_list_foreach (cmd->priv->files, (GFunc)g_object_ref, NULL);
 		break;
 	case PROP_MIME_TYPES:
 		g_free (cmd->priv->mime_types);
@@ -139,8 +280,8 @@ search_filter_file_command_get_property (GObject *object, guint prop_id, GValue
 
 	switch (prop_id)
 	{
-	case PROP_FILE:
-		g_value_set_object (value, cmd->priv->file);
+	case PROP_FILES:
+		g_value_set_pointer (value, cmd->priv->files);
 		break;
 	case PROP_MIME_TYPES:
 		g_value_set_string (value, cmd->priv->mime_types);
@@ -162,12 +303,11 @@ search_filter_file_command_class_init (SearchFilterFileCommandClass *klass)
 	object_class->get_property = search_filter_file_command_get_property;
 
 	g_object_class_install_property (object_class,
-	                                 PROP_FILE,
-	                                 g_param_spec_object ("file",
-	                                                      "",
-	                                                      "",
-	                                                      G_TYPE_FILE,
-	                                                      G_PARAM_READABLE | G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+	                                 PROP_FILES,
+	                                 g_param_spec_pointer ("files",
+	                                                       "",
+	                                                       "List of GFile to filter",
+	                                                       G_PARAM_READABLE | G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
 
 	g_object_class_install_property (object_class,
 	                                 PROP_MIME_TYPES,
@@ -178,19 +318,37 @@ search_filter_file_command_class_init (SearchFilterFileCommandClass *klass)
 	                                                       G_PARAM_READABLE | G_PARAM_WRITABLE | G_PARAM_CONSTRUCT));
 
 	cmd_class->run = search_filter_file_command_run;
+	cmd_class->cancel = search_filter_file_command_cancel;
 	
 	g_type_class_add_private (klass, sizeof (SearchFilterFileCommandPrivate));
 }
 
 
 SearchFilterFileCommand*
-search_filter_file_command_new (GFile* file, const gchar* mime_types)
+search_filter_file_command_new (GList* files, const gchar* mime_types)
 {
 	SearchFilterFileCommand* cmd;
 
 	cmd = SEARCH_FILTER_FILE_COMMAND (g_object_new (SEARCH_TYPE_FILTER_FILE_COMMAND,
-	                                                "file", file,
+	                                                "files", files,
 	                                                "mime-types", mime_types,
 	                                                NULL));
 	return cmd;
 }
+
+/* Return the files of the right type found since the last call, in the
+ * order of the list. The caller owns the list and the files. It has to be
+ * called in a data-arrived handler, the command is already locked, or when
+ * the command is finished */
+GList*
+search_filter_file_command_take_files (SearchFilterFileCommand* cmd)
+{
+	GList* files;
+
+	g_return_val_if_fail (cmd != NULL && SEARCH_IS_FILTER_FILE_COMMAND (cmd), NULL);
+
+	files = cmd->priv->accepted;
+	cmd->priv->accepted = NULL;
+
+	return g_list_reverse (files);
+}
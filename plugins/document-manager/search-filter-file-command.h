@@ -49,7 +49,8 @@ struct _SearchFilterFileCommand
 };
 
 GType search_filter_file_command_get_type (void) G_GNUC_CONST;
-SearchFilterFileCommand* search_filter_file_command_new (GFile* file, const gchar* mime_types);
+SearchFilterFileCommand* search_filter_file_command_new (GList* files, const gchar* mime_types);
+GList* search_filter_file_command_take_files (SearchFilterFileCommand* cmd);
 
 G_END_DECLS
 
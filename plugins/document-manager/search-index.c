@@ -0,0 +1,827 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * search-index.c
+ *
+ * anjuta is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * anjuta is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Trigram index of the project files. Each file is split in all its
+ * sequences of three bytes, the index keeps for each of these trigrams the
+ * list of files containing it. A plain string can only be in files
+ * containing all its trigrams, so only these files have to be read.
+ *
+ * Trigrams are stored with ASCII letters in lower case, so the index is
+ * used for case sensitive and case insensitive searches. The modification
+ * time and the size of each file are kept to detect files changed since
+ * they have been indexed, these ones have to be searched anyway.
+ *
+ * The index is filled while searching, each file read by a search command
+ * is added, and saved in the project directory.
+ */
+
+#include <config.h>
+
+#include "search-index.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* Files having a null byte in their beginning are not indexed */
+#define BINARY_CHECK_SIZE 8000
+
+/* Bigger files are never indexed, they are always searched */
+#define MAX_INDEXED_SIZE (64 * 1024 * 1024)
+
+#define INDEX_MAGIC "ANJUTA-SEARCH-INDEX-2\n"
+#define INDEX_BYTE_ORDER 0x01020304
+
+#define TRIGRAM_KEY(a,b,c) \
+	(((guint32)fold[(guchar)(a)] << 16) | ((guint32)fold[(guchar)(b)] << 8) | (guint32)fold[(guchar)(c)])
+
+typedef struct
+{
+	gchar* path;
+	gint64 mtime;			/* Modification time in microseconds */
+	guint64 size;
+	gboolean removed;
+} SearchIndexFile;
+
+struct _SearchIndex
+{
+	GMutex* mutex;
+
+	GFile* directory;
+	gchar* filename;
+
+	GPtrArray* files;		/* Id -> SearchIndexFile */
+	GHashTable* ids;		/* Path -> id + 1 */
+	GHashTable* trigrams;	/* Trigram -> sorted GArray of file ids */
+	guint n_removed;
+
+	gboolean modified;
+};
+
+static guchar fold[256];
+
+static void
+search_index_init_fold (void)
+{
+	static gsize initialized = 0;
+
+	if (g_once_init_enter (&initialized))
+	{
+		guint i;
+
+		for (i = 0; i < 256; i++)
+			fold[i] = g_ascii_tolower (i);
+		g_once_init_leave (&initialized, 1);
+	}
+}
+
+static void
+search_index_file_free (SearchIndexFile* file)
+{
+	g_free (file->path);
+	g_free (file);
+}
+
+static void
+search_index_posting_free (GArray* posting)
+{
+	g_array_free (posting, TRUE);
+}
+
+static void
+search_index_clear (SearchIndex* index)
+{
+	g_ptr_array_set_size (index->files, 0);
+	g_hash_table_remove_all (index->ids);
+	g_hash_table_remove_all (index->trigrams);
+	index->n_removed = 0;
+}
+
+static gboolean
+search_index_stat (const gchar* path, gint64* mtime, guint64* size)
+{
+	GStatBuf buf;
+
+	if ((g_stat (path, &buf) != 0) || !S_ISREG (buf.st_mode)) return FALSE;
+	/* Keep the fractional part, a file can be changed several times in
+	 * the same second without changing its size */
+	*mtime = (gint64)buf.st_mtime * G_USEC_PER_SEC;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+	*mtime += buf.st_mtim.tv_nsec / 1000;
+#endif
+	*size = buf.st_size;
+
+	return TRUE;
+}
+
+/* Return the index of path or -1, the index has to be locked */
+static gint
+search_index_lookup (SearchIndex* index, const gchar* path)
+{
+	return GPOINTER_TO_INT (g_hash_table_lookup (index->ids, path)) - 1;
+}
+
+static void
+search_index_remove_path (SearchIndex* index, const gchar* path)
+{
+	gint id = search_index_lookup (index, path);
+
+	if (id >= 0)
+	{
+		SearchIndexFile* file = g_ptr_array_index (index->files, id);
+
+		/* Ids are kept sorted in posting lists, so the file is only marked
+		 * as removed until the index is saved */
+		file->removed = TRUE;
+		index->n_removed++;
+		g_hash_table_remove (index->ids, path);
+		index->modified = TRUE;
+	}
+}
+
+/* Check if the file is indexed with the same modification time and size,
+ * the index has to be locked */
+static gboolean
+search_index_has_path (SearchIndex* index, const gchar* path, gint64 mtime, guint64 size)
+{
+	gint id = search_index_lookup (index, path);
+	SearchIndexFile* indexed;
+
+	if (id < 0) return FALSE;
+	indexed = g_ptr_array_index (index->files, id);
+
+	return (indexed->mtime == mtime) && (indexed->size == size);
+}
+
+/* Add a file with its trigrams, the index has to be locked */
+static void
+search_index_insert (SearchIndex* index, gchar* path, gint64 mtime, guint64 size,
+                     GHashTable* trigrams)
+{
+	SearchIndexFile* file;
+	guint32 id;
+
+	search_index_remove_path (index, path);
+
+	file = g_new0 (SearchIndexFile, 1);
+	file->path = path;
+	file->mtime = mtime;
+	file->size = size;
+	id = index->files->len;
+	g_ptr_array_add (index->files, file);
+	g_hash_table_insert (index->ids, file->path, GINT_TO_POINTER (id + 1));
+
+	if (trigrams != NULL)
+	{
+		GHashTableIter iter;
+		gpointer key;
+
+		g_hash_table_iter_init (&iter, trigrams);
+		while (g_hash_table_iter_next (&iter, &key, NULL))
+		{
+			GArray* posting = g_hash_table_lookup (index->trigrams, key);
+
+			if (posting == NULL)
+			{
+				posting = g_array_new (FALSE, FALSE, sizeof (guint32));
+				g_hash_table_insert (index->trigrams, key, posting);
+			}
+			/* New ids are always the biggest, the list stays sorted */
+			g_array_append_val (posting, id);
+		}
+	}
+	index->modified = TRUE;
+}
+
+/* Remove files marked as removed and renumber the remaining ones */
+static void
+search_index_compact (SearchIndex* index)
+{
+	guint32* new_ids;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	guint32 id;
+	guint32 n_files;
+
+	if (index->n_removed == 0) return;
+
+	new_ids = g_new (guint32, index->files->len);
+	for (id = 0, n_files = 0; id < index->files->len; id++)
+	{
+		SearchIndexFile* file = g_ptr_array_index (index->files, id);
+
+		if (file->removed)
+		{
+			new_ids[id] = G_MAXUINT32;
+			search_index_file_free (file);
+		}
+		else
+		{
+			new_ids[id] = n_files;
+			g_ptr_array_index (index->files, n_files) = file;
+			g_hash_table_insert (index->ids, file->path, GINT_TO_POINTER (n_files + 1));
+			n_files++;
+		}
+	}
+	/* Files are already freed or moved */
+	g_ptr_array_set_free_func (index->files, NULL);
+	g_ptr_array_set_size (index->files, n_files);
+	g_ptr_array_set_free_func (index->files, (GDestroyNotify)search_index_file_free);
+
+	g_hash_table_iter_init (&iter, index->trigrams);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		GArray* posting = (GArray *)value;
+		guint i, j;
+
+		for (i = 0, j = 0; i < posting->len; i++)
+		{
+			guint32 new_id = new_ids[g_array_index (posting, guint32, i)];
+
+			if (new_id != G_MAXUINT32) g_array_index (posting, guint32, j++) = new_id;
+		}
+		if (j == 0)
+			g_hash_table_iter_remove (&iter);
+		else
+			g_array_set_size (posting, j);
+	}
+	g_free (new_ids);
+	index->n_removed = 0;
+}
+
+/* Return a set of all trigrams found in content */
+static GHashTable*
+search_index_get_trigrams (const gchar* content, gsize length)
+{
+	GHashTable* trigrams;
+	gsize i;
+
+	trigrams = g_hash_table_new (g_direct_hash, g_direct_equal);
+	for (i = 0; i + 2 < length; i++)
+	{
+		guint32 key = TRIGRAM_KEY (content[i], content[i + 1], content[i + 2]);
+
+		g_hash_table_insert (trigrams, GUINT_TO_POINTER (key), NULL);
+	}
+
+	return trigrams;
+}
+
+/* Keep the current run of characters if it is the longest one */
+static void
+search_index_end_literal (GString* run, GString* best)
+{
+	if (run->len > best->len) g_string_assign (best, run->str);
+	g_string_truncate (run, 0);
+}
+
+/* Return the longest string which has to be present in all matches or NULL.
+ * Only simple regular expressions are handled, a string is looked for in
+ * the main alternative only, groups, character classes and optional
+ * characters stop it */
+static gchar*
+search_index_get_literal (const gchar* pattern, gboolean regex)
+{
+	GString* run;
+	GString* best;
+	const gchar* ptr;
+	gint depth = 0;
+
+	if (!regex) return g_strdup (pattern);
+
+	/* Options like (?i) change the whole pattern */
+	if (strstr (pattern, "(?") != NULL) return NULL;
+
+	run = g_string_new (NULL);
+	best = g_string_new (NULL);
+	for (ptr = pattern; *ptr != '\0'; ptr++)
+	{
+		switch (*ptr)
+		{
+		case '\\':
+			ptr++;
+			if (*ptr == '\0')
+			{
+				ptr--;
+			}
+			else if (!g_ascii_isalnum (*ptr))
+			{
+				if (depth == 0) g_string_append_c (run, *ptr);
+				continue;
+			}
+			else if (strchr ("dDwWsSbBAzZGnrtfeaRhHvVXK", *ptr) == NULL)
+			{
+				/* Escapes like \x41 or back references are not handled */
+				g_string_free (run, TRUE);
+				g_string_free (best, TRUE);
+				return NULL;
+			}
+			break;
+		case '(':
+			depth++;
+			break;
+		case ')':
+			depth--;
+			break;
+		case '|':
+			if (depth == 0)
+			{
+				/* The string could be in another alternative */
+				g_string_free (run, TRUE);
+				g_string_free (best, TRUE);
+				return NULL;
+			}
+			break;
+		case '[':
+			/* Skip character class */
+			ptr++;
+			if (*ptr == '^') ptr++;
+			if (*ptr == ']') ptr++;
+			while ((*ptr != '\0') && (*ptr != ']'))
+			{
+				if ((*ptr == '\\') && (ptr[1] != '\0'))
+				{
+					ptr++;
+				}
+				else if ((*ptr == '[') && (ptr[1] == ':'))
+				{
+					/* POSIX class like [:space:] */
+					const gchar* end = strstr (ptr + 2, ":]");
+
+					if (end != NULL) ptr = end + 1;
+				}
+				ptr++;
+			}
+			if (*ptr == '\0') ptr--;
+			break;
+		case '?':
+		case '*':
+		case '{':
+			/* The previous character is optional, remove it with all the
+			 * bytes of its UTF-8 encoding */
+			if (run->len > 0)
+			{
+				gsize len = run->len - 1;
+
+				while ((len > 0) && ((run->str[len] & 0xC0) == 0x80)) len--;
+				g_string_truncate (run, len);
+			}
+			if (*ptr == '{')
+			{
+				while ((ptr[1] != '\0') && (*ptr != '}')) ptr++;
+			}
+			break;
+		case '+':
+		case '.':
+		case '^':
+		case '$':
+			break;
+		default:
+			if (depth == 0) g_string_append_c (run, *ptr);
+			continue;
+		}
+		search_index_end_literal (run, best);
+	}
+	search_index_end_literal (run, best);
+	g_string_free (run, TRUE);
+
+	return g_string_free (best, best->len == 0);
+}
+
+/* Copy size bytes from the saved index if they are available */
+static gboolean
+search_index_read (const gchar** ptr, const gchar* end, gpointer data, gsize size)
+{
+	if ((gsize)(end - *ptr) < size) return FALSE;
+	memcpy (data, *ptr, size);
+	*ptr += size;
+
+	return TRUE;
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+SearchIndex*
+search_index_new (GFile* directory)
+{
+	SearchIndex* index;
+	gchar* path;
+
+	search_index_init_fold ();
+
+	index = g_new0 (SearchIndex, 1);
+	index->mutex = g_mutex_new ();
+	index->directory = g_object_ref (directory);
+	path = g_file_get_path (directory);
+	if (path != NULL)
+	{
+		index->filename = g_build_filename (path, SEARCH_INDEX_FILE, NULL);
+		g_free (path);
+	}
+	index->files = g_ptr_array_new_with_free_func ((GDestroyNotify)search_index_file_free);
+	index->ids = g_hash_table_new (g_str_hash, g_str_equal);
+	index->trigrams = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+	                                         NULL, (GDestroyNotify)search_index_posting_free);
+
+	return index;
+}
+
+void
+search_index_free (SearchIndex* index)
+{
+	g_hash_table_destroy (index->trigrams);
+	g_hash_table_destroy (index->ids);
+	g_ptr_array_free (index->files, TRUE);
+	g_free (index->filename);
+	g_object_unref (index->directory);
+	g_mutex_free (index->mutex);
+	g_free (index);
+}
+
+GFile*
+search_index_get_directory (SearchIndex* index)
+{
+	return index->directory;
+}
+
+/* Read the index saved in the project directory, keep an empty index if it
+ * does not exist or is not valid */
+gboolean
+search_index_load (SearchIndex* index)
+{
+	gchar* content;
+	gsize length;
+	const gchar* ptr;
+	const gchar* end;
+	guint32 n_files;
+	guint32 n_trigrams;
+	guint32 value;
+	guint32 i;
+	gboolean ok = FALSE;
+
+	if (index->filename == NULL) return FALSE;
+	if (!g_file_get_contents (index->filename, &content, &length, NULL)) return FALSE;
+
+	g_mutex_lock (index->mutex);
+	search_index_clear (index);
+
+	ptr = content;
+	end = content + length;
+	if ((length < strlen (INDEX_MAGIC)) ||
+	    (memcmp (content, INDEX_MAGIC, strlen (INDEX_MAGIC)) != 0)) goto out;
+	ptr += strlen (INDEX_MAGIC);
+	if (!search_index_read (&ptr, end, &value, sizeof (value))) goto out;
+	if (value != INDEX_BYTE_ORDER) goto out;
+
+	if (!search_index_read (&ptr, end, &n_files, sizeof (n_files))) goto out;
+	for (i = 0; i < n_files; i++)
+	{
+		SearchIndexFile* file;
+		guint32 path_length;
+
+		if (!search_index_read (&ptr, end, &path_length, sizeof (path_length))) goto out;
+		if ((gsize)(end - ptr) < path_length) goto out;
+		file = g_new0 (SearchIndexFile, 1);
+		file->path = g_strndup (ptr, path_length);
+		ptr += path_length;
+		g_ptr_array_add (index->files, file);
+		g_hash_table_insert (index->ids, file->path, GINT_TO_POINTER (i + 1));
+		if (!search_index_read (&ptr, end, &file->mtime, sizeof (file->mtime))) goto out;
+		if (!search_index_read (&ptr, end, &file->size, sizeof (file->size))) goto out;
+	}
+
+	if (!search_index_read (&ptr, end, &n_trigrams, sizeof (n_trigrams))) goto out;
+	for (i = 0; i < n_trigrams; i++)
+	{
+		GArray* posting;
+		guint32 key;
+		guint32 count;
+		guint32 j;
+
+		if (!search_index_read (&ptr, end, &key, sizeof (key))) goto out;
+		if (!search_index_read (&ptr, end, &count, sizeof (count))) goto out;
+		if ((gsize)(end - ptr) / sizeof (guint32) < count) goto out;
+		posting = g_array_sized_new (FALSE, FALSE, sizeof (guint32), count);
+		g_array_append_vals (posting, ptr, count);
+		ptr += count * sizeof (guint32);
+		g_hash_table_insert (index->trigrams, GUINT_TO_POINTER (key), posting);
+		for (j = 0; j < count; j++)
+		{
+			if (g_array_index (posting, guint32, j) >= n_files) goto out;
+		}
+	}
+	ok = TRUE;
+
+out:
+	if (!ok) search_index_clear (index);
+	index->modified = FALSE;
+	g_mutex_unlock (index->mutex);
+	g_free (content);
+
+	return ok;
+}
+
+/* Write the index in the project directory if it has been modified */
+gboolean
+search_index_save (SearchIndex* index)
+{
+	GString* str;
+	GHashTableIter iter;
+	gpointer key;
+	gpointer value;
+	guint32 number;
+	guint i;
+	gboolean ok;
+
+	if (index->filename == NULL) return FALSE;
+
+	g_mutex_lock (index->mutex);
+	if (!index->modified)
+	{
+		g_mutex_unlock (index->mutex);
+		return TRUE;
+	}
+	search_index_compact (index);
+
+	str = g_string_new (INDEX_MAGIC);
+	number = INDEX_BYTE_ORDER;
+	g_string_append_len (str, (const gchar *)&number, sizeof (number));
+
+	number = index->files->len;
+	g_string_append_len (str, (const gchar *)&number, sizeof (number));
+	for (i = 0; i < index->files->len; i++)
+	{
+		SearchIndexFile* file = g_ptr_array_index (index->files, i);
+
+		number = strlen (file->path);
+		g_string_append_len (str, (const gchar *)&number, sizeof (number));
+		g_string_append_len (str, file->path, number);
+		g_string_append_len (str, (const gchar *)&file->mtime, sizeof (file->mtime));
+		g_string_append_len (str, (const gchar *)&file->size, sizeof (file->size));
+	}
+
+	number = g_hash_table_size (index->trigrams);
+	g_string_append_len (str, (const gchar *)&number, sizeof (number));
+	g_hash_table_iter_init (&iter, index->trigrams);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+	{
+		GArray* posting = (GArray *)value;
+
+		number = GPOINTER_TO_UINT (key);
+		g_string_append_len (str, (const gchar *)&number, sizeof (number));
+		number = posting->len;
+		g_string_append_len (str, (const gchar *)&number, sizeof (number));
+		g_string_append_len (str, posting->data, posting->len * sizeof (guint32));
+	}
+	index->modified = FALSE;
+	g_mutex_unlock (index->mutex);
+
+	/* The file is written in a temporary file and renamed */
+	ok = g_file_set_contents (index->filename, str->str, str->len, NULL);
+	g_string_free (str, TRUE);
+
+	return ok;
+}
+
+/* Index file using its content, already read. It can be called from
+ * several threads */
+void
+search_index_add_data (SearchIndex* index, GFile* file,
+                       const gchar* content, gsize length)
+{
+	GHashTable* trigrams = NULL;
+	gchar* path;
+	gint64 mtime;
+	guint64 size;
+
+	path = g_file_get_path (file);
+	if (path == NULL) return;
+
+	/* Do not index a file changed after it has been read */
+	if (!search_index_stat (path, &mtime, &size) || (size != length) ||
+	    (length > MAX_INDEXED_SIZE))
+	{
+		g_free (path);
+		return;
+	}
+
+	/* Nothing to do if the file has not changed since it has been indexed */
+	g_mutex_lock (index->mutex);
+	if (search_index_has_path (index, path, mtime, size))
+	{
+		g_mutex_unlock (index->mutex);
+		g_free (path);
+		return;
+	}
+	g_mutex_unlock (index->mutex);
+
+	/* Binary files are kept without trigram so they are never searched */
+	if (memchr (content, '\0', MIN (length, BINARY_CHECK_SIZE)) == NULL)
+		trigrams = search_index_get_trigrams (content, length);
+
+	g_mutex_lock (index->mutex);
+	if (search_index_has_path (index, path, mtime, size))
+	{
+		/* Indexed by another thread in the meantime */
+		g_free (path);
+	}
+	else
+	{
+		search_index_insert (index, path, mtime, size, trigrams);
+	}
+	g_mutex_unlock (index->mutex);
+
+	if (trigrams != NULL) g_hash_table_destroy (trigrams);
+}
+
+gboolean
+search_index_add_file (SearchIndex* index, GFile* file)
+{
+	GMappedFile* mapped;
+	gchar* path;
+
+	path = g_file_get_path (file);
+	if (path == NULL) return FALSE;
+	mapped = g_mapped_file_new (path, FALSE, NULL);
+	g_free (path);
+	if (mapped == NULL) return FALSE;
+
+	search_index_add_data (index, file,
+	                       g_mapped_file_get_contents (mapped),
+	                       g_mapped_file_get_length (mapped));
+	g_mapped_file_unref (mapped);
+
+	return TRUE;
+}
+
+void
+search_index_remove_file (SearchIndex* index, GFile* file)
+{
+	gchar* path;
+
+	path = g_file_get_path (file);
+	if (path == NULL) return;
+
+	g_mutex_lock (index->mutex);
+	search_index_remove_path (index, path);
+	g_mutex_unlock (index->mutex);
+	g_free (path);
+}
+
+/* Return TRUE if the file has not been changed since it has been indexed */
+gboolean
+search_index_is_up_to_date (SearchIndex* index, GFile* file)
+{
+	gchar* path;
+	gint64 mtime;
+	guint64 size;
+	gboolean up_to_date = FALSE;
+
+	path = g_file_get_path (file);
+	if (path == NULL) return FALSE;
+
+	if (search_index_stat (path, &mtime, &size))
+	{
+		g_mutex_lock (index->mutex);
+		up_to_date = search_index_has_path (index, path, mtime, size);
+		g_mutex_unlock (index->mutex);
+	}
+	g_free (path);
+
+	return up_to_date;
+}
+
+static gint
+compare_posting_length (gconstpointer a, gconstpointer b)
+{
+	const GArray* posting_a = *(const GArray **)a;
+	const GArray* posting_b = *(const GArray **)b;
+
+	return posting_a->len < posting_b->len ? -1 : (posting_a->len > posting_b->len ? 1 : 0);
+}
+
+/* Return the set of indexed file paths which can match pattern or NULL if
+ * the index cannot be used for this pattern. Files not indexed or changed
+ * since have to be searched in all cases. */
+GHashTable*
+search_index_find (SearchIndex* index, const gchar* pattern,
+                   gboolean case_sensitive, gboolean regex)
+{
+	GHashTable* candidates;
+	GHashTable* trigrams;
+	GPtrArray* postings;
+	GArray* result;
+	GHashTableIter iter;
+	gpointer key;
+	gchar* literal;
+	gsize length;
+	guint i;
+
+	literal = search_index_get_literal (pattern, regex);
+	if (literal == NULL) return NULL;
+	length = strlen (literal);
+	if (length < 3)
+	{
+		g_free (literal);
+		return NULL;
+	}
+	if (!case_sensitive)
+	{
+		/* Other characters can have several representations */
+		for (i = 0; i < length; i++)
+		{
+			if ((guchar)literal[i] >= 0x80)
+			{
+				g_free (literal);
+				return NULL;
+			}
+		}
+	}
+	trigrams = search_index_get_trigrams (literal, length);
+	g_free (literal);
+
+	candidates = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+	g_mutex_lock (index->mutex);
+	postings = g_ptr_array_new ();
+	g_hash_table_iter_init (&iter, trigrams);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+	{
+		GArray* posting = g_hash_table_lookup (index->trigrams, key);
+
+		if (posting == NULL)
+		{
+			/* No file contains this trigram */
+			g_ptr_array_set_size (postings, 0);
+			break;
+		}
+		g_ptr_array_add (postings, posting);
+	}
+	g_hash_table_destroy (trigrams);
+
+	if (postings->len > 0)
+	{
+		/* Intersect the lists starting with the shortest ones */
+		g_ptr_array_sort (postings, compare_posting_length);
+		result = g_array_new (FALSE, FALSE, sizeof (guint32));
+		g_array_append_vals (result, ((GArray *)g_ptr_array_index (postings, 0))->data,
+		                     ((GArray *)g_ptr_array_index (postings, 0))->len);
+		for (i = 1; (i < postings->len) && (result->len > 0); i++)
+		{
+			GArray* posting = g_ptr_array_index (postings, i);
+			guint a, b, n;
+
+			for (a = 0, b = 0, n = 0; (a < result->len) && (b < posting->len);)
+			{
+				guint32 id_a = g_array_index (result, guint32, a);
+				guint32 id_b = g_array_index (posting, guint32, b);
+
+				if (id_a < id_b)
+				{
+					a++;
+				}
+				else if (id_a > id_b)
+				{
+					b++;
+				}
+				else
+				{
+					g_array_index (result, guint32, n++) = id_a;
+					a++;
+					b++;
+				}
+			}
+			g_array_set_size (result, n);
+		}
+
+		for (i = 0; i < result->len; i++)
+		{
+			SearchIndexFile* file = g_ptr_array_index (index->files, g_array_index (result, guint32, i));
+
+			if (!file->removed)
+				g_hash_table_insert (candidates, g_strdup (file->path), GINT_TO_POINTER (TRUE));
+		}
+		g_array_free (result, TRUE);
+	}
+	g_ptr_array_free (postings, TRUE);
+	g_mutex_unlock (index->mutex);
+
+	return candidates;
+}
@@ -0,0 +1,48 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * search-index.h
+ *
+ * anjuta is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * anjuta is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SEARCH_INDEX_H_
+#define _SEARCH_INDEX_H_
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define SEARCH_INDEX_FILE ".anjuta_search_index"
+
+typedef struct _SearchIndex SearchIndex;
+
+SearchIndex* search_index_new (GFile* directory);
+void search_index_free (SearchIndex* index);
+
+gboolean search_index_load (SearchIndex* index);
+gboolean search_index_save (SearchIndex* index);
+GFile* search_index_get_directory (SearchIndex* index);
+
+void search_index_add_data (SearchIndex* index, GFile* file,
+                            const gchar* content, gsize length);
+gboolean search_index_add_file (SearchIndex* index, GFile* file);
+void search_index_remove_file (SearchIndex* index, GFile* file);
+gboolean search_index_is_up_to_date (SearchIndex* index, GFile* file);
+
+GHashTable* search_index_find (SearchIndex* index, const gchar* pattern,
+                               gboolean case_sensitive, gboolean regex);
+
+G_END_DECLS
+
+#endif /* _SEARCH_INDEX_H_ */
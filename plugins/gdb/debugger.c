@@ -153,7 +153,8 @@ static void debugger_stdo_flush (Debugger *debugger);
 static void debugger_stde_flush (Debugger *debugger);
 static void on_gdb_output_arrived (AnjutaLauncher *launcher,
 								   AnjutaLauncherOutputType output_type,
-								   const gchar *chars, gpointer data);
+								   const gchar * const *lines, guint n_lines,
+								   gpointer data);
 static void on_gdb_terminated (AnjutaLauncher *launcher,
 							   gint child_pid, gint status,
 							   gulong t, gpointer data);
@@ -1105,7 +1106,7 @@ debugger_start (Debugger *debugger,
 	anjuta_launcher_set_terminate_on_exit (launcher, TRUE);
 	g_signal_connect (G_OBJECT (launcher), "child-exited",
 					  G_CALLBACK (on_gdb_terminated), debugger);
-	ret = anjuta_launcher_execute_v (launcher,
+	ret = anjuta_launcher_execute_lines_v (launcher,
 		    						work_dir,
 		    						argv,
 		    						envp,
@@ -1173,59 +1174,45 @@ debugger_start (Debugger *debugger,
 }
 
 static void
-gdb_stdout_line_arrived (Debugger *debugger, const gchar * chars)
+gdb_stdout_line_arrived (Debugger *debugger, const gchar * line)
 {
-	gint i = 0;
-
-	while (chars[i])
-	{
-		if (chars[i] == '\n')
-		{
-			debugger_stdo_flush (debugger);
-		}
-		else
-		{
-			g_string_append_c (debugger->priv->stdo_line, chars[i]);
-		}
-		i++;
-	}
+	g_string_assign (debugger->priv->stdo_line, line);
+	debugger_stdo_flush (debugger);
 }
 
 static void
-gdb_stderr_line_arrived (Debugger *debugger, const gchar * chars)
+gdb_stderr_line_arrived (Debugger *debugger, const gchar * line)
 {
-	gint i;
-
-	for (i = 0; i < strlen (chars); i++)
-	{
-		if (chars[i] == '\n')
-			debugger_stde_flush (debugger);
-		else
-			g_string_append_c (debugger->priv->stde_line, chars[i]);
-	}
+	g_string_assign (debugger->priv->stde_line, line);
+	debugger_stde_flush (debugger);
 }
 
 static void
 on_gdb_output_arrived (AnjutaLauncher *launcher,
 					   AnjutaLauncherOutputType output_type,
-					   const gchar *chars, gpointer data)
+					   const gchar * const *lines, guint n_lines,
+					   gpointer data)
 {
 	Debugger *debugger = DEBUGGER (data);
+	guint i;
 	DEBUG_PRINT ("%s", "on gdb output arrived");
 
-	/* Do not emit signal when the debugger is destroyed */
-	if (debugger->priv->instance == NULL) return;
-
-	switch (output_type)
+	for (i = 0; i < n_lines; i++)
 	{
-	case ANJUTA_LAUNCHER_OUTPUT_STDERR:
-		gdb_stderr_line_arrived (debugger, chars);
-		break;
-	case ANJUTA_LAUNCHER_OUTPUT_STDOUT:
-		gdb_stdout_line_arrived (debugger, chars);
-		break;
-	default:
-		break;
+		/* Do not emit signal when the debugger is destroyed */
+		if (debugger->priv->instance == NULL) return;
+
+		switch (output_type)
+		{
+		case ANJUTA_LAUNCHER_OUTPUT_STDERR:
+			gdb_stderr_line_arrived (debugger, lines[i]);
+			break;
+		case ANJUTA_LAUNCHER_OUTPUT_STDOUT:
+			gdb_stdout_line_arrived (debugger, lines[i]);
+			break;
+		default:
+			break;
+		}
 	}
 }
 
@@ -87,75 +87,14 @@ git_command_multi_line_output_arrived (AnjutaLauncher *launcher,
 	}
 }
 
-/* Split the string up line by line. Works almost like g_strsplit, execpt the
- * newlines can be preserved. */
-static gchar **
-split_lines (const gchar *string, gboolean strip_newlines)
-{
-	GList *string_list;
-	gchar *string_pos;
-	const gchar *remainder;
-	gsize length;
-	guint n;
-	gchar **lines;
-	GList *current_line;
-	
-	string_list = NULL;
-	string_pos = strchr (string, '\n');
-	remainder = string;
-	n = 0;
-	
-	if (string_pos)
-	{
-		while (string_pos)
-		{	
-			if (strip_newlines)
-				length = (string_pos - remainder);
-			else /* Preserve newline */
-				length = ((string_pos + 1) - remainder);
-			
-			string_list = g_list_prepend (string_list, g_strndup (remainder,
-																  length));
-			string_pos++; /* Move on to next newline */
-			n++;
-			
-			remainder = string_pos;
-			string_pos = strchr (remainder, '\n');
-			
-		}
-	}
-	else
-	{
-		/* If there are no newlines in the string, just return a vector with
-		 * one line in it. */
-		string_list = g_list_prepend (string_list, g_strdup (string));
-		n++;
-	}
-	
-	lines = g_new (gchar *, n + 1);
-	lines[n--] = NULL;
-	
-	for (current_line = string_list; 
-		 current_line; 
-		 current_line = g_list_next (current_line))
-	{
-		lines[n--] = current_line->data;
-	}
-	
-	g_list_free (string_list);
-	
-	return lines;
-	
-}
-
 static void
 git_command_single_line_output_arrived (AnjutaLauncher *launcher, 
 										AnjutaLauncherOutputType output_type,
-										const gchar *chars, GitCommand *self)
+										const gchar * const *lines,
+										guint n_lines, GitCommand *self)
 {
 	void (*output_handler) (GitCommand *git_command, const gchar *output);
-	gchar **lines;
-	gchar **current_line;
+	guint i;
 	gchar *utf8_output;
 
 		
@@ -174,23 +113,28 @@ git_command_single_line_output_arrived (AnjutaLauncher *launcher,
 	
 	if (output_handler)
 	{
-		lines = split_lines (chars, self->priv->strip_newlines);
-		
-		for (current_line = lines; *current_line; current_line++)
+		/* The launcher has already split the output in lines */
+		for (i = 0; i < n_lines; i++)
 		{
-			utf8_output = g_locale_to_utf8 (*current_line, -1, NULL, NULL, 
-											NULL);
+			if (self->priv->strip_newlines)
+			{
+				utf8_output = g_locale_to_utf8 (lines[i], -1, NULL, NULL, 
+												NULL);
+			}
+			else /* Preserve newline */
+			{
+				gchar *line = g_strconcat (lines[i], "\n", NULL);
+
+				utf8_output = g_locale_to_utf8 (line, -1, NULL, NULL, NULL);
+				g_free (line);
+			}
 
 			if (utf8_output)
 			{
 				output_handler (self, utf8_output);
 				g_free (utf8_output);
 			}
-
-			
 		}
-		
-		g_strfreev (lines);
 	}
 }
 
@@ -200,7 +144,7 @@ git_command_launch (GitCommand *self)
 	gchar **args;
 	GList *current_arg;
 	gint i;
-	AnjutaLauncherOutputCallback callback;
+	gboolean ok;
 	
 	args = g_new0 (gchar *, self->priv->num_args + 2);
 	current_arg = self->priv->args;
@@ -216,16 +160,25 @@ git_command_launch (GitCommand *self)
 	}
 	
 	if (self->priv->single_line_output)
-		callback = (AnjutaLauncherOutputCallback) git_command_single_line_output_arrived;
+	{
+		ok = anjuta_launcher_execute_lines_v (self->priv->launcher,
+											  self->priv->working_directory,
+											  args,
+											  NULL,
+											  (AnjutaLauncherLinesCallback) git_command_single_line_output_arrived,
+											  self);
+	}
 	else
-		callback = (AnjutaLauncherOutputCallback) git_command_multi_line_output_arrived;
-
-	if (!anjuta_launcher_execute_v (self->priv->launcher,
-	    							self->priv->working_directory,
-									args,
-									NULL,
-									callback,
-									self))
+	{
+		ok = anjuta_launcher_execute_v (self->priv->launcher,
+										self->priv->working_directory,
+										args,
+										NULL,
+										(AnjutaLauncherOutputCallback) git_command_multi_line_output_arrived,
+										self);
+	}
+
+	if (!ok)
 	{
 		git_command_append_error (self, "Command execution failed.");
 		anjuta_command_notify_complete (ANJUTA_COMMAND (self), 1);
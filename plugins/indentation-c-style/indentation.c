@@ -21,6 +21,7 @@
 #include <config.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <string.h>
 #include <libanjuta/anjuta-debug.h>
 #include <libanjuta/anjuta-utils.h>
 #include <libanjuta/interfaces/ianjuta-iterable.h>
@@ -56,6 +57,32 @@
 #define CASE_INDENT (INDENT_SIZE)
 #define LABEL_INDENT (INDENT_SIZE)
 
+/* Interval between two saved line states */
+#define LINE_STATE_INTERVAL 32
+
+#define LEFT_BRACE(ch) (ch == ')'? '(' : (ch == '}'? '{' : (ch == ']'? '[' : ch)))
+
+/* Open brace */
+typedef struct
+{
+	gint offset;
+	gchar ch;
+} OpenBrace;
+
+/* Maximum length of a raw string delimiter */
+#define RAW_DELIMITER_SIZE 16
+
+/* Nesting state at the beginning of a line */
+typedef struct
+{
+	GArray *braces;
+	gboolean comment;
+	gchar quote;
+	gint disabled;		/* Nesting level inside a #if 0 block */
+	gboolean raw;		/* Inside a C++ raw string */
+	gchar delimiter[RAW_DELIMITER_SIZE + 1];
+} LineState;
+
 static gboolean
 iter_is_newline (IAnjutaIterable *iter, gchar ch)
 {
@@ -555,6 +582,334 @@ set_line_indentation (IAnjutaEditor *editor, gint line_num, gint indentation, gi
 	return nchars;
 }
 
+static LineState *
+line_state_new (void)
+{
+	LineState *state = g_slice_new0 (LineState);
+
+	state->braces = g_array_new (FALSE, FALSE, sizeof (OpenBrace));
+
+	return state;
+}
+
+static LineState *
+line_state_copy (const LineState *state)
+{
+	LineState *copy = g_slice_dup (LineState, state);
+
+	copy->braces = g_array_sized_new (FALSE, FALSE, sizeof (OpenBrace),
+	                                  state->braces->len);
+	g_array_append_vals (copy->braces, state->braces->data, state->braces->len);
+
+	return copy;
+}
+
+static void
+line_state_free (LineState *state)
+{
+	g_array_free (state->braces, TRUE);
+	g_slice_free (LineState, state);
+}
+
+/* Check if the text following a '#' is the preprocessor directive name,
+ * return its argument in arg */
+static gboolean
+is_directive (const gchar *ptr, const gchar *name, const gchar **arg)
+{
+	gsize len = strlen (name);
+
+	while (*ptr == ' ' || *ptr == '\t') ptr++;
+	if ((strncmp (ptr, name, len) != 0) ||
+	    g_ascii_isalnum (ptr[len]) || (ptr[len] == '_'))
+		return FALSE;
+	for (ptr += len; *ptr == ' ' || *ptr == '\t'; ptr++);
+	if (arg != NULL) *arg = ptr;
+
+	return TRUE;
+}
+
+/* Check if the R before a quote starts a raw string literal, it can have an
+ * encoding prefix */
+static gboolean
+is_raw_string (const gchar *text, const gchar *r)
+{
+	const gchar *start = r;
+
+	if ((start - text >= 2) && (start[-2] == 'u') && (start[-1] == '8'))
+		start -= 2;
+	else if ((start > text) && (start[-1] == 'u' || start[-1] == 'U' || start[-1] == 'L'))
+		start--;
+
+	return (start == text) || !(g_ascii_isalnum (start[-1]) || (start[-1] == '_'));
+}
+
+/* Update state with text starting at the character offset. Return TRUE
+ * if the end of the text is in a line comment. Like the highlighting, the
+ * text of #if 0 blocks and of raw strings is not code. */
+static gboolean
+line_state_scan (LineState *state, const gchar *text, gint offset)
+{
+	const gchar *ptr;
+	gboolean line_comment = FALSE;
+	gboolean escaped = FALSE;
+	gboolean line_start = TRUE;
+
+	for (ptr = text; *ptr != '\0'; ptr = g_utf8_next_char (ptr), offset++)
+	{
+		gchar c = *ptr;
+		const gchar *arg;
+		gint i;
+
+		if (state->comment)
+		{
+			if (c == '*' && ptr[1] == '/')
+			{
+				state->comment = FALSE;
+				ptr++;
+				offset++;
+			}
+			continue;
+		}
+		if (state->raw)
+		{
+			gsize len = strlen (state->delimiter);
+
+			/* Raw strings end with )delimiter" and can span lines */
+			if ((c == ')') && (strncmp (ptr + 1, state->delimiter, len) == 0) &&
+			    (ptr[len + 1] == '"'))
+			{
+				state->raw = FALSE;
+				ptr += len + 1;
+				offset += len + 1;
+			}
+			continue;
+		}
+		if (c == '\n')
+		{
+			/* Strings can be continued with a backslash */
+			if (!escaped)
+				state->quote = 0;
+			line_comment = FALSE;
+			escaped = FALSE;
+			line_start = TRUE;
+			continue;
+		}
+		if (state->disabled)
+		{
+			/* Look only for the end of the block */
+			if (line_start && (c == '#'))
+			{
+				if (is_directive (ptr + 1, "if", NULL) ||
+				    is_directive (ptr + 1, "ifdef", NULL) ||
+				    is_directive (ptr + 1, "ifndef", NULL))
+					state->disabled++;
+				else if (is_directive (ptr + 1, "endif", NULL))
+					state->disabled--;
+				else if ((state->disabled == 1) &&
+				         (is_directive (ptr + 1, "else", NULL) ||
+				          is_directive (ptr + 1, "elif", NULL)))
+					state->disabled = 0;
+			}
+			if (!g_ascii_isspace (c))
+				line_start = FALSE;
+			continue;
+		}
+		if (line_comment)
+			continue;
+		if (state->quote)
+		{
+			if (escaped)
+				escaped = FALSE;
+			else if (c == '\\')
+				escaped = TRUE;
+			else if (c == state->quote)
+				state->quote = 0;
+			continue;
+		}
+		if (line_start && (c == '#') &&
+		    is_directive (ptr + 1, "if", &arg) && (arg[0] == '0') &&
+		    !g_ascii_isalnum (arg[1]) && (arg[1] != '_'))
+		{
+			state->disabled = 1;
+		}
+		if (!g_ascii_isspace (c))
+			line_start = FALSE;
+
+		switch (c)
+		{
+			case '/':
+				if (ptr[1] == '/')
+				{
+					line_comment = TRUE;
+				}
+				else if (ptr[1] == '*')
+				{
+					state->comment = TRUE;
+					ptr++;
+					offset++;
+				}
+				break;
+			case '"':
+				if ((ptr > text) && (ptr[-1] == 'R') && is_raw_string (text, ptr - 1))
+				{
+					const gchar *open;
+
+					/* The delimiter is between the quote and the parenthesis */
+					for (open = ptr + 1; (*open != '\0') && (*open != '(') &&
+					     (open - ptr <= RAW_DELIMITER_SIZE); open++);
+					if (*open == '(')
+					{
+						state->raw = TRUE;
+						g_strlcpy (state->delimiter, ptr + 1, open - ptr);
+						offset += open - ptr;
+						ptr = open;
+						break;
+					}
+				}
+				state->quote = c;
+				break;
+			case '\'':
+				state->quote = c;
+				break;
+			case '{':
+			case '(':
+			case '[':
+			{
+				OpenBrace brace = {offset, c};
+				g_array_append_val (state->braces, brace);
+				break;
+			}
+			case '}':
+			case ')':
+			case ']':
+				/* Close the innermost matching brace, ignore the others */
+				for (i = state->braces->len - 1; i >= 0; i--)
+				{
+					if (g_array_index (state->braces, OpenBrace, i).ch == LEFT_BRACE (c))
+					{
+						g_array_set_size (state->braces, i);
+						break;
+					}
+				}
+				break;
+			default:
+				break;
+		}
+	}
+
+	return line_comment;
+}
+
+/* Get the state at the beginning of line, starting from the nearest saved
+ * state and saving new ones on the way */
+static LineState *
+get_line_state (IndentCPlugin *plugin, IAnjutaEditor *editor, gint line)
+{
+	LineState *state;
+	guint index;
+	gint state_line;
+
+	if (plugin->line_states == NULL)
+		plugin->line_states = g_ptr_array_new_with_free_func ((GDestroyNotify)line_state_free);
+	if (plugin->line_states->len == 0)
+		g_ptr_array_add (plugin->line_states, line_state_new ());
+
+	index = MIN ((line - 1) / LINE_STATE_INTERVAL, plugin->line_states->len - 1);
+	state = line_state_copy (g_ptr_array_index (plugin->line_states, index));
+	state_line = index * LINE_STATE_INTERVAL + 1;
+
+	while (state_line < line)
+	{
+		IAnjutaIterable *begin;
+		IAnjutaIterable *end;
+		gint end_line;
+		gchar *text;
+
+		end_line = MIN (state_line + LINE_STATE_INTERVAL, line);
+		begin = ianjuta_editor_get_line_begin_position (editor, state_line, NULL);
+		end = ianjuta_editor_get_line_begin_position (editor, end_line, NULL);
+		text = ianjuta_editor_get_text (editor, begin, end, NULL);
+		if (text != NULL)
+			line_state_scan (state, text, ianjuta_iterable_get_position (begin, NULL));
+		g_free (text);
+		g_object_unref (begin);
+		g_object_unref (end);
+
+		state_line = end_line;
+		if ((state_line - 1) == plugin->line_states->len * LINE_STATE_INTERVAL)
+			g_ptr_array_add (plugin->line_states, line_state_copy (state));
+	}
+
+	return state;
+}
+
+/* Move iter from the closing brace to the matching one using the saved
+ * line states instead of reading the text backward */
+static gboolean
+jump_to_matching_brace (IndentCPlugin *plugin, IAnjutaEditor *editor,
+                        IAnjutaIterable *iter, gchar brace)
+{
+	LineState *state;
+	IAnjutaIterable *begin;
+	gboolean line_comment = FALSE;
+	gboolean found = FALSE;
+	gchar *text;
+	gint line;
+	gint i;
+
+	line = ianjuta_editor_get_line_from_position (editor, iter, NULL);
+	state = get_line_state (plugin, editor, line);
+	begin = ianjuta_editor_get_line_begin_position (editor, line, NULL);
+	text = ianjuta_editor_get_text (editor, begin, iter, NULL);
+	if (text != NULL)
+		line_comment = line_state_scan (state, text,
+		                                ianjuta_iterable_get_position (begin, NULL));
+	g_free (text);
+	g_object_unref (begin);
+
+	if (line_comment || state->comment || state->quote || state->raw || state->disabled)
+	{
+		/* The brace is not code, do it like before */
+		line_state_free (state);
+		return anjuta_util_jump_to_matching_brace (iter, brace, -1);
+	}
+
+	for (i = state->braces->len - 1; i >= 0; i--)
+	{
+		OpenBrace *open = &g_array_index (state->braces, OpenBrace, i);
+
+		if (open->ch == LEFT_BRACE (brace))
+		{
+			ianjuta_iterable_set_position (iter, open->offset, NULL);
+			found = TRUE;
+			break;
+		}
+	}
+	if (!found)
+		ianjuta_iterable_first (iter, NULL);
+	line_state_free (state);
+
+	return found;
+}
+
+void
+cpp_line_states_invalidate (IndentCPlugin *plugin, gint line)
+{
+	guint valid = line > 0 ? (line - 1) / LINE_STATE_INTERVAL + 1 : 0;
+
+	if ((plugin->line_states != NULL) && (valid < plugin->line_states->len))
+		g_ptr_array_remove_range (plugin->line_states, valid,
+		                          plugin->line_states->len - valid);
+}
+
+void
+cpp_line_states_free (IndentCPlugin *plugin)
+{
+	if (plugin->line_states != NULL)
+		g_ptr_array_free (plugin->line_states, TRUE);
+	plugin->line_states = NULL;
+}
+
 /*  incomplete_statement:
  *  1 == COMPLETE STATEMENT
  *  0 == INCOMPLETE STATEMENT
@@ -807,7 +1162,7 @@ get_line_indentation_base (IndentCPlugin *plugin,
 			}
 
 			/* Find matching brace and continue */
-			if (!anjuta_util_jump_to_matching_brace (iter, point_ch, -1))
+			if (!jump_to_matching_brace (plugin, editor, iter, point_ch))
 			{
 				line_indent = get_line_indentation (editor, line_saved);
 				line_indent += extra_indent;
@@ -1138,8 +1493,7 @@ get_line_auto_indentation (IndentCPlugin *plugin, IAnjutaEditor *editor,
 		}
 		else if (ch == '}')
 		{
-			ianjuta_iterable_previous (iter, NULL);
-			if (anjuta_util_jump_to_matching_brace (iter, ch, -1))
+			if (jump_to_matching_brace (plugin, editor, iter, ch))
 			{
 				gint line = ianjuta_editor_get_line_from_position (editor,
 																   iter,
@@ -1190,6 +1544,11 @@ cpp_indentation (IAnjutaEditor *editor,
 
 	iter = ianjuta_iterable_clone (insert_pos, NULL);
 
+	/* "char-added" is emitted before "changed", the added character
+	 * is already in the editor */
+	cpp_line_states_invalidate (plugin,
+	                            ianjuta_editor_get_line_from_position (editor, iter, NULL));
+
 	/* If autoindent is enabled*/
 	if (plugin->smart_indentation)
 	{
@@ -37,3 +37,10 @@ java_indentation (IAnjutaEditor *editor,
                   IAnjutaIterable *insert_pos,
                   gchar ch,
                   IndentCPlugin *plugin);
+
+void
+cpp_line_states_invalidate (IndentCPlugin *plugin,
+                            gint line);
+
+void
+cpp_line_states_free (IndentCPlugin *plugin);
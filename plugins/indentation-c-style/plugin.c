@@ -325,6 +325,15 @@ initialize_indentation_params (IndentCPlugin *plugin)
     }
 }
 
+static void
+on_editor_changed (IAnjutaEditor *editor, IAnjutaIterable *position,
+                   gboolean added, gint length, gint lines,
+                   const gchar *text, IndentCPlugin *plugin)
+{
+    cpp_line_states_invalidate (plugin,
+                                ianjuta_editor_get_line_from_position (editor, position, NULL));
+}
+
 /* Enable/Disable language-support */
 static void
 install_support (IndentCPlugin *lang_plugin)
@@ -369,6 +378,12 @@ install_support (IndentCPlugin *lang_plugin)
         return;
     }
 
+    /* Keep the saved brace nesting up to date */
+    g_signal_connect (lang_plugin->current_editor,
+                      "changed",
+                      G_CALLBACK (on_editor_changed),
+                      lang_plugin);
+
     initialize_indentation_params (lang_plugin);
     lang_plugin->support_installed = TRUE;
 }
@@ -395,6 +410,10 @@ uninstall_support (IndentCPlugin *lang_plugin)
                                     G_CALLBACK (java_indentation),
                                     lang_plugin);
     }
+    g_signal_handlers_disconnect_by_func (lang_plugin->current_editor,
+                                          G_CALLBACK (on_editor_changed),
+                                          lang_plugin);
+    cpp_line_states_free (lang_plugin);
     
     lang_plugin->support_installed = FALSE;
 }
@@ -559,6 +578,7 @@ indent_c_plugin_dispose (GObject *obj)
 
     g_object_unref (plugin->settings);
     g_object_unref (plugin->editor_settings);
+    cpp_line_states_free (plugin);
 
     G_OBJECT_CLASS (parent_class)->dispose (obj);
 }
@@ -571,6 +591,7 @@ indent_c_plugin_instance_init (GObject *obj)
     plugin->current_language = NULL;
     plugin->editor_watch_id = 0;
     plugin->uiid = 0;
+    plugin->line_states = NULL;
     plugin->settings = g_settings_new (PREF_SCHEMA);
     plugin->editor_settings = g_settings_new (ANJUTA_PREF_SCHEMA_PREFIX IANJUTA_EDITOR_PREF_SCHEMA);
 }
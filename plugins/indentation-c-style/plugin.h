@@ -58,6 +58,9 @@ struct _IndentCPlugin {
 	gint param_label_indentation;
 	gboolean smart_indentation;
 
+	/* Brace nesting state every few lines of the current editor */
+	GPtrArray *line_states;
+
 	/* Preferences */
 	GtkBuilder* bxml;
 };
@@ -0,0 +1,174 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * message-store-bench.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "message-store.h"
+
+/* Append a lot of messages by bursts, like a fast build, and measure how long
+ * it takes to get them in the model and how long the main loop is blocked.
+ * The messages are displayed in a tree view if a display is available.
+ *
+ * Usage: message-store-bench [number of messages] [messages per burst]
+ *---------------------------------------------------------------------------*/
+
+/* Period of the main loop latency probe in ms */
+#define PROBE_INTERVAL 10
+
+typedef struct
+{
+	MessageStore *store;
+	GMainLoop *loop;
+	guint total;
+	guint burst;
+	guint appended;
+	gint64 start;
+	gint64 appended_time;
+
+	/* Latency probe */
+	gint64 last_probe;
+	gint64 max_latency;
+	gint64 sum_latency;
+	guint probes;
+} Bench;
+
+static gboolean
+on_append_burst (gpointer user_data)
+{
+	Bench *bench = (Bench *)user_data;
+	guint end;
+
+	end = MIN (bench->appended + bench->burst, bench->total);
+	for (; bench->appended < end; bench->appended++)
+	{
+		IAnjutaMessageViewType type;
+		gchar *summary;
+
+		if (bench->appended % 100 == 0)
+			type = IANJUTA_MESSAGE_VIEW_TYPE_ERROR;
+		else if (bench->appended % 10 == 0)
+			type = IANJUTA_MESSAGE_VIEW_TYPE_WARNING;
+		else
+			type = IANJUTA_MESSAGE_VIEW_TYPE_NORMAL;
+		summary = g_strdup_printf ("source%u.c:%u: compiling <%u>", bench->appended / 100, bench->appended % 100, bench->appended);
+		message_store_append (bench->store, type, summary, type == IANJUTA_MESSAGE_VIEW_TYPE_NORMAL ? NULL : summary);
+		g_free (summary);
+	}
+
+	if (bench->appended < bench->total) return TRUE;
+
+	bench->appended_time = g_get_monotonic_time ();
+
+	return FALSE;
+}
+
+static gboolean
+on_probe (gpointer user_data)
+{
+	Bench *bench = (Bench *)user_data;
+	gint64 now = g_get_monotonic_time ();
+	gint64 latency;
+
+	latency = now - bench->last_probe - PROBE_INTERVAL * 1000;
+	if (latency < 0) latency = 0;
+	bench->last_probe = now;
+	bench->max_latency = MAX (bench->max_latency, latency);
+	bench->sum_latency += latency;
+	bench->probes++;
+
+	if ((bench->appended == bench->total) &&
+	    (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (bench->store), NULL) == bench->total))
+	{
+		g_main_loop_quit (bench->loop);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void
+create_view (MessageStore *store)
+{
+	GtkWidget *window;
+	GtkWidget *scrolled_win;
+	GtkWidget *tree_view;
+	GtkCellRenderer *renderer;
+	GtkTreeViewColumn *column;
+
+	tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+	gtk_tree_view_set_headers_visible (GTK_TREE_VIEW (tree_view), FALSE);
+
+	renderer = gtk_cell_renderer_pixbuf_new ();
+	column = gtk_tree_view_column_new_with_attributes (NULL, renderer, "stock-id", COLUMN_PIXBUF, NULL);
+	gtk_tree_view_append_column (GTK_TREE_VIEW (tree_view), column);
+
+	renderer = gtk_cell_renderer_text_new ();
+	column = gtk_tree_view_column_new_with_attributes (NULL, renderer, "foreground", COLUMN_COLOR, "markup", COLUMN_SUMMARY, NULL);
+	gtk_tree_view_append_column (GTK_TREE_VIEW (tree_view), column);
+
+	scrolled_win = gtk_scrolled_window_new (NULL, NULL);
+	gtk_container_add (GTK_CONTAINER (scrolled_win), tree_view);
+
+	window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+	gtk_window_set_default_size (GTK_WINDOW (window), 600, 400);
+	gtk_container_add (GTK_CONTAINER (window), scrolled_win);
+	gtk_widget_show_all (window);
+}
+
+int
+main(int argc, char *argv[])
+{
+	Bench bench = {0};
+	gboolean display;
+
+	/* Initialize program */
+	g_type_init ();
+	display = gtk_init_check (&argc, &argv);
+
+	bench.total = argc > 1 ? atoi (argv[1]) : 1000000;
+	bench.burst = argc > 2 ? atoi (argv[2]) : 1000;
+	if (bench.burst == 0) bench.burst = 1;
+
+	bench.store = message_store_new ();
+	message_store_set_highlite (bench.store, TRUE);
+	message_store_set_color (bench.store, IANJUTA_MESSAGE_VIEW_TYPE_WARNING, "#00FF00");
+	message_store_set_color (bench.store, IANJUTA_MESSAGE_VIEW_TYPE_ERROR, "#FF0000");
+	if (display) create_view (bench.store);
+
+	bench.loop = g_main_loop_new (NULL, FALSE);
+	bench.start = g_get_monotonic_time ();
+	bench.last_probe = bench.start;
+	g_idle_add (on_append_burst, &bench);
+	g_timeout_add (PROBE_INTERVAL, on_probe, &bench);
+	g_main_loop_run (bench.loop);
+
+	fprintf (stdout, "append %u messages by %u%s: %g s\n", bench.total, bench.burst, display ? "" : " (no display)", (bench.appended_time - bench.start) / 1e6);
+	fprintf (stdout, "all messages in model: %g s\n", (g_get_monotonic_time () - bench.start) / 1e6);
+	fprintf (stdout, "main loop latency: max %g ms, mean %g ms\n", bench.max_latency / 1e3, bench.probes == 0 ? 0.0 : bench.sum_latency / 1e3 / bench.probes);
+	fprintf (stdout, "errors %d, warnings %d, messages %d\n",
+	         message_store_get_count (bench.store, IANJUTA_MESSAGE_VIEW_TYPE_ERROR),
+	         message_store_get_count (bench.store, IANJUTA_MESSAGE_VIEW_TYPE_WARNING),
+	         message_store_get_count (bench.store, IANJUTA_MESSAGE_VIEW_TYPE_NORMAL));
+
+	g_main_loop_unref (bench.loop);
+	g_object_unref (bench.store);
+
+	return 0;
+}
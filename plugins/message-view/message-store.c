@@ -0,0 +1,863 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * message-store.c
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <glib/gstdio.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "message-store.h"
+
+/* Number of messages allocated at once */
+#define MESSAGE_STORE_CHUNK_SIZE	1024
+
+/* Number of messages read back from the temporary file kept in memory */
+#define MESSAGE_STORE_RELOADED		256
+
+/* Number of message types having a filter flag, a color and an icon */
+#define MESSAGE_STORE_N_TYPES		4
+
+/* Length written for a NULL string in the temporary file */
+#define MESSAGE_STORE_NULL_LENGTH	G_MAXUINT32
+
+/* Delay in ms before adding new messages in the model, about one frame */
+#define MESSAGE_STORE_FLUSH_INTERVAL	16
+
+/* Maximum number of messages added in the model at once, to keep the main
+ * loop responsive */
+#define MESSAGE_STORE_FLUSH_MAX		20000
+
+enum
+{
+	FLUSHED,
+	LAST_SIGNAL
+};
+
+static guint message_store_signals[LAST_SIGNAL] = { 0 };
+
+typedef struct
+{
+	Message message;
+	goffset offset;			/* Position in the temporary file or -1 */
+} MessageEntry;
+
+struct _MessageStorePrivate
+{
+	/* Messages, the chunks are never moved so entries keep their address */
+	GPtrArray *chunks;
+	guint n_messages;
+
+	/* Messages after this one are not in the model yet */
+	guint n_flushed;
+	guint flush_id;
+
+	/* Index of the messages displayed, row number is the position in this
+	 * array */
+	GArray *visible;
+	guint filter;
+	gint stamp;
+
+	/* Number of messages of each type in the model */
+	gint counts[MESSAGE_STORE_N_TYPES];
+
+	/* Appearance, the colors are interned strings */
+	gboolean highlite;
+	const gchar *colors[MESSAGE_STORE_N_TYPES];
+
+	/* Messages moved to a temporary file */
+	guint max_resident;
+	guint first_resident;
+	FILE *spill;
+	GQueue *reloaded;
+};
+
+static const gchar *message_store_stock_ids[MESSAGE_STORE_N_TYPES] = {
+	NULL,
+	GTK_STOCK_INFO,
+	/* FIXME: There is no GTK_STOCK_WARNING which would fit better here */
+	GTK_STOCK_DIALOG_WARNING,
+	GTK_STOCK_STOP
+};
+
+static void message_store_tree_model_init (GtkTreeModelIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (MessageStore, message_store, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_TREE_MODEL,
+                                                message_store_tree_model_init))
+
+/* Message entries
+ *---------------------------------------------------------------------------*/
+
+static MessageEntry *
+message_store_get_entry (MessageStore *store, guint index)
+{
+	MessageEntry *chunk;
+
+	chunk = (MessageEntry *)g_ptr_array_index (store->priv->chunks, index / MESSAGE_STORE_CHUNK_SIZE);
+
+	return &chunk[index % MESSAGE_STORE_CHUNK_SIZE];
+}
+
+static gboolean
+message_store_is_visible (MessageStore *store, IAnjutaMessageViewType type)
+{
+	if ((type < 0) || (type >= MESSAGE_STORE_N_TYPES)) return TRUE;
+
+	return (store->priv->filter & (1 << type)) != 0;
+}
+
+static void
+message_store_free_entry (MessageEntry *entry)
+{
+	g_free (entry->message.summary);
+	entry->message.summary = NULL;
+	g_free (entry->message.details);
+	entry->message.details = NULL;
+}
+
+/* Temporary file
+ *---------------------------------------------------------------------------*/
+
+static gboolean
+message_store_write_string (FILE *file, const gchar *str)
+{
+	guint32 length = str == NULL ? MESSAGE_STORE_NULL_LENGTH : strlen (str);
+
+	if (fwrite (&length, sizeof (length), 1, file) != 1) return FALSE;
+	if (str == NULL) return TRUE;
+
+	return fwrite (str, 1, length, file) == length;
+}
+
+static gboolean
+message_store_read_string (FILE *file, gchar **str)
+{
+	guint32 length;
+
+	*str = NULL;
+	if (fread (&length, sizeof (length), 1, file) != 1) return FALSE;
+	if (length == MESSAGE_STORE_NULL_LENGTH) return TRUE;
+
+	*str = g_malloc (length + 1);
+	if (fread (*str, 1, length, file) != length)
+	{
+		g_free (*str);
+		*str = NULL;
+		return FALSE;
+	}
+	(*str)[length] = '\0';
+
+	return TRUE;
+}
+
+static gboolean
+message_store_open_spill (MessageStore *store)
+{
+	gchar *filename;
+	gint fd;
+
+	if (store->priv->spill != NULL) return TRUE;
+
+	fd = g_file_open_tmp ("anjuta-messages-XXXXXX", &filename, NULL);
+	if (fd == -1) return FALSE;
+
+	/* The file is only accessed through the descriptor */
+	g_unlink (filename);
+	g_free (filename);
+
+	store->priv->spill = fdopen (fd, "w+b");
+	if (store->priv->spill == NULL)
+	{
+		close (fd);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* Move the oldest messages in the temporary file until the number of messages
+ * in memory is below the limit */
+static void
+message_store_spill (MessageStore *store)
+{
+	MessageStorePrivate *priv = store->priv;
+
+	if (priv->max_resident == 0) return;
+
+	while (priv->n_messages - priv->first_resident > priv->max_resident)
+	{
+		MessageEntry *entry = message_store_get_entry (store, priv->first_resident);
+
+		if (!message_store_open_spill (store)) break;
+
+		if (fseeko (priv->spill, 0, SEEK_END) != 0) break;
+		entry->offset = ftello (priv->spill);
+		if (!message_store_write_string (priv->spill, entry->message.summary) ||
+		    !message_store_write_string (priv->spill, entry->message.details))
+		{
+			/* Keep the message in memory */
+			entry->offset = -1;
+			break;
+		}
+		message_store_free_entry (entry);
+		priv->first_resident++;
+	}
+}
+
+/* Read back a message written in the temporary file. Only the last read
+ * messages are kept in memory. */
+static void
+message_store_reload (MessageStore *store, guint index)
+{
+	MessageStorePrivate *priv = store->priv;
+	MessageEntry *entry = message_store_get_entry (store, index);
+
+	if ((index >= priv->first_resident) || (entry->message.summary != NULL) || (entry->offset < 0)) return;
+
+	if ((fseeko (priv->spill, entry->offset, SEEK_SET) != 0) ||
+	    !message_store_read_string (priv->spill, &entry->message.summary) ||
+	    !message_store_read_string (priv->spill, &entry->message.details))
+	{
+		message_store_free_entry (entry);
+		entry->message.summary = g_strdup ("");
+	}
+
+	g_queue_push_tail (priv->reloaded, GUINT_TO_POINTER (index));
+	if (g_queue_get_length (priv->reloaded) > MESSAGE_STORE_RELOADED)
+	{
+		guint old = GPOINTER_TO_UINT (g_queue_pop_head (priv->reloaded));
+
+		message_store_free_entry (message_store_get_entry (store, old));
+	}
+}
+
+static void
+message_store_close_spill (MessageStore *store)
+{
+	g_queue_clear (store->priv->reloaded);
+	if (store->priv->spill != NULL)
+	{
+		fclose (store->priv->spill);
+		store->priv->spill = NULL;
+	}
+	store->priv->first_resident = 0;
+}
+
+/* GtkTreeModel implementation
+ *---------------------------------------------------------------------------*/
+
+static GtkTreeModelFlags
+message_store_get_flags (GtkTreeModel *tree_model)
+{
+	return GTK_TREE_MODEL_LIST_ONLY;
+}
+
+static gint
+message_store_get_n_columns (GtkTreeModel *tree_model)
+{
+	return N_COLUMNS;
+}
+
+static GType
+message_store_get_column_type (GtkTreeModel *tree_model, gint index)
+{
+	switch (index)
+	{
+	case COLUMN_COLOR:
+	case COLUMN_SUMMARY:
+	case COLUMN_PIXBUF:
+		return G_TYPE_STRING;
+	case COLUMN_MESSAGE:
+		return G_TYPE_POINTER;
+	default:
+		g_return_val_if_reached (G_TYPE_INVALID);
+	}
+}
+
+static gboolean
+message_store_get_iter (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                        GtkTreePath *path)
+{
+	MessageStore *store = MESSAGE_STORE (tree_model);
+	gint row;
+
+	if (gtk_tree_path_get_depth (path) != 1) return FALSE;
+
+	row = gtk_tree_path_get_indices (path)[0];
+	if ((row < 0) || (row >= store->priv->visible->len)) return FALSE;
+
+	iter->stamp = store->priv->stamp;
+	iter->user_data = GINT_TO_POINTER (row);
+
+	return TRUE;
+}
+
+static GtkTreePath *
+message_store_get_path (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	g_return_val_if_fail (iter->stamp == MESSAGE_STORE (tree_model)->priv->stamp, NULL);
+
+	return gtk_tree_path_new_from_indices (GPOINTER_TO_INT (iter->user_data), -1);
+}
+
+static void
+message_store_get_value (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                         gint column, GValue *value)
+{
+	MessageStore *store = MESSAGE_STORE (tree_model);
+	const Message *message;
+	gboolean known;
+
+	message = message_store_get_message (store, iter);
+	g_return_if_fail (message != NULL);
+
+	g_value_init (value, message_store_get_column_type (tree_model, column));
+	known = store->priv->highlite && (message->type >= 0) && (message->type < MESSAGE_STORE_N_TYPES);
+
+	switch (column)
+	{
+	case COLUMN_COLOR:
+		if (known) g_value_set_static_string (value, store->priv->colors[message->type]);
+		break;
+	case COLUMN_SUMMARY:
+		/* The markup is created only when the row is displayed */
+		if (message->details && (*message->details != '\0'))
+		{
+			g_value_take_string (value, g_markup_printf_escaped ("<b>%s</b>", message->summary));
+		}
+		else
+		{
+			g_value_take_string (value, g_markup_escape_text (message->summary, -1));
+		}
+		break;
+	case COLUMN_MESSAGE:
+		g_value_set_pointer (value, (gpointer)message);
+		break;
+	case COLUMN_PIXBUF:
+		if (known) g_value_set_static_string (value, message_store_stock_ids[message->type]);
+		break;
+	}
+}
+
+static gboolean
+message_store_iter_nth_child (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                              GtkTreeIter *parent, gint n)
+{
+	MessageStore *store = MESSAGE_STORE (tree_model);
+
+	if ((parent != NULL) || (n < 0) || (n >= store->priv->visible->len)) return FALSE;
+
+	iter->stamp = store->priv->stamp;
+	iter->user_data = GINT_TO_POINTER (n);
+
+	return TRUE;
+}
+
+static gboolean
+message_store_iter_next (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	MessageStore *store = MESSAGE_STORE (tree_model);
+	gint row;
+
+	g_return_val_if_fail (iter->stamp == store->priv->stamp, FALSE);
+
+	row = GPOINTER_TO_INT (iter->user_data) + 1;
+	if (row >= store->priv->visible->len)
+	{
+		iter->stamp = 0;
+		return FALSE;
+	}
+	iter->user_data = GINT_TO_POINTER (row);
+
+	return TRUE;
+}
+
+static gboolean
+message_store_iter_children (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                             GtkTreeIter *parent)
+{
+	return message_store_iter_nth_child (tree_model, iter, parent, 0);
+}
+
+static gboolean
+message_store_iter_has_child (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	return FALSE;
+}
+
+static gint
+message_store_iter_n_children (GtkTreeModel *tree_model, GtkTreeIter *iter)
+{
+	return iter == NULL ? MESSAGE_STORE (tree_model)->priv->visible->len : 0;
+}
+
+static gboolean
+message_store_iter_parent (GtkTreeModel *tree_model, GtkTreeIter *iter,
+                           GtkTreeIter *child)
+{
+	return FALSE;
+}
+
+static void
+message_store_tree_model_init (GtkTreeModelIface *iface)
+{
+	iface->get_flags = message_store_get_flags;
+	iface->get_n_columns = message_store_get_n_columns;
+	iface->get_column_type = message_store_get_column_type;
+	iface->get_iter = message_store_get_iter;
+	iface->get_path = message_store_get_path;
+	iface->get_value = message_store_get_value;
+	iface->iter_next = message_store_iter_next;
+	iface->iter_children = message_store_iter_children;
+	iface->iter_has_child = message_store_iter_has_child;
+	iface->iter_n_children = message_store_iter_n_children;
+	iface->iter_nth_child = message_store_iter_nth_child;
+	iface->iter_parent = message_store_iter_parent;
+}
+
+/* Private functions
+ *---------------------------------------------------------------------------*/
+
+/* Remove all rows, starting from the end so the row numbers of the remaining
+ * rows do not change */
+static void
+message_store_remove_rows (MessageStore *store)
+{
+	GArray *visible = store->priv->visible;
+
+	while (visible->len > 0)
+	{
+		GtkTreePath *path;
+
+		g_array_set_size (visible, visible->len - 1);
+		path = gtk_tree_path_new_from_indices (visible->len, -1);
+		gtk_tree_model_row_deleted (GTK_TREE_MODEL (store), path);
+		gtk_tree_path_free (path);
+	}
+	store->priv->stamp++;
+}
+
+static void
+message_store_insert_row (MessageStore *store, guint index)
+{
+	GtkTreePath *path;
+	GtkTreeIter iter;
+
+	g_array_append_val (store->priv->visible, index);
+
+	iter.stamp = store->priv->stamp;
+	iter.user_data = GINT_TO_POINTER (store->priv->visible->len - 1);
+	path = gtk_tree_path_new_from_indices (store->priv->visible->len - 1, -1);
+	gtk_tree_model_row_inserted (GTK_TREE_MODEL (store), path, &iter);
+	gtk_tree_path_free (path);
+}
+
+/* Add up to max pending messages in the model, return the number of messages
+ * added */
+static guint
+message_store_flush_pending (MessageStore *store, guint max)
+{
+	MessageStorePrivate *priv = store->priv;
+	guint start = priv->n_flushed;
+	guint end;
+
+	end = priv->n_messages - start > max ? start + max : priv->n_messages;
+	while (priv->n_flushed < end)
+	{
+		guint index = priv->n_flushed;
+		IAnjutaMessageViewType type = message_store_get_entry (store, index)->message.type;
+
+		/* Update the counter before emitting the signal, so the model is
+		 * consistent if a handler reads it */
+		priv->n_flushed++;
+		if (message_store_is_visible (store, type)) message_store_insert_row (store, index);
+	}
+
+	return end - start;
+}
+
+static gboolean
+on_message_store_flush (gpointer user_data)
+{
+	MessageStore *store = MESSAGE_STORE (user_data);
+
+	message_store_flush_pending (store, MESSAGE_STORE_FLUSH_MAX);
+	if (store->priv->n_flushed < store->priv->n_messages) return TRUE;
+
+	store->priv->flush_id = 0;
+	g_signal_emit (store, message_store_signals[FLUSHED], 0);
+
+	return FALSE;
+}
+
+static void
+message_store_cancel_flush (MessageStore *store)
+{
+	if (store->priv->flush_id != 0)
+	{
+		g_source_remove (store->priv->flush_id);
+		store->priv->flush_id = 0;
+	}
+}
+
+/* Public functions
+ *---------------------------------------------------------------------------*/
+
+/**
+ * message_store_append:
+ * @store: a #MessageStore object.
+ * @type: type of the message
+ * @summary: short message
+ * @details: complete message or %NULL
+ *
+ * Add a message at the end of the store. The model is not updated
+ * immediately: all messages appended during the same frame are added
+ * together later or when calling message_store_flush(). A new row is created
+ * only if the message type is in the filter.
+ */
+void
+message_store_append (MessageStore *store, IAnjutaMessageViewType type,
+                      const gchar *summary, const gchar *details)
+{
+	MessageStorePrivate *priv;
+	MessageEntry *entry;
+	guint index;
+
+	g_return_if_fail (MESSAGE_IS_STORE (store));
+
+	priv = store->priv;
+	index = priv->n_messages;
+	if (index % MESSAGE_STORE_CHUNK_SIZE == 0)
+	{
+		if (index / MESSAGE_STORE_CHUNK_SIZE == priv->chunks->len)
+		{
+			g_ptr_array_add (priv->chunks, g_new (MessageEntry, MESSAGE_STORE_CHUNK_SIZE));
+		}
+	}
+	priv->n_messages++;
+
+	entry = message_store_get_entry (store, index);
+	entry->message.type = type;
+	entry->message.summary = g_strdup (summary != NULL ? summary : "");
+	entry->message.details = g_strdup (details);
+	entry->offset = -1;
+
+	/* Count pending messages too, the counters are displayed right away */
+	if ((type >= 0) && (type < MESSAGE_STORE_N_TYPES)) priv->counts[type]++;
+
+	message_store_spill (store);
+
+	if (priv->flush_id == 0)
+	{
+		priv->flush_id = g_timeout_add (MESSAGE_STORE_FLUSH_INTERVAL, on_message_store_flush, store);
+	}
+}
+
+/**
+ * message_store_flush:
+ * @store: a #MessageStore object.
+ *
+ * Add all pending messages in the model now.
+ *
+ * Return value: The number of messages added.
+ */
+guint
+message_store_flush (MessageStore *store)
+{
+	guint added;
+
+	g_return_val_if_fail (MESSAGE_IS_STORE (store), 0);
+
+	message_store_cancel_flush (store);
+	added = message_store_flush_pending (store, G_MAXUINT);
+	if (added != 0) g_signal_emit (store, message_store_signals[FLUSHED], 0);
+
+	return added;
+}
+
+/**
+ * message_store_clear:
+ * @store: a #MessageStore object.
+ *
+ * Remove all messages.
+ */
+void
+message_store_clear (MessageStore *store)
+{
+	MessageStorePrivate *priv;
+	guint i;
+
+	g_return_if_fail (MESSAGE_IS_STORE (store));
+
+	priv = store->priv;
+	message_store_cancel_flush (store);
+	message_store_remove_rows (store);
+
+	for (i = 0; i < priv->n_messages; i++)
+	{
+		message_store_free_entry (message_store_get_entry (store, i));
+	}
+	priv->n_messages = 0;
+	priv->n_flushed = 0;
+	memset (priv->counts, 0, sizeof (priv->counts));
+
+	/* Keep the first chunk for the next messages */
+	if (priv->chunks->len > 1) g_ptr_array_set_size (priv->chunks, 1);
+
+	message_store_close_spill (store);
+
+	/* Pending messages are dropped */
+	g_signal_emit (store, message_store_signals[FLUSHED], 0);
+}
+
+/**
+ * message_store_get_message:
+ * @store: a #MessageStore object.
+ * @iter: a valid #GtkTreeIter for this store
+ *
+ * Get the message displayed in a row. If the message has been moved to the
+ * temporary file, it is read back.
+ *
+ * Return value: The message owned by the store. It stays valid until the
+ * store is cleared, but its strings can be released after reading other
+ * messages written in the temporary file, so they have to be copied to be
+ * kept.
+ */
+const Message *
+message_store_get_message (MessageStore *store, GtkTreeIter *iter)
+{
+	guint row;
+
+	g_return_val_if_fail (MESSAGE_IS_STORE (store), NULL);
+	g_return_val_if_fail (iter->stamp == store->priv->stamp, NULL);
+
+	row = GPOINTER_TO_UINT (iter->user_data);
+	g_return_val_if_fail (row < store->priv->visible->len, NULL);
+
+	return message_store_get_nth_message (store, g_array_index (store->priv->visible, guint, row));
+}
+
+/**
+ * message_store_get_n_messages:
+ * @store: a #MessageStore object.
+ *
+ * Return value: The number of messages, including the hidden ones and the
+ * ones not yet in the model.
+ */
+guint
+message_store_get_n_messages (MessageStore *store)
+{
+	g_return_val_if_fail (MESSAGE_IS_STORE (store), 0);
+
+	return store->priv->n_messages;
+}
+
+/**
+ * message_store_get_nth_message:
+ * @store: a #MessageStore object.
+ * @index: position of the message, including the hidden ones
+ *
+ * Get a message even if it is not visible, see message_store_get_message().
+ *
+ * Return value: The message owned by the store.
+ */
+const Message *
+message_store_get_nth_message (MessageStore *store, guint index)
+{
+	g_return_val_if_fail (MESSAGE_IS_STORE (store), NULL);
+	g_return_val_if_fail (index < store->priv->n_messages, NULL);
+
+	message_store_reload (store, index);
+
+	return &message_store_get_entry (store, index)->message;
+}
+
+/**
+ * message_store_set_filter:
+ * @store: a #MessageStore object.
+ * @types: bit mask of visible message types, bit n is for type n
+ *
+ * Change the visible messages. All rows are removed and created again, so it
+ * is faster to detach the store from its view while doing this.
+ */
+void
+message_store_set_filter (MessageStore *store, guint types)
+{
+	MessageStorePrivate *priv;
+	guint i;
+
+	g_return_if_fail (MESSAGE_IS_STORE (store));
+
+	priv = store->priv;
+	if (priv->filter == types) return;
+
+	message_store_flush (store);
+	message_store_remove_rows (store);
+	priv->filter = types;
+	for (i = 0; i < priv->n_flushed; i++)
+	{
+		if (message_store_is_visible (store, message_store_get_entry (store, i)->message.type))
+		{
+			message_store_insert_row (store, i);
+		}
+	}
+}
+
+guint
+message_store_get_filter (MessageStore *store)
+{
+	g_return_val_if_fail (MESSAGE_IS_STORE (store), 0);
+
+	return store->priv->filter;
+}
+
+/**
+ * message_store_get_count:
+ * @store: a #MessageStore object.
+ * @type: type of the message
+ *
+ * Return value: The number of messages of this type in the store, visible
+ * or not, including the ones not added in the model yet.
+ */
+gint
+message_store_get_count (MessageStore *store, IAnjutaMessageViewType type)
+{
+	g_return_val_if_fail (MESSAGE_IS_STORE (store), 0);
+	g_return_val_if_fail ((type >= 0) && (type < MESSAGE_STORE_N_TYPES), 0);
+
+	return store->priv->counts[type];
+}
+
+/**
+ * message_store_set_highlite:
+ * @store: a #MessageStore object.
+ * @highlite: %TRUE to display colors and icons
+ *
+ * Display messages with a color and an icon depending on their type.
+ */
+void
+message_store_set_highlite (MessageStore *store, gboolean highlite)
+{
+	g_return_if_fail (MESSAGE_IS_STORE (store));
+
+	store->priv->highlite = highlite;
+}
+
+/**
+ * message_store_set_color:
+ * @store: a #MessageStore object.
+ * @type: type of the message
+ * @color: color name or %NULL
+ *
+ * Change the color used to display all messages of one type. The rows are not
+ * updated, the view has to be redrawn.
+ */
+void
+message_store_set_color (MessageStore *store, IAnjutaMessageViewType type,
+                         const gchar *color)
+{
+	g_return_if_fail (MESSAGE_IS_STORE (store));
+	g_return_if_fail ((type >= 0) && (type < MESSAGE_STORE_N_TYPES));
+
+	store->priv->colors[type] = g_intern_string (color);
+}
+
+/**
+ * message_store_set_max_resident:
+ * @store: a #MessageStore object.
+ * @max: maximum number of messages kept in memory or 0 for no limit
+ *
+ * Limit the number of messages kept in memory. The oldest messages are
+ * written in a temporary file and read back only when needed.
+ */
+void
+message_store_set_max_resident (MessageStore *store, guint max)
+{
+	g_return_if_fail (MESSAGE_IS_STORE (store));
+
+	store->priv->max_resident = max;
+	message_store_spill (store);
+}
+
+/* GObject functions
+ *---------------------------------------------------------------------------*/
+
+MessageStore *
+message_store_new (void)
+{
+	return g_object_new (MESSAGE_TYPE_STORE, NULL);
+}
+
+static void
+message_store_init (MessageStore *store)
+{
+	store->priv = G_TYPE_INSTANCE_GET_PRIVATE (store, MESSAGE_TYPE_STORE, MessageStorePrivate);
+
+	store->priv->chunks = g_ptr_array_new_with_free_func (g_free);
+	store->priv->visible = g_array_new (FALSE, FALSE, sizeof (guint));
+	store->priv->reloaded = g_queue_new ();
+	store->priv->filter = ~0;
+	store->priv->stamp = g_random_int ();
+}
+
+static void
+message_store_finalize (GObject *object)
+{
+	MessageStore *store = MESSAGE_STORE (object);
+	guint i;
+
+	message_store_cancel_flush (store);
+	for (i = 0; i < store->priv->n_messages; i++)
+	{
+		message_store_free_entry (message_store_get_entry (store, i));
+	}
+	g_ptr_array_free (store->priv->chunks, TRUE);
+	g_array_free (store->priv->visible, TRUE);
+	message_store_close_spill (store);
+	g_queue_free (store->priv->reloaded);
+
+	G_OBJECT_CLASS (message_store_parent_class)->finalize (object);
+}
+
+static void
+message_store_class_init (MessageStoreClass *klass)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+	g_type_class_add_private (klass, sizeof (MessageStorePrivate));
+
+	object_class->finalize = message_store_finalize;
+
+	/**
+	 * MessageStore::flushed:
+	 * @store: the #MessageStore
+	 *
+	 * Emitted when all appended messages have been added in the model.
+	 */
+	message_store_signals[FLUSHED] =
+		g_signal_new ("flushed",
+		              G_OBJECT_CLASS_TYPE (klass),
+		              G_SIGNAL_RUN_LAST,
+		              0,
+		              NULL, NULL,
+		              g_cclosure_marshal_VOID__VOID,
+		              G_TYPE_NONE,
+		              0);
+}
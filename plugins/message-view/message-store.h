@@ -0,0 +1,100 @@
+/* -*- Mode: C; indent-tabs-mode: t; c-basic-offset: 4; tab-width: 4 -*- */
+/*
+ * message-store.h
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef MESSAGE_STORE_H
+#define MESSAGE_STORE_H
+
+#include <gtk/gtk.h>
+#include <libanjuta/interfaces/ianjuta-message-view.h>
+
+G_BEGIN_DECLS
+
+#define MESSAGE_TYPE_STORE        (message_store_get_type ())
+#define MESSAGE_STORE(o)          (G_TYPE_CHECK_INSTANCE_CAST ((o), MESSAGE_TYPE_STORE, MessageStore))
+#define MESSAGE_STORE_CLASS(k)    (G_TYPE_CHECK_CLASS_CAST((k), MESSAGE_TYPE_STORE, MessageStoreClass))
+#define MESSAGE_IS_STORE(o)       (G_TYPE_CHECK_INSTANCE_TYPE ((o), MESSAGE_TYPE_STORE))
+#define MESSAGE_IS_STORE_CLASS(k) (G_TYPE_CHECK_CLASS_TYPE ((k), MESSAGE_TYPE_STORE))
+
+typedef struct _MessageStore MessageStore;
+typedef struct _MessageStoreClass MessageStoreClass;
+typedef struct _MessageStorePrivate MessageStorePrivate;
+
+typedef struct
+{
+	IAnjutaMessageViewType type;
+	gchar *summary;
+	gchar *details;
+
+} Message;
+
+enum
+{
+	COLUMN_COLOR = 0,
+	COLUMN_SUMMARY,
+	COLUMN_MESSAGE,
+	COLUMN_PIXBUF,
+	N_COLUMNS
+};
+
+struct _MessageStore
+{
+	GObject parent;
+
+	/* private */
+	MessageStorePrivate *priv;
+};
+
+struct _MessageStoreClass
+{
+	GObjectClass parent;
+};
+
+/* List model keeping messages in append-only chunks. New messages are added
+ * to the model at most once per frame. The markup of the summary is computed
+ * when the row is displayed and only messages whose type is in the filter are
+ * visible. Old messages can be moved to a temporary file when there are too
+ * many. */
+GType message_store_get_type (void);
+MessageStore *message_store_new (void);
+
+void message_store_append (MessageStore *store, IAnjutaMessageViewType type,
+						   const gchar *summary, const gchar *details);
+void message_store_clear (MessageStore *store);
+guint message_store_flush (MessageStore *store);
+
+const Message *message_store_get_message (MessageStore *store,
+										  GtkTreeIter *iter);
+guint message_store_get_n_messages (MessageStore *store);
+const Message *message_store_get_nth_message (MessageStore *store,
+											  guint index);
+
+void message_store_set_filter (MessageStore *store, guint types);
+guint message_store_get_filter (MessageStore *store);
+gint message_store_get_count (MessageStore *store,
+							  IAnjutaMessageViewType type);
+
+void message_store_set_highlite (MessageStore *store, gboolean highlite);
+void message_store_set_color (MessageStore *store,
+							  IAnjutaMessageViewType type,
+							  const gchar *color);
+void message_store_set_max_resident (MessageStore *store, guint max);
+
+G_END_DECLS
+
+#endif
@@ -21,20 +21,21 @@
 #include <libanjuta/interfaces/ianjuta-message-view.h>
 
 #include "message-view.h"
-#define MESSAGE_TYPE message_get_type()
+#include "message-store.h"
 
 #define PREFERENCES_SCHEMA "org.gnome.anjuta.plugins.message-manager"
 #define COLOR_ERROR "color-error"
 #define COLOR_WARNING "color-warning"
+#define MESSAGES_IN_MEMORY "messages-in-memory"
 
 struct _MessageViewPrivate
 {
 	//guint num_messages;
-	gchar *line_buffer;
+	GString *line_buffer;
+	gsize flushed;			/* Length of the lines already flushed */
 
 	GtkWidget *tree_view;
-	GtkTreeModel *model;
-	GtkTreeModel *filter;
+	MessageStore *model;
 
 	GtkWidget *popup_menu;
 
@@ -42,34 +43,19 @@ struct _MessageViewPrivate
 
 	/* Messages filter */
 	MessageViewFlags flags;
-	gint normal_count;
-	gint warn_count;
-	gint error_count;
-	gint info_count;
 
 	/* Properties */
 	gchar *label;
 	gchar *pixmap;
 	gboolean highlite;
 
-	GSettings* settings;
-};
-
-typedef struct
-{
-	IAnjutaMessageViewType type;
-	gchar *summary;
-	gchar *details;
-
-} Message;
+	/* Copy of the last message returned by get_current_message, the strings
+	 * of the store can be released when reading other messages */
+	gchar *current_message;
+	/* Copy of the messages returned by get_all_messages */
+	GList *all_messages;
 
-enum
-{
-	COLUMN_COLOR = 0,
-	COLUMN_SUMMARY,
-	COLUMN_MESSAGE,
-	COLUMN_PIXBUF,
-	N_COLUMNS
+	GSettings* settings;
 };
 
 enum
@@ -85,11 +71,6 @@ static gpointer parent_class;
 static void prefs_init (MessageView *mview);
 static void prefs_finalize (MessageView *mview);
 
-static gboolean
-message_view_tree_view_filter (GtkTreeModel *model,
-							   GtkTreeIter  *iter,
-							   gpointer      data);
-
 /* Ask the user for an uri name */
 static gchar *
 ask_user_for_save_uri (GtkWindow* parent)
@@ -115,38 +96,9 @@ ask_user_for_save_uri (GtkWindow* parent)
 	return uri;
 }
 
-/* Message object creation, copy and freeing */
-static Message*
-message_new (IAnjutaMessageViewType type, const gchar *summary,
-			 const gchar *details)
-{
-	/* DEBUG_PRINT ("%s", "Creating message"); */
-	Message *message = g_new0 (Message, 1);
-	message->type = type;
-	if (summary)
-		message->summary = g_strdup (summary);
-	if (details)
-		message->details = g_strdup (details);
-	return message;
-}
-
-static Message*
-message_copy (const Message *src)
-{
-	return message_new (src->type, src->summary, src->details);
-}
-
-static void
-message_free (Message *message)
-{
-	/* DEBUG_PRINT ("%s", "Freeing message"); */
-	g_free (message->summary);
-	g_free (message->details);
-	g_free (message);
-}
-
+/* Message object serialization */
 static gboolean
-message_serialize (Message *message, AnjutaSerializer *serializer)
+message_serialize (const Message *message, AnjutaSerializer *serializer)
 {
 	if (!anjuta_serializer_write_int (serializer, "type",
 									  message->type))
@@ -177,56 +129,6 @@ message_deserialize (Message *message, AnjutaSerializer *serializer)
 	return TRUE;
 }
 
-static GType
-message_get_type ()
-{
-	static GType type = 0;
-	if (!type)
-	{
-		type = g_boxed_type_register_static ("MessageViewMessage",
-											 (GBoxedCopyFunc) message_copy,
-											 (GBoxedFreeFunc) message_free);
-	}
-	return type;
-}
-
-/* Utility functions */
-/* Adds the char c to the string str */
-static void
-add_char(gchar** str, gchar c)
-{
-	gchar* buffer;
-
-	g_return_if_fail(str != NULL);
-
-	buffer = g_strdup_printf("%s%c", *str, c);
-	g_free(*str);
-	*str = buffer;
-}
-
-static gchar*
-escape_string (const gchar *str)
-{
-	GString *gstr;
-	const gchar *iter;
-
-	gstr = g_string_new ("");
-	iter = str;
-	while (*iter != '\0')
-	{
-		if (*iter == '>')
-			gstr = g_string_append (gstr, "&gt;");
-		else if (*iter == '<')
-			gstr = g_string_append (gstr, "&lt;");
-		else if (*iter == '&')
-			gstr = g_string_append (gstr, "&amp;");
-		else
-			gstr = g_string_append_c (gstr, *iter);
-		iter++;
-	}
-	return g_string_free (gstr, FALSE);
-}
-
 static gboolean
 message_view_query_tooltip (GtkWidget* widget, gint x, gint y, gboolean keyboard,
 						 GtkTooltip* tooltip)
@@ -236,16 +138,16 @@ message_view_query_tooltip (GtkWidget* widget, gint x, gint y, gboolean keyboard
 	GtkTreeModel *model;
 	MessageView* view = MESSAGE_VIEW(widget);
 
-	model = view->privat->model;
+	model = GTK_TREE_MODEL (view->privat->model);
 
 	if (gtk_tree_view_get_path_at_pos (GTK_TREE_VIEW(view->privat->tree_view),
 		x, y, &path, NULL, NULL, NULL))
 	{
-		Message *message;
-		gchar *text, *title, *desc;
+		const Message *message;
+		gchar *text;
 
 		gtk_tree_model_get_iter (model, &iter, path);
-		gtk_tree_model_get (model, &iter, COLUMN_MESSAGE, &message, -1);
+		message = message_store_get_message (view->privat->model, &iter);
 		gtk_tree_path_free(path);
 
 		if (!message->details || !message->summary ||
@@ -253,12 +155,8 @@ message_view_query_tooltip (GtkWidget* widget, gint x, gint y, gboolean keyboard
 			strlen (message->summary) <= 0)
 			return FALSE;
 
-		title = escape_string (message->summary);
-		desc = escape_string (message->details);
-		text = g_strdup_printf ("<b>%s</b>\n%s", title, desc);
-
-		g_free (title);
-		g_free (desc);
+		text = g_markup_printf_escaped ("<b>%s</b>\n%s", message->summary,
+										message->details);
 
 		gtk_tooltip_set_markup (tooltip, text);
 		g_free (text);
@@ -330,6 +228,12 @@ on_message_event (GObject* object, GdkEvent* event, gpointer data)
 	return FALSE;
 }
 
+static void
+on_message_store_flushed (MessageStore *store, gpointer data)
+{
+	g_signal_emit_by_name (G_OBJECT (data), "messages-displayed");
+}
+
 static void
 on_adjustment_changed (GtkAdjustment* adj, gpointer data)
 {
@@ -386,6 +290,7 @@ message_view_set_property (GObject * object,
 	case MV_PROP_HIGHLITE:
 	{
 		self->privat->highlite = g_value_get_boolean (value);
+		message_store_set_highlite (self->privat->model, self->privat->highlite);
 		break;
 	}
 	default:
@@ -447,9 +352,13 @@ static void
 message_view_finalize (GObject *obj)
 {
 	MessageView *mview = MESSAGE_VIEW (obj);
-	g_free (mview->privat->line_buffer);
+	g_string_free (mview->privat->line_buffer, TRUE);
+	g_object_unref (mview->privat->model);
 	g_free (mview->privat->label);
 	g_free (mview->privat->pixmap);
+	g_free (mview->privat->current_message);
+	g_list_foreach (mview->privat->all_messages, (GFunc)g_free, NULL);
+	g_list_free (mview->privat->all_messages);
 	g_free (mview->privat);
 	G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
@@ -463,29 +372,23 @@ message_view_instance_init (MessageView * self)
 	GtkTreeViewColumn *column;
 	GtkTreeViewColumn *column_pixbuf;
 	GtkTreeSelection *select;
-	GtkListStore *model;
 	GtkAdjustment* adj;
 
 	g_return_if_fail(self != NULL);
 	self->privat = g_new0 (MessageViewPrivate, 1);
 
 	/* Init private data */
-	self->privat->line_buffer = g_strdup("");
+	self->privat->line_buffer = g_string_new (NULL);
 	self->privat->flags = 0xF;
 
-	/* Create the tree widget */
-	model = gtk_list_store_new (N_COLUMNS, G_TYPE_STRING,
-								G_TYPE_STRING, MESSAGE_TYPE,  G_TYPE_STRING);
-	self->privat->model = GTK_TREE_MODEL (model);
-
-	/* message filter */
-	self->privat->filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (model), NULL);
-	gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (self->privat->filter),
-											message_view_tree_view_filter,
-											self, NULL);
+	/* Create the tree widget, the store filters the messages itself */
+	self->privat->model = message_store_new ();
+	message_store_set_filter (self->privat->model, self->privat->flags);
+	g_signal_connect_object (self->privat->model, "flushed",
+							 G_CALLBACK (on_message_store_flushed), self, 0);
 
 	self->privat->tree_view =
-		gtk_tree_view_new_with_model (GTK_TREE_MODEL (self->privat->filter));
+		gtk_tree_view_new_with_model (GTK_TREE_MODEL (self->privat->model));
 	gtk_widget_show (self->privat->tree_view);
 	gtk_tree_view_set_headers_visible (GTK_TREE_VIEW
 									   (self->privat->tree_view), FALSE);
@@ -607,8 +510,8 @@ message_view_new (GtkWidget* popup_menu)
 gboolean
 message_view_serialize (MessageView *view, AnjutaSerializer *serializer)
 {
-	GtkTreeModel *model;
-	GtkTreeIter iter;
+	guint n_messages;
+	guint i;
 
 	g_return_val_if_fail (view != NULL && MESSAGE_IS_VIEW (view), FALSE);
 
@@ -622,26 +525,18 @@ message_view_serialize (MessageView *view, AnjutaSerializer *serializer)
 									  view->privat->highlite))
 		return FALSE;
 
-	/* Serialize individual messages */
-	model = view->privat->model;
+	/* Serialize individual messages, including the hidden ones */
+	n_messages = message_store_get_n_messages (view->privat->model);
 
-	if (!anjuta_serializer_write_int (serializer, "messages",
-									  gtk_tree_model_iter_n_children (model, NULL)))
+	if (!anjuta_serializer_write_int (serializer, "messages", n_messages))
 		return FALSE;
 
-	if (gtk_tree_model_get_iter_first (model, &iter))
+	for (i = 0; i < n_messages; i++)
 	{
-		do
-		{
-			Message *message;
-			gtk_tree_model_get (model, &iter, COLUMN_MESSAGE, &message, -1);
-			if (message)
-			{
-				if (!message_serialize (message, serializer))
-					return FALSE;
-			}
-		}
-		while (gtk_tree_model_iter_next (model, &iter));
+		const Message *message;
+		message = message_store_get_nth_message (view->privat->model, i);
+		if (!message_serialize (message, serializer))
+			return FALSE;
 	}
 	return TRUE;
 }
@@ -649,7 +544,6 @@ message_view_serialize (MessageView *view, AnjutaSerializer *serializer)
 gboolean
 message_view_deserialize (MessageView *view, AnjutaSerializer *serializer)
 {
-	GtkTreeModel *model;
 	gint messages, i;
 
 	g_return_val_if_fail (view != NULL && MESSAGE_IS_VIEW (view), FALSE);
@@ -665,25 +559,25 @@ message_view_deserialize (MessageView *view, AnjutaSerializer *serializer)
 		return FALSE;
 
 	/* Create individual messages */
-	model = view->privat->model;
-	gtk_list_store_clear (GTK_LIST_STORE (model));
+	message_store_set_highlite (view->privat->model, view->privat->highlite);
+	message_store_clear (view->privat->model);
 
 	if (!anjuta_serializer_read_int (serializer, "messages", &messages))
 		return FALSE;
 
 	for (i = 0; i < messages; i++)
 	{
-		Message *message;
-
-		message = message_new (0, NULL, NULL);
-		if (!message_deserialize (message, serializer))
-		{
-			message_free (message);
+		Message message = {0, NULL, NULL};
+		gboolean ok;
+
+		ok = message_deserialize (&message, serializer);
+		if (ok)
+			message_store_append (view->privat->model, message.type,
+								  message.summary, message.details);
+		g_free (message.summary);
+		g_free (message.details);
+		if (!ok)
 			return FALSE;
-		}
-		ianjuta_message_view_append (IANJUTA_MESSAGE_VIEW (view), message->type,
-									 message->summary, message->details, NULL);
-		message_free (message);
 	}
 	return TRUE;
 }
@@ -696,7 +590,9 @@ void message_view_next(MessageView* view)
 
 	g_return_if_fail (view != NULL && MESSAGE_IS_VIEW (view));
 
-	model = view->privat->model;
+	/* Look at the last messages too */
+	message_store_flush (view->privat->model);
+	model = GTK_TREE_MODEL (view->privat->model);
 	select = gtk_tree_view_get_selection (GTK_TREE_VIEW
 					      (view->privat->tree_view));
 
@@ -742,7 +638,9 @@ void message_view_previous(MessageView* view)
 
 	g_return_if_fail (view != NULL && MESSAGE_IS_VIEW (view));
 
-	model = view->privat->model;
+	/* Look at the last messages too */
+	message_store_flush (view->privat->model);
+	model = GTK_TREE_MODEL (view->privat->model);
 	select = gtk_tree_view_get_selection (GTK_TREE_VIEW
 					      (view->privat->tree_view));
 
@@ -790,8 +688,8 @@ static gboolean message_view_save_as(MessageView* view, gchar* uri)
 {
 	GFile *file;
 	GOutputStream *os;
-	GtkTreeIter iter;
-	GtkTreeModel *model;
+	guint n_messages;
+	guint i;
 	gboolean ok;
 
 	g_return_val_if_fail (view != NULL && MESSAGE_IS_VIEW (view), FALSE);
@@ -814,37 +712,33 @@ static gboolean message_view_save_as(MessageView* view, gchar* uri)
 	}
 
 	/* Save all lines of message view */
-	model = view->privat->model;
+	n_messages = message_store_get_n_messages (view->privat->model);
 
 	ok = TRUE;
-	gtk_tree_model_get_iter_first (model, &iter);
-	do
+	for (i = 0; i < n_messages; i++)
 	{
-		Message *message;
+		const Message *message;
 
-		gtk_tree_model_get (model, &iter, COLUMN_MESSAGE, &message, -1);
-		if (message)
+		message = message_store_get_nth_message (view->privat->model, i);
+		if (message->details && (strlen (message->details) > 0))
 		{
-			if (message->details && (strlen (message->details) > 0))
+			if (g_output_stream_write (os, message->details, strlen (message->details), NULL, NULL) < 0)
 			{
-				if (g_output_stream_write (os, message->details, strlen (message->details), NULL, NULL) < 0)
-				{
-					ok = FALSE;
-				}
-			}
-			else
-			{
-				if (g_output_stream_write (os, message->summary, strlen (message->summary), NULL, NULL) < 0)
-				{
-					ok = FALSE;
-				}
+				ok = FALSE;
 			}
-			if (g_output_stream_write (os, "\n", 1, NULL, NULL) < 0)
+		}
+		else
+		{
+			if (g_output_stream_write (os, message->summary, strlen (message->summary), NULL, NULL) < 0)
 			{
 				ok = FALSE;
 			}
 		}
-	} while (gtk_tree_model_iter_next (model, &iter));
+		if (g_output_stream_write (os, "\n", 1, NULL, NULL) < 0)
+		{
+			ok = FALSE;
+		}
+	}
 	g_output_stream_close (os, NULL, NULL);
 	g_object_unref (os);
 	g_object_unref (file);
@@ -880,7 +774,7 @@ void message_view_copy(MessageView* view)
 
 	g_return_if_fail (view != NULL && MESSAGE_IS_VIEW (view));
 
-	model = view->privat->model;
+	model = GTK_TREE_MODEL (view->privat->model);
 	select = gtk_tree_view_get_selection (GTK_TREE_VIEW
 					      (view->privat->tree_view));
 
@@ -918,25 +812,14 @@ pref_change_color (MessageView *mview, IAnjutaMessageViewType type,
 				   const gchar *color_pref_key)
 {
 	gchar* color;
-	GtkListStore *store;
-	GtkTreeIter iter;
-	gboolean success;
 
+	/* The color is shared by all messages of this type */
 	color = g_settings_get_string (mview->privat->settings, color_pref_key);
-	store = GTK_LIST_STORE (mview->privat->model);
-	success = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
-	while (success)
-	{
-		Message *message;
-		gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, COLUMN_MESSAGE,
-							&message, -1);
-		if (message && message->type == type)
-		{
-			gtk_list_store_set (store, &iter, COLUMN_COLOR, color, -1);
-		}
-		success = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
-	}
+	message_store_set_color (mview->privat->model, type, color);
 	g_free(color);
+
+	if (mview->privat->tree_view)
+		gtk_widget_queue_draw (mview->privat->tree_view);
 }
 
 
@@ -962,6 +845,11 @@ prefs_init (MessageView *mview)
 	                  G_CALLBACK (on_notify_color), mview);
 	g_signal_connect (mview->privat->settings, "changed::" COLOR_WARNING,
 	                  G_CALLBACK (on_notify_color), mview);
+	pref_change_color (mview, IANJUTA_MESSAGE_VIEW_TYPE_ERROR, COLOR_ERROR);
+	pref_change_color (mview, IANJUTA_MESSAGE_VIEW_TYPE_WARNING, COLOR_WARNING);
+	message_store_set_max_resident (mview->privat->model,
+	                                g_settings_get_int (mview->privat->settings,
+	                                                    MESSAGES_IN_MEMORY));
 }
 
 static void
@@ -981,34 +869,40 @@ static void
 imessage_view_buffer_append (IAnjutaMessageView * message_view,
 									const gchar * message, GError ** e)
 {
+	static guint buffer_flushed_signal = 0;
 	MessageView *view;
-	gint cur_char;
-	int len;
+	GString *buffer;
+	gchar *eol;
 
 	g_return_if_fail (MESSAGE_IS_VIEW (message_view));
 
 	if (!message)
 		return;
 
-	len = strlen(message);
-
 	view = MESSAGE_VIEW (message_view);
+	buffer = view->privat->line_buffer;
+	g_string_append (buffer, message);
+
+	if (buffer_flushed_signal == 0)
+		buffer_flushed_signal = g_signal_lookup ("buffer-flushed", IANJUTA_TYPE_MESSAGE_VIEW);
 
-	/* Check if message contains newlines */
-	for (cur_char = 0; cur_char < len; cur_char++)
+	/* Print all complete lines. A handler can append more data, so the
+	 * buffer and the flushed position are read again after each line */
+	while ((eol = memchr (buffer->str + view->privat->flushed, '\n',
+						  buffer->len - view->privat->flushed)) != NULL)
 	{
-		/* Is newline => print line */
-		if (message[cur_char] != '\n')
-		{
-			add_char(&view->privat->line_buffer, message[cur_char]);
-		}
-		else
-		{
-			g_signal_emit_by_name (G_OBJECT (view), "buffer_flushed",
-								   view->privat->line_buffer);
-			g_free(view->privat->line_buffer);
-			view->privat->line_buffer = g_strdup("");
-		}
+		gchar *line = buffer->str + view->privat->flushed;
+
+		*eol = '\0';
+		view->privat->flushed = eol - buffer->str + 1;
+		g_signal_emit (G_OBJECT (view), buffer_flushed_signal, 0, line);
+	}
+
+	/* Keep only the last incomplete line */
+	if (view->privat->flushed > 0)
+	{
+		g_string_erase (buffer, 0, view->privat->flushed);
+		view->privat->flushed = 0;
 	}
 }
 
@@ -1019,107 +913,27 @@ imessage_view_append (IAnjutaMessageView *message_view,
 					  const gchar *details,
 					  GError ** e)
 {
-	gchar* color;
-	GtkListStore *store;
-	GtkTreeIter iter;
-	gboolean highlite;
-	gchar *utf8_msg;
-	gchar *escaped_str;
-	gchar* stock_id = NULL;
-
 	MessageView *view;
-	Message *message;
 
 	g_return_if_fail (MESSAGE_IS_VIEW (message_view));
 
 	view = MESSAGE_VIEW (message_view);
 
-	message = message_new (type, summary, details);
-
-	g_object_get (G_OBJECT (view), "highlite", &highlite, NULL);
-	color = NULL;
-	if (highlite)
-	{
-		switch (message->type)
-		{
-			case IANJUTA_MESSAGE_VIEW_TYPE_INFO:
-				view->privat->info_count++;
-				stock_id = GTK_STOCK_INFO;
-				break;
-			case IANJUTA_MESSAGE_VIEW_TYPE_WARNING:
-				color = g_settings_get_string (view->privat->settings, COLOR_WARNING);
-				/* FIXME: There is no GTK_STOCK_WARNING which would fit better here */
-				view->privat->warn_count++;
-				stock_id = GTK_STOCK_DIALOG_WARNING;
-				break;
-			case IANJUTA_MESSAGE_VIEW_TYPE_ERROR:
-				color = g_settings_get_string (view->privat->settings, COLOR_ERROR);
-				view->privat->error_count++;
-				stock_id = GTK_STOCK_STOP;
-				break;
-			default:
-				color = NULL;
-				view->privat->normal_count++;
-		}
-	}
-
-	/* Add the message to the tree */
-	store = GTK_LIST_STORE (view->privat->model);
-	gtk_list_store_append (store, &iter);
-
-	/*
-	 * Must be normalized to compose representation to be
-	 * displayed correctly (Bug in gtk_list???)
-	 */
-	utf8_msg = g_utf8_normalize (message->summary, -1,
-								 G_NORMALIZE_DEFAULT_COMPOSE);
-	if (message->details && strlen (message->details) > 0)
-	{
-		gchar *summary;
-		summary = escape_string (message->summary);
-		escaped_str = g_strdup_printf ("<b>%s</b>", summary);
-		g_free (summary);
-	} else {
-		escaped_str = escape_string (message->summary);
-	}
-	gtk_list_store_set (store, &iter,
-							COLUMN_SUMMARY, escaped_str,
-							COLUMN_MESSAGE, message,
-							-1);
-	if (color)
-	{
-		gtk_list_store_set (store, &iter,
-							COLUMN_COLOR, color, -1);
-	}
-	if (stock_id)
-	{
-		gtk_list_store_set (store, &iter,
-							COLUMN_PIXBUF, stock_id, -1);
-	}
-	g_free(color);
-	message_free (message);
-	g_free (utf8_msg);
-	g_free (escaped_str);
+	/* The store adds the message in the tree view at the next frame,
+	 * colors, icons and markup are computed when it is displayed */
+	message_store_append (view->privat->model, type, summary, details);
 }
 
 /* Clear all messages from the message view */
 static void
 imessage_view_clear (IAnjutaMessageView *message_view, GError **e)
 {
-	GtkListStore *store;
 	MessageView *view;
 
 	g_return_if_fail (MESSAGE_IS_VIEW (message_view));
 	view = MESSAGE_VIEW (message_view);
 
-	/* filter settings restart */
-	view->privat->normal_count = 0;
-	view->privat->info_count = 0;
-	view->privat->warn_count = 0;
-	view->privat->error_count = 0;
-
-	store = GTK_LIST_STORE (view->privat->model);
-	gtk_list_store_clear (store);
+	message_store_clear (view->privat->model);
 }
 
 /* Move the selection to the next line. */
@@ -1142,7 +956,7 @@ imessage_view_select_previous (IAnjutaMessageView * message_view,
 
 /* Return the currently selected messages or the first message if no
  * message is selected or NULL if no messages are availible. The
- * returned message must not be freed.
+ * returned message must not be freed, it is valid until the next call.
  */
 static const gchar *
 imessage_view_get_current_message (IAnjutaMessageView * message_view,
@@ -1157,71 +971,80 @@ imessage_view_get_current_message (IAnjutaMessageView * message_view,
 	g_return_val_if_fail (MESSAGE_IS_VIEW (message_view), NULL);
 
 	view = MESSAGE_VIEW (message_view);
+	message_store_flush (view->privat->model);
 	select = gtk_tree_view_get_selection (GTK_TREE_VIEW
 									      (view->privat->tree_view));
 
+	g_free (view->privat->current_message);
+	view->privat->current_message = NULL;
 	if (!gtk_tree_selection_get_selected (select, &model, &iter))
 	{
-		if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (model), &iter))
-		{
-			gtk_tree_model_get (GTK_TREE_MODEL (model),
-								&iter, COLUMN_MESSAGE, &message, -1);
-			if (message)
-			{
-				if (message->details && strlen (message->details) > 0)
-					return message->details;
-				else
-					return message->summary;
-			}
-		}
+		model = GTK_TREE_MODEL (view->privat->model);
+		if (!gtk_tree_model_get_iter_first (model, &iter))
+			return NULL;
 	}
-	else
+	gtk_tree_model_get (GTK_TREE_MODEL (model),
+					    &iter, COLUMN_MESSAGE, &message, -1);
+	if (message)
 	{
-		gtk_tree_model_get (GTK_TREE_MODEL (model),
-						    &iter, COLUMN_MESSAGE, &message, -1);
-		if (message)
-		{
-			if (message->details && strlen (message->details) > 0)
-				return message->details;
-			else
-				return message->summary;
-		}
+		if (message->details && strlen (message->details) > 0)
+			view->privat->current_message = g_strdup (message->details);
+		else
+			view->privat->current_message = g_strdup (message->summary);
 	}
-	return NULL;
+
+	return view->privat->current_message;
 }
 
-/* Returns a GList which contains all messages, the GList itself
- * must be freed, the messages are managed by the message view and
- * must not be freed. NULL is return if no messages are availible.
+/* Returns a GList which contains a copy of all messages, the GList and
+ * the messages must be freed. NULL is return if no messages are availible.
  */
 static GList *
-imessage_view_get_all_messages (IAnjutaMessageView * message_view,
-								GError ** e)
+imessage_view_copy_all_messages (IAnjutaMessageView * message_view,
+								 GError ** e)
 {
 	MessageView *view;
-	GtkListStore *store;
-	GtkTreeIter iter;
-	Message *message;
+	guint n_messages;
+	guint i;
+	const Message *message;
 	GList *messages = NULL;
 
 	g_return_val_if_fail (MESSAGE_IS_VIEW (message_view), NULL);
 
 	view = MESSAGE_VIEW (message_view);
-	store = GTK_LIST_STORE (view->privat->model);
+	n_messages = message_store_get_n_messages (view->privat->model);
 
-	if (gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter))
+	for (i = 0; i < n_messages; i++)
 	{
-		do
-		{
-			gtk_tree_model_get (GTK_TREE_MODEL (store), &iter,
-							    COLUMN_MESSAGE, &message);
-			messages = g_list_prepend (messages, message->details);
-		}
-		while (gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter));
+		message = message_store_get_nth_message (view->privat->model, i);
+		messages = g_list_prepend (messages, g_strdup (message->details));
 	}
 	return messages;
 }
 
+/* Returns a GList which contains all messages, the GList itself
+ * must be freed, the messages are managed by the message view and
+ * must not be freed. They are valid until the next call. NULL is return
+ * if no messages are availible.
+ */
+static GList *
+imessage_view_get_all_messages (IAnjutaMessageView * message_view,
+								GError ** e)
+{
+	MessageView *view;
+
+	g_return_val_if_fail (MESSAGE_IS_VIEW (message_view), NULL);
+
+	/* The strings of the store can be released when reading other
+	 * messages, keep a copy in the view */
+	view = MESSAGE_VIEW (message_view);
+	g_list_foreach (view->privat->all_messages, (GFunc)g_free, NULL);
+	g_list_free (view->privat->all_messages);
+	view->privat->all_messages = imessage_view_copy_all_messages (message_view, e);
+
+	return g_list_copy (view->privat->all_messages);
+}
+
 static void
 imessage_view_iface_init (IAnjutaMessageViewIface *iface)
 {
@@ -1232,29 +1055,7 @@ imessage_view_iface_init (IAnjutaMessageViewIface *iface)
 	iface->select_previous = imessage_view_select_previous;
 	iface->get_current_message = imessage_view_get_current_message;
 	iface->get_all_messages = imessage_view_get_all_messages;
-}
-
-static gboolean
-message_view_tree_view_filter (GtkTreeModel *model, GtkTreeIter  *iter,
-							   gpointer      data)
-{
-	Message *msg;
-	MessageView *msgview;
-
-	msgview = MESSAGE_VIEW (data);
-	gtk_tree_model_get (msgview->privat->model, iter, COLUMN_MESSAGE, &msg, -1);
-
-	if (msg != NULL) {
-		if (msg->type == IANJUTA_MESSAGE_VIEW_TYPE_NORMAL) {
-			return msgview->privat->flags & MESSAGE_VIEW_SHOW_NORMAL;
-		} else if (msg->type == IANJUTA_MESSAGE_VIEW_TYPE_INFO) {
-			return msgview->privat->flags & MESSAGE_VIEW_SHOW_INFO;
-		} else if (msg->type == IANJUTA_MESSAGE_VIEW_TYPE_WARNING) {
-			return msgview->privat->flags & MESSAGE_VIEW_SHOW_WARNING;
-		} else if (msg->type == IANJUTA_MESSAGE_VIEW_TYPE_ERROR) {
-			return msgview->privat->flags & MESSAGE_VIEW_SHOW_ERROR;
-		} else return TRUE;
-	} else return FALSE;
+	iface->copy_all_messages = imessage_view_copy_all_messages;
 }
 
 MessageViewFlags
@@ -1270,7 +1071,14 @@ void message_view_set_flags (MessageView* view, MessageViewFlags flags)
 	g_return_if_fail (view != NULL && MESSAGE_IS_VIEW (view));
 
 	view->privat->flags = flags;
-	gtk_tree_model_filter_refilter (GTK_TREE_MODEL_FILTER(view->privat->filter));
+
+	/* All rows are recreated, avoid updating the view for each of them */
+	g_object_ref (view->privat->model);
+	gtk_tree_view_set_model (GTK_TREE_VIEW (view->privat->tree_view), NULL);
+	message_store_set_filter (view->privat->model, flags);
+	gtk_tree_view_set_model (GTK_TREE_VIEW (view->privat->tree_view),
+							 GTK_TREE_MODEL (view->privat->model));
+	g_object_unref (view->privat->model);
 }
 
 gint message_view_get_count (MessageView* view, MessageViewFlags flags)
@@ -1280,13 +1088,17 @@ gint message_view_get_count (MessageView* view, MessageViewFlags flags)
 	switch (flags)
 	{
 		case MESSAGE_VIEW_SHOW_NORMAL:
-			return view->privat->normal_count;
+			return message_store_get_count (view->privat->model,
+											IANJUTA_MESSAGE_VIEW_TYPE_NORMAL);
 		case MESSAGE_VIEW_SHOW_INFO:
-			return view->privat->info_count;
+			return message_store_get_count (view->privat->model,
+											IANJUTA_MESSAGE_VIEW_TYPE_INFO);
 		case MESSAGE_VIEW_SHOW_WARNING:
-			return view->privat->warn_count;
+			return message_store_get_count (view->privat->model,
+											IANJUTA_MESSAGE_VIEW_TYPE_WARNING);
 		case MESSAGE_VIEW_SHOW_ERROR:
-			return view->privat->error_count;
+			return message_store_get_count (view->privat->model,
+											IANJUTA_MESSAGE_VIEW_TYPE_ERROR);
 		default:
 			g_assert_not_reached ();
 	}
@@ -476,6 +476,7 @@ project_load_makefile (MkpProject *project, GFile *file, MkpGroup *parent, GErro
 	AnjutaToken *arg;
 	AnjutaTokenFile *tfile;
 	AnjutaToken *parse;
+	AnjutaTokenPool *old_pool;
 	gboolean ok;
 	GError *err = NULL;
 
@@ -484,10 +485,12 @@ project_load_makefile (MkpProject *project, GFile *file, MkpGroup *parent, GErro
 	tfile = anjuta_token_file_new (file);
 	g_hash_table_insert (project->files, g_object_ref (file), g_object_ref (tfile));
 	arg = anjuta_token_file_load (tfile, NULL);
+	old_pool = anjuta_token_pool_set_current (anjuta_token_file_get_pool (tfile));
 	scanner = mkp_scanner_new (project);
 	parse = mkp_scanner_parse_token (scanner, arg, &err);
 	ok = parse != NULL;
 	mkp_scanner_free (scanner);
+	anjuta_token_pool_set_current (old_pool);
 	if (!ok)
 	{
 		if (err != NULL)
@@ -74,7 +74,8 @@ struct _ParserCxxAssistPriv {
 	IAnjutaSymbolQuery *calltip_query_project;
 
 	/* Autocompletion */
-	GCompletion *completion_cache;
+	GPtrArray* completion_cache;
+	gchar* cache_word;
 	gchar* pre_word;
 	gboolean member_completion;
 	gboolean autocompletion;
@@ -159,46 +160,121 @@ parser_cxx_assist_proposal_free (IAnjutaEditorAssistProposal* proposal)
 }
 
 /**
- * anjuta_propsal_completion_func:
- * @data: an IAnjutaEditorAssistProposal
+ * parser_cxx_assist_is_word_start:
+ * @name: candidate name
+ * @pos: position inside name
  *
- * Returns: the name of the completion func
+ * Checks if the character at pos starts a new sub-word of an identifier, this
+ * is the case after an underscore and on a lower to upper case transition.
+ *
+ * Returns: TRUE if pos is the beginning of a sub-word, FALSE otherwise
  */
-static gchar*
-anjuta_proposal_completion_func (gpointer data)
+static gboolean
+parser_cxx_assist_is_word_start (const gchar* name, gint pos)
 {
-	IAnjutaEditorAssistProposal* proposal = data;
-	IAnjutaLanguageProviderProposalData* prop_data = proposal->data;
-	
-	return prop_data->name;
+	if (pos == 0)
+		return TRUE;
+	if (name[pos - 1] == '_' && name[pos] != '_')
+		return TRUE;
+	if (g_ascii_islower (name[pos - 1]) && g_ascii_isupper (name[pos]))
+		return TRUE;
+	return FALSE;
 }
 
 /**
- * parser_cxx_assist_create_completion_from_symbols:
- * @symbols: Symbol iteration
+ * parser_cxx_assist_fuzzy_score:
+ * @word: typed word
+ * @name: candidate name
  *
- * Create a list of IAnjutaEditorAssistProposals from a list of symbols
+ * Matches word as a case insensitive subsequence of name. Characters matching
+ * at the start of name, at a camelCase or underscore boundary or right after
+ * the previous match get a bonus, skipped characters a small penalty.
  *
- * Returns: a newly allocated GList of newly allocated proposals. Free
- * with cpp_java_assist_proposal_free()
+ * Returns: the score of the match, -1 if word is not a subsequence of name
  */
-static GList*
-parser_cxx_assist_create_completion_from_symbols (IAnjutaIterable* symbols)
+static gint
+parser_cxx_assist_fuzzy_score (const gchar* word, const gchar* name)
+{
+	gint score = 0;
+	gint last = -1;
+	gint pos = 0;
+
+	for (; *word != '\0'; word++)
+	{
+		gchar ch = g_ascii_tolower (*word);
+
+		while (name[pos] != '\0' && g_ascii_tolower (name[pos]) != ch)
+			pos++;
+		if (name[pos] == '\0')
+			return -1;
+
+		score++;
+		if (pos == 0)
+			score += 8;
+		else if (parser_cxx_assist_is_word_start (name, pos))
+			score += 6;
+		if (pos == last + 1)
+			score += 4;
+		else
+			score -= MIN (pos - last - 1, 3);
+		if (name[pos] == *word)
+			score++;
+
+		last = pos;
+		pos++;
+	}
+
+	return score;
+}
+
+typedef struct
+{
+	gint score;
+	IAnjutaEditorAssistProposal* proposal;
+} ParserCxxAssistMatch;
+
+static gint
+parser_cxx_assist_compare_matches (gconstpointer a, gconstpointer b)
 {
-	GList* list = NULL;
+	const ParserCxxAssistMatch* match_a = a;
+	const ParserCxxAssistMatch* match_b = b;
+	IAnjutaLanguageProviderProposalData* data_a = match_a->proposal->data;
+	IAnjutaLanguageProviderProposalData* data_b = match_b->proposal->data;
+	gsize len_a, len_b;
 
+	if (match_a->score != match_b->score)
+		return match_b->score - match_a->score;
+
+	len_a = strlen (data_a->name);
+	len_b = strlen (data_b->name);
+	if (len_a != len_b)
+		return len_a < len_b ? -1 : 1;
+
+	return strcmp (data_a->name, data_b->name);
+}
+
+/**
+ * parser_cxx_assist_add_completion_from_symbols:
+ * @candidates: Array of candidate proposals
+ * @symbols: Symbol iteration
+ *
+ * Append an IAnjutaEditorAssistProposal for each symbol to candidates. The
+ * array owns the proposals and frees them with parser_cxx_assist_proposal_free()
+ */
+static void
+parser_cxx_assist_add_completion_from_symbols (GPtrArray* candidates,
+                                               IAnjutaIterable* symbols)
+{
 	if (!symbols)
-		return NULL;
+		return;
 	do
 	{
 		IAnjutaSymbol* symbol = IANJUTA_SYMBOL (symbols);
 		IAnjutaEditorAssistProposal* proposal = parser_cxx_assist_proposal_new (symbol);	
 
-		list = g_list_append (list, proposal);
+		g_ptr_array_add (candidates, proposal);
 	}
 	while (ianjuta_iterable_next (symbols, NULL));
-
-	return list;
 }
 
 /**
@@ -395,14 +471,17 @@ parser_cxx_assist_parse_expression (ParserCxxAssist* assist, IAnjutaIterable* it
  * parser_cxx_assist_create_completion_cache:
  * @assist: self
  *
- * Create a new completion_cache object
+ * Create a new, empty candidate array for the current pre_word. It is kept
+ * and re-ranked as long as the user extends this word.
  */
 static void
 parser_cxx_assist_create_completion_cache (ParserCxxAssist* assist)
 {
 	g_assert (assist->priv->completion_cache == NULL);
-	assist->priv->completion_cache = 
-		g_completion_new (anjuta_proposal_completion_func);
+	assist->priv->completion_cache = g_ptr_array_new_with_free_func (
+	                         (GDestroyNotify) parser_cxx_assist_proposal_free);
+	assist->priv->cache_word = g_strdup (assist->priv->pre_word != NULL ?
+	                                     assist->priv->pre_word : "");
 }
 
 /**
@@ -433,12 +512,10 @@ parser_cxx_assist_clear_completion_cache (ParserCxxAssist* assist)
 {
 	parser_cxx_assist_cancel_queries (assist);
 	if (assist->priv->completion_cache)
-	{	
-		g_list_foreach (assist->priv->completion_cache->items,
-		                        (GFunc) parser_cxx_assist_proposal_free, NULL);
-		g_completion_free (assist->priv->completion_cache);
-	}
+		g_ptr_array_unref (assist->priv->completion_cache);
 	assist->priv->completion_cache = NULL;
+	g_free (assist->priv->cache_word);
+	assist->priv->cache_word = NULL;
 	assist->priv->member_completion = FALSE;
 	assist->priv->autocompletion = FALSE;
 }
@@ -449,18 +526,47 @@ parser_cxx_assist_clear_completion_cache (ParserCxxAssist* assist)
  * @finished: TRUE if no more proposals are expected, FALSE otherwise
  *
  * Really invokes the completion interfaces and adds completions.
+ * The candidates are filtered and ranked against the current pre_word,
+ * without querying the symbol database again.
  * Might be called from an async context
  */
 static void
 parser_cxx_assist_populate_real (ParserCxxAssist* assist, gboolean finished)
 {
+	GPtrArray* candidates = assist->priv->completion_cache;
+	GArray* matches;
+	GList* proposals = NULL;
+	guint i;
+
 	g_assert (assist->priv->pre_word != NULL);
-	GList* proposals = g_completion_complete (assist->priv->completion_cache,
-	                                          assist->priv->pre_word,
-	                                          NULL);
+
+	matches = g_array_sized_new (FALSE, FALSE, sizeof (ParserCxxAssistMatch),
+	                             candidates->len);
+	for (i = 0; i < candidates->len; i++)
+	{
+		ParserCxxAssistMatch match;
+		IAnjutaLanguageProviderProposalData* data;
+
+		match.proposal = g_ptr_array_index (candidates, i);
+		data = match.proposal->data;
+		match.score = parser_cxx_assist_fuzzy_score (assist->priv->pre_word,
+		                                             data->name);
+		if (match.score >= 0)
+			g_array_append_val (matches, match);
+	}
+	g_array_sort (matches, parser_cxx_assist_compare_matches);
+
+	for (i = matches->len; i > 0; i--)
+	{
+		proposals = g_list_prepend (proposals,
+		                            g_array_index (matches, ParserCxxAssistMatch, i - 1).proposal);
+	}
+	g_array_free (matches, TRUE);
+
 	ianjuta_editor_assist_proposals (assist->priv->iassist,
 	                                 IANJUTA_PROVIDER(assist), proposals,
 	                                 assist->priv->pre_word, finished, NULL);
+	g_list_free (proposals);
 }
 
 /**
@@ -491,13 +597,11 @@ parser_cxx_assist_create_member_completion_cache (ParserCxxAssist* assist,
 		g_object_unref (symbol);
 		if (children)
 		{
-			GList* proposals =
-			        parser_cxx_assist_create_completion_from_symbols (children);
 			parser_cxx_assist_create_completion_cache (assist);
-			g_completion_add_items (assist->priv->completion_cache, proposals);
+			parser_cxx_assist_add_completion_from_symbols (assist->priv->completion_cache,
+			                                               children);
 
 			parser_cxx_assist_populate_real (assist, TRUE);
-			g_list_free (proposals);
 			g_object_unref (children);
 			return start_iter;
 		}
@@ -519,9 +623,6 @@ static void
 on_symbol_search_complete (IAnjutaSymbolQuery *query, IAnjutaIterable* symbols,
 						   ParserCxxAssist* assist)
 {
-	GList* proposals;
-	proposals = parser_cxx_assist_create_completion_from_symbols (symbols);
-
 	if (query == assist->priv->ac_query_file)
 		assist->priv->async_file_id = 0;
 	else if (query == assist->priv->ac_query_project)
@@ -531,13 +632,13 @@ on_symbol_search_complete (IAnjutaSymbolQuery *query, IAnjutaIterable* symbols,
 	else
 		g_assert_not_reached ();
 	
-	g_completion_add_items (assist->priv->completion_cache, proposals);
+	parser_cxx_assist_add_completion_from_symbols (assist->priv->completion_cache,
+	                                               symbols);
 	gboolean running = assist->priv->async_system_id
 	                       || assist->priv->async_file_id
 	                       || assist->priv->async_project_id;
 	if (!running)
 		parser_cxx_assist_populate_real (assist, TRUE);
-	g_list_free (proposals);
 }
 
 /**
@@ -568,8 +669,8 @@ parser_cxx_assist_create_autocompletion_cache (ParserCxxAssist* assist,
 	{
 		gchar *pattern = g_strconcat (pre_word, "%", NULL);
 		
-		parser_cxx_assist_create_completion_cache (assist);
 		parser_cxx_assist_update_pre_word (assist, pre_word);
+		parser_cxx_assist_create_completion_cache (assist);
 
 		if (IANJUTA_IS_FILE (assist->priv->iassist))
 		{
@@ -873,11 +974,11 @@ parser_cxx_assist_populate_language (IAnjutaLanguageProvider* self,
 		                              IANJUTA_EDITOR (assist->priv->iassist),
 		                              cursor, &start_iter, WORD_CHARACTER);
 		DEBUG_PRINT ("Preword: %s", pre_word);
-		if (pre_word && g_str_has_prefix (pre_word, assist->priv->pre_word))
+		if (pre_word && g_str_has_prefix (pre_word, assist->priv->cache_word))
 		{
 			DEBUG_PRINT ("Continue autocomplete for %s", pre_word);
 			
-			/* Great, we just continue the current completion */			
+			/* Great, we just re-rank the candidates of the current completion */
 			parser_cxx_assist_update_pre_word (assist, pre_word);
 			parser_cxx_assist_populate_real (assist, TRUE);
 			g_free (pre_word);
@@ -141,6 +141,196 @@ project_manager_save_session (ProjectManagerPlugin *plugin)
 	g_free (session_dir);
 }
 
+static void
+add_project_file (AnjutaProjectNode *node, gpointer data)
+{
+	GList **list = (GList **)data;
+
+	if ((anjuta_project_node_get_node_type (node) == ANJUTA_PROJECT_SOURCE) &&
+	    (anjuta_project_node_get_full_type (node) & ANJUTA_PROJECT_PROJECT))
+	{
+		*list = g_list_prepend (*list, node);
+	}
+}
+
+/* Return a string changing when the file is modified */
+static gchar *
+get_file_stamp (GFile *file)
+{
+	GFileInfo *info;
+	gchar *stamp;
+
+	info = g_file_query_info (file,
+	                          G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+	                          G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","
+	                          G_FILE_ATTRIBUTE_STANDARD_SIZE,
+	                          G_FILE_QUERY_INFO_NONE,
+	                          NULL, NULL);
+	if (info == NULL) return NULL;
+
+	stamp = g_strdup_printf ("%" G_GUINT64_FORMAT ".%u:%" G_GOFFSET_FORMAT,
+	                         g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+	                         g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC),
+	                         g_file_info_get_size (info));
+	g_object_unref (info);
+
+	return stamp;
+}
+
+/* Get the path of a node in the project view, the same format than
+ * gbf_project_view_get_snapshot */
+static gchar *
+get_node_path (AnjutaProjectNode *node)
+{
+	GString *str;
+
+	str = g_string_new (NULL);
+	for (; node != NULL; node = anjuta_project_node_parent (node))
+	{
+		/* Object and frame nodes are not displayed, a node below a frame
+		 * is described by its nearest displayed parent */
+		if (anjuta_project_node_get_node_type (node) == ANJUTA_PROJECT_OBJECT) continue;
+		if (anjuta_project_node_get_full_type (node) & ANJUTA_PROJECT_FRAME)
+		{
+			g_string_truncate (str, 0);
+			continue;
+		}
+
+		if (str->len != 0) g_string_prepend (str, "//");
+		g_string_prepend (str, anjuta_project_node_get_name (node));
+	}
+
+	return g_string_free (str, FALSE);
+}
+
+/* Save the project tree with the modification time of all project files
+ * (configure.ac, Makefile.am...) used to create it and the path of the node
+ * they describe */
+static void
+project_manager_save_snapshot (ProjectManagerPlugin *plugin, AnjutaSession *session)
+{
+	GList *files = NULL;
+	GList *list = NULL;
+	GList *item;
+
+	if ((plugin->project == NULL) || !plugin->project->loaded) return;
+
+	anjuta_project_node_foreach (anjuta_pm_project_get_root (plugin->project), G_PRE_ORDER, add_project_file, &files);
+	for (item = files; item != NULL; item = g_list_next (item))
+	{
+		AnjutaProjectNode *node = (AnjutaProjectNode *)item->data;
+		GFile *file;
+		gchar *stamp;
+		gchar *uri;
+		gchar *path;
+
+		file = anjuta_project_node_get_file (node);
+		stamp = get_file_stamp (file);
+		if (stamp == NULL) continue;
+		uri = anjuta_session_get_relative_uri_from_file (session, file, NULL);
+		path = get_node_path (anjuta_project_node_parent (node));
+		list = g_list_prepend (list, g_strconcat (stamp, " ", uri, " ", path, NULL));
+		g_free (path);
+		g_free (uri);
+		g_free (stamp);
+	}
+	g_list_free (files);
+	if (list == NULL) return;
+
+	anjuta_session_set_string_list (session, "Project Manager", "Snapshot Files", list);
+	g_list_foreach (list, (GFunc)g_free, NULL);
+	g_list_free (list);
+
+	list = gbf_project_view_get_snapshot (plugin->view);
+	anjuta_session_set_string_list (session, "Project Manager", "Snapshot", list);
+	g_list_foreach (list, (GFunc)g_free, NULL);
+	g_list_free (list);
+}
+
+/* Check if a saved node is below one of the modified nodes */
+static gboolean
+is_snapshot_node_stale (const gchar *name, GList *stale)
+{
+	GList *item;
+
+	for (item = stale; item != NULL; item = g_list_next (item))
+	{
+		const gchar *path = (const gchar *)item->data;
+		gsize len = strlen (path);
+
+		if ((len == 0) ||
+		    ((strncmp (name, path, len) == 0) && (name[len] == '/') && (name[len + 1] == '/')))
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/* Display the project tree saved in the session while the project is loading.
+ * The children of nodes described by a modified project file are skipped, the
+ * loaded tree replaces all nodes when available. The backend still parses
+ * the whole project, the saved tree is only displayed meanwhile. */
+static void
+project_manager_load_snapshot (ProjectManagerPlugin *plugin, AnjutaSession *session)
+{
+	GList *files;
+	GList *stale = NULL;
+	GList *list;
+	GList *item;
+
+	if ((plugin->project == NULL) || plugin->project->loaded) return;
+
+	files = anjuta_session_get_string_list (session, "Project Manager", "Snapshot Files");
+	if (files == NULL) return;
+	for (item = files; item != NULL; item = g_list_next (item))
+	{
+		gchar *saved = (gchar *)item->data;
+		gchar *uri;
+		gchar *path;
+		GFile *file;
+		gchar *stamp;
+
+		uri = strchr (saved, ' ');
+		path = uri != NULL ? strchr (uri + 1, ' ') : NULL;
+		if (path == NULL)
+		{
+			/* Unknown format, consider the whole tree as modified */
+			stale = g_list_prepend (stale, "");
+			continue;
+		}
+		*uri++ = '\0';
+		*path++ = '\0';
+
+		file = anjuta_session_get_file_from_relative_uri (session, uri, NULL);
+		stamp = get_file_stamp (file);
+		if (g_strcmp0 (stamp, saved) != 0) stale = g_list_prepend (stale, path);
+		g_free (stamp);
+		g_object_unref (file);
+	}
+
+	list = anjuta_session_get_string_list (session, "Project Manager", "Snapshot");
+	for (item = list; item != NULL;)
+	{
+		GList *next = g_list_next (item);
+
+		if (is_snapshot_node_stale ((const gchar *)item->data, stale))
+		{
+			g_free (item->data);
+			list = g_list_delete_link (list, item);
+		}
+		item = next;
+	}
+	gbf_project_view_set_snapshot (plugin->view, list);
+	g_list_foreach (list, (GFunc)g_free, NULL);
+	g_list_free (list);
+
+	g_list_free (stale);
+	g_list_foreach (files, (GFunc)g_free, NULL);
+	g_list_free (files);
+}
+
 static void
 on_session_save (AnjutaShell *shell, AnjutaSessionPhase phase,
 				 AnjutaSession *session, ProjectManagerPlugin *plugin)
@@ -185,6 +375,9 @@ on_session_save (AnjutaShell *shell, AnjutaSessionPhase phase,
 		g_list_free (list);
 	}
 
+	/* Save project tree */
+	if (plugin->session_by_me) project_manager_save_snapshot (plugin, session);
+
 }
 
 static void
@@ -200,6 +393,8 @@ on_session_load (AnjutaShell *shell, AnjutaSessionPhase phase, AnjutaSession *se
 	g_list_foreach (list, (GFunc)g_free, NULL);
 	g_list_free (list);
 
+	if (plugin->session_by_me) project_manager_load_snapshot (plugin, session);
+
 	list = anjuta_session_get_string_list (session, "Project Manager", "Expand");
 	gbf_project_view_set_expanded_list (GBF_PROJECT_VIEW (plugin->view), list);
 	g_list_foreach (list, (GFunc)g_free, NULL);
@@ -1323,6 +1323,126 @@ gbf_project_view_set_expanded_list (GbfProjectView *view, GList *expand)
 	return;
 }
 
+static gboolean
+save_snapshot_node (GtkTreeModel *model, GtkTreePath *path, GtkTreeIter *iter, gpointer user_data)
+{
+	GList **list = (GList **)user_data;
+	GString *str;
+	GtkTreeIter node;
+	GtkTreeIter child;
+
+	str = g_string_new (NULL);
+	node = *iter;
+	do
+	{
+		GbfTreeData *data;
+
+		child = node;
+		gtk_tree_model_get (model, &node,
+			GBF_PROJECT_MODEL_COLUMN_DATA, &data,
+			-1);
+
+		/* Keep only real nodes, not shortcuts */
+		if ((data == NULL) || (data->node == NULL) || (data->type == GBF_TREE_NODE_SHORTCUT) || data->is_shortcut)
+		{
+			g_string_free (str, TRUE);
+			return FALSE;
+		}
+
+		if (str->len != 0) g_string_prepend (str, "//");
+		g_string_prepend (str, anjuta_project_node_get_name (data->node));
+	}
+	while (gtk_tree_model_iter_parent (model, &node, &child));
+
+	*list = g_list_prepend (*list, str->str);
+	g_string_free (str, FALSE);
+
+	return FALSE;
+}
+
+/* Get the name of all nodes displayed in the tree, parents before children */
+GList *
+gbf_project_view_get_snapshot (GbfProjectView *view)
+{
+	GList *list = NULL;
+
+	gtk_tree_model_foreach (GTK_TREE_MODEL (view->model), save_snapshot_node, &list);
+	list = g_list_reverse (list);
+
+	return list;
+}
+
+/* Display nodes saved by gbf_project_view_get_snapshot using proxy nodes. They
+ * are replaced by the real nodes when the project is loaded */
+void
+gbf_project_view_set_snapshot (GbfProjectView *view, GList *nodes)
+{
+	GList *item;
+
+	for (item = g_list_first (nodes); item != NULL; item = g_list_next (item))
+	{
+		gchar *name = (gchar *)item->data;
+		gchar *end;
+		GtkTreeIter iter;
+		GtkTreeIter *parent = NULL;
+
+		do
+		{
+			end = strstr (name, "/" "/");   /* Avoid troubles with auto indent */
+			if (end != NULL) *end = '\0';
+			if (*name != '\0')
+			{
+				if (!gbf_project_model_find_child_name (view->model, &iter, parent, name))
+				{
+					GbfTreeData *data;
+
+					/* Create proxy node */
+					data = gbf_tree_data_new_proxy (name, FALSE);
+					gtk_tree_store_append (GTK_TREE_STORE (view->model), &iter, parent);
+					gtk_tree_store_set (GTK_TREE_STORE (view->model), &iter,
+							    GBF_PROJECT_MODEL_COLUMN_DATA, data,
+							    -1);
+				}
+				parent = &iter;
+			}
+			if (end != NULL)
+			{
+				*end = '/';
+				name = end + 2;
+			}
+		}
+		while (end != NULL);
+	}
+}
+
+/* Remove proxy nodes without a corresponding real node */
+static void
+gbf_project_view_remove_proxy (GbfProjectView *view, GtkTreeIter *parent)
+{
+	GtkTreeIter child;
+	gboolean valid;
+
+	valid = gtk_tree_model_iter_children (GTK_TREE_MODEL (view->model), &child, parent);
+	while (valid)
+	{
+		GbfTreeData *data;
+
+		gtk_tree_model_get (GTK_TREE_MODEL (view->model), &child,
+			GBF_PROJECT_MODEL_COLUMN_DATA, &data,
+			-1);
+
+		if ((data != NULL) && (data->type == GBF_TREE_NODE_UNKNOWN))
+		{
+			valid = gbf_project_model_remove (view->model, &child);
+		}
+		else
+		{
+			gbf_project_view_remove_proxy (view, &child);
+			valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (view->model), &child);
+		}
+	}
+}
+
 AnjutaProjectNode *
 gbf_project_view_get_node_from_iter (GbfProjectView *view, GtkTreeIter *iter)
 {
@@ -1441,6 +1561,9 @@ on_node_loaded (AnjutaPmProject *sender, AnjutaProjectNode *node, gboolean compl
 	{
 		// Add shortcut for all new primary targets
 		gbf_project_model_set_default_shortcut (view->model, TRUE);
+
+		// Remove stale nodes restored from the session
+		if (error == NULL) gbf_project_view_remove_proxy (view, NULL);
 	}
 }
 
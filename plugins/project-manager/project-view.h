@@ -94,6 +94,10 @@ void			gbf_project_view_set_shortcut_list (GbfProjectView *view,
 void			gbf_project_view_set_expanded_list (GbfProjectView *view,
 								GList   *expanded);
 
+GList			*gbf_project_view_get_snapshot (GbfProjectView *view);
+void			gbf_project_view_set_snapshot (GbfProjectView *view,
+								GList   *nodes);
+
 void			gbf_project_view_sort_shortcuts (GbfProjectView *view);
 
 void            gbf_project_view_update_tree (GbfProjectView *view,
@@ -24,6 +24,7 @@
 #include <libanjuta/anjuta-encodings.h>
 
 #define READ_SIZE 4096
+#define LARGE_READ_SIZE (1024 * 1024)
 #define RATE_LIMIT 5000 /* Use a big rate limit to avoid duplicates */
 #define TIMEOUT 5
 
@@ -57,6 +58,9 @@ sourceview_io_init (SourceviewIO *object)
 	object->monitor = NULL;
 	object->last_encoding = NULL;
 	object->bytes_read = 0;
+	object->large = FALSE;
+	object->loaded = 0;
+	object->ticks = 0;
 }
 
 static void
@@ -445,10 +449,169 @@ on_read_finished (GObject* input, GAsyncResult* result, gpointer data)
 	}
 }
 
+/* Insert a block of a large file at the end of the document, return the
+ * number of bytes used, the others are the beginning of a character */
+static gsize
+append_chunk (SourceviewIO* sio, const gchar* text, gsize size, gboolean last,
+              GError** error)
+{
+	GtkSourceBuffer* document = GTK_SOURCE_BUFFER (sio->sv->priv->document);
+	GtkTextIter end;
+	gchar* converted = NULL;
+	const gchar* insert = text;
+	gsize used = size;
+	gsize len = size;
+
+	if (sio->last_encoding == NULL)
+	{
+		const gchar* valid;
+
+		g_utf8_validate (text, size, &valid);
+		used = valid - text;
+		len = used;
+		if ((used < size) &&
+		    (last || (g_utf8_get_char_validated (valid, size - used) != (gunichar)-2)))
+		{
+			const AnjutaEncoding* enc = NULL;
+
+			/* Text is not utf-8, guess the encoding from the first invalid
+			 * block, the previous blocks are kept as utf-8 */
+			converted = anjuta_convert_to_utf8 (text, size, &enc, &len, NULL);
+			g_free (converted);
+			converted = NULL;
+			if (enc == NULL)
+				enc = anjuta_encoding_get_from_charset ("ISO-8859-15");
+			sio->last_encoding = enc;
+		}
+	}
+
+	if (sio->last_encoding != NULL)
+	{
+		const gchar* charset = anjuta_encoding_get_charset (sio->last_encoding);
+		GError* conv_error = NULL;
+
+		converted = g_convert (text, size, "UTF-8", charset, &used, &len, &conv_error);
+		if ((converted == NULL) && !last &&
+		    g_error_matches (conv_error, G_CONVERT_ERROR, G_CONVERT_ERROR_PARTIAL_INPUT))
+		{
+			/* Keep the incomplete character for the next block */
+			g_clear_error (&conv_error);
+			converted = g_convert (text, used, "UTF-8", charset, &used, &len, &conv_error);
+		}
+		if (converted == NULL)
+		{
+			g_propagate_error (error, conv_error);
+			return 0;
+		}
+		insert = converted;
+	}
+
+	gtk_source_buffer_begin_not_undoable_action (document);
+	gtk_text_buffer_get_end_iter (GTK_TEXT_BUFFER (document), &end);
+	gtk_text_buffer_insert (GTK_TEXT_BUFFER (document), &end, insert, len);
+	gtk_source_buffer_end_not_undoable_action (document);
+	g_free (converted);
+
+	sio->loaded += used;
+
+	return used;
+}
+
+static void
+update_progress (SourceviewIO* sio, gboolean done)
+{
+	AnjutaShell* shell = ANJUTA_PLUGIN (sio->sv->priv->plugin)->shell;
+	AnjutaStatus* status = anjuta_shell_get_status (shell, NULL);
+
+	if (sio->ticks == 0)
+		return;
+
+	if (done)
+	{
+		anjuta_status_progress_increment_ticks (status, sio->ticks, NULL);
+		sio->ticks = 0;
+	}
+	else if (sio->ticks > 1)
+	{
+		gchar* text = g_strdup_printf (_("Loading %s"),
+		                              sourceview_io_get_filename (sio));
+
+		anjuta_status_progress_tick (status, NULL, text);
+		g_free (text);
+		sio->ticks--;
+	}
+}
+
+static void
+on_large_read_finished (GObject* input, GAsyncResult* result, gpointer data)
+{
+	SourceviewIO* sio = SOURCEVIEW_IO(data);
+	GInputStream* input_stream = G_INPUT_STREAM(input);
+	gsize current_bytes = 0;
+	gsize used = 0;
+	GError* err = NULL;
+
+	current_bytes = g_input_stream_read_finish (input_stream, result, &err);
+	if (!err)
+	{
+		sio->bytes_read += current_bytes;
+		used = append_chunk (sio, sio->read_buffer, sio->bytes_read,
+		                     current_bytes == 0, &err);
+	}
+	if (err)
+	{
+		GtkSourceBuffer* document = GTK_SOURCE_BUFFER (sio->sv->priv->document);
+
+		/* Remove the part already loaded */
+		update_progress (sio, TRUE);
+		gtk_source_buffer_begin_not_undoable_action (document);
+		gtk_text_buffer_set_text (GTK_TEXT_BUFFER (document), "", 0);
+		gtk_source_buffer_end_not_undoable_action (document);
+		gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (document), FALSE);
+		sio->loaded = 0;
+		g_signal_emit_by_name (sio, "open-failed", err);
+		g_error_free (err);
+		g_object_unref (input_stream);
+		g_free (sio->read_buffer);
+		sio->read_buffer = NULL;
+		sio->bytes_read = 0;
+		return;
+	}
+
+	/* Move the beginning of the next character at the start */
+	sio->bytes_read -= used;
+	memmove (sio->read_buffer, sio->read_buffer + used, sio->bytes_read);
+
+	if (current_bytes != 0)
+	{
+		update_progress (sio, FALSE);
+		sio->read_buffer = g_realloc (sio->read_buffer, sio->bytes_read + LARGE_READ_SIZE);
+		g_input_stream_read_async (G_INPUT_STREAM (input_stream),
+								   sio->read_buffer + sio->bytes_read,
+								   LARGE_READ_SIZE,
+								   G_PRIORITY_LOW,
+								   sio->cancel,
+								   on_large_read_finished,
+								   sio);
+	}
+	else
+	{
+		update_progress (sio, TRUE);
+		gtk_text_buffer_set_modified (GTK_TEXT_BUFFER (sio->sv->priv->document), FALSE);
+		g_signal_emit_by_name (sio, "open-finished");
+		sio->bytes_read = 0;
+		g_object_unref (input_stream);
+		setup_monitor (sio);
+		g_free (sio->read_buffer);
+		sio->read_buffer = NULL;
+	}
+}
+
 void
 sourceview_io_open (SourceviewIO* sio, GFile* file)
 {
 	GFileInputStream* input_stream;
+	GFileInfo* file_info;
 	GError* err = NULL;
 
 	g_return_if_fail (file != NULL);
@@ -466,6 +629,45 @@ sourceview_io_open (SourceviewIO* sio, GFile* file)
 		g_error_free (err);
 		return;
 	}
+
+	/* Load large files by blocks, inserting them without highlighting */
+	sio->large = FALSE;
+	file_info = g_file_input_stream_query_info (input_stream,
+	                                            G_FILE_ATTRIBUTE_STANDARD_SIZE,
+	                                            NULL,
+	                                            NULL);
+	if (file_info)
+	{
+		goffset size = g_file_info_get_size (file_info);
+		gint limit = g_settings_get_int (sio->sv->priv->settings, "large-file-size");
+
+		if ((limit > 0) && (size >= (goffset)limit * 1024 * 1024))
+		{
+			AnjutaShell* shell = ANJUTA_PLUGIN (sio->sv->priv->plugin)->shell;
+
+			sio->large = TRUE;
+			sio->loaded = 0;
+			sio->last_encoding = NULL;
+			sio->ticks = size / LARGE_READ_SIZE + 1;
+			anjuta_status_progress_add_ticks (anjuta_shell_get_status (shell, NULL),
+			                                  sio->ticks);
+		}
+		g_object_unref (file_info);
+	}
+	if (sio->large)
+	{
+		gtk_source_buffer_set_language (GTK_SOURCE_BUFFER (sio->sv->priv->document), NULL);
+		sio->read_buffer = g_realloc (sio->read_buffer, LARGE_READ_SIZE);
+		g_input_stream_read_async (G_INPUT_STREAM (input_stream),
+								   sio->read_buffer,
+								   LARGE_READ_SIZE,
+								   G_PRIORITY_LOW,
+								   sio->cancel,
+								   on_large_read_finished,
+								   sio);
+		return;
+	}
+
 	sio->read_buffer = g_realloc (sio->read_buffer, READ_SIZE);
 	g_input_stream_read_async (G_INPUT_STREAM (input_stream),
 							   sio->read_buffer,
@@ -555,6 +757,12 @@ sourceview_io_get_read_only (SourceviewIO* sio)
 	return retval;
 }
 
+gboolean
+sourceview_io_is_large (SourceviewIO* sio)
+{
+	return sio->large;
+}
+
 SourceviewIO*
 sourceview_io_new (Sourceview* sv)
 {
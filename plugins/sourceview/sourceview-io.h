@@ -64,6 +64,11 @@ struct _SourceviewIO
 	guint monitor_idle;
 	gssize bytes_read;
 
+	/* Large files are loaded progressively */
+	gboolean large;
+	goffset loaded;
+	gint ticks;
+
 	const AnjutaEncoding* last_encoding;
 };
 
@@ -77,6 +82,7 @@ const gchar* sourceview_io_get_filename (SourceviewIO* sio);
 void sourceview_io_set_filename (SourceviewIO* sio, const gchar* filename);
 gchar* sourceview_io_get_mime_type (SourceviewIO* sio);
 gboolean sourceview_io_get_read_only (SourceviewIO* sio);
+gboolean sourceview_io_is_large (SourceviewIO* sio);
 SourceviewIO* sourceview_io_new (Sourceview* sv);
 
 G_END_DECLS
@@ -57,6 +57,9 @@ struct SourceviewPrivate {
 	/* Editor window */
 	GtkWidget* window;
 
+	/* Large file, without highlighting and assistance */
+	gboolean large_file;
+
 	/* Goto line hack */
 	gboolean loading;
 	gint goto_line;
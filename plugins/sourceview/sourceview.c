@@ -298,7 +298,7 @@ on_insert_text (GtkTextBuffer *buffer,
 	/* Update the status bar */
 	g_signal_emit_by_name (G_OBJECT (sv), "update-ui");
 
-	if (len <= 1 && strlen (text) <= 1)
+	if (len <= 1 && strlen (text) <= 1 && !sv->priv->large_file)
 	{
 		/* Send the "char-added" signal and revalidate the iterator */
 		g_signal_emit_by_name (G_OBJECT (sv), "char-added", iter, text[0]);
@@ -629,6 +629,11 @@ on_open_failed (SourceviewIO* io, GError* err, Sourceview* sv)
 	GList* documents = ianjuta_document_manager_get_doc_widgets (docman, NULL);
 	GtkWidget* message_area;
 
+	/* Reset the state before displaying the error, the dialog runs a
+	 * main loop */
+	sv->priv->loading = FALSE;
+	gtk_text_view_set_editable (GTK_TEXT_VIEW (sv->priv->view), TRUE);
+
 	/* Could not open <filename>: <error message> */
 	gchar* message = g_strdup_printf (_("Could not open %s: %s"),
 									  sourceview_io_get_filename (sv->priv->io),
@@ -654,8 +659,6 @@ on_open_failed (SourceviewIO* io, GError* err, Sourceview* sv)
 		gtk_dialog_run (GTK_DIALOG (dialog));
 	}
 	g_free (message);
-	sv->priv->loading = FALSE;
-	gtk_text_view_set_editable (GTK_TEXT_VIEW (sv->priv->view), TRUE);
 
 	/* Get rid of reference from ifile_open */
 	g_object_unref(G_OBJECT(sv));
@@ -722,6 +725,19 @@ on_open_finish(SourceviewIO* io, Sourceview* sv)
 	anjuta_view_scroll_to_cursor(sv->priv->view);
 	sv->priv->loading = FALSE;
 
+	/* Disable completion and per character assistance on large files */
+	if (sourceview_io_is_large (io) != sv->priv->large_file)
+	{
+		GtkSourceCompletion* completion =
+			gtk_source_view_get_completion (GTK_SOURCE_VIEW (sv->priv->view));
+
+		sv->priv->large_file = sourceview_io_is_large (io);
+		if (sv->priv->large_file)
+			gtk_source_completion_block_interactive (completion);
+		else
+			gtk_source_completion_unblock_interactive (completion);
+	}
+
 	/* Autodetect language */
 	ianjuta_editor_language_set_language(IANJUTA_EDITOR_LANGUAGE(sv), NULL, NULL);
 
@@ -2109,6 +2125,10 @@ autodetect_language (Sourceview* sv)
 	GtkSourceLanguage *language;
 	const gchar* detected_language = NULL;
 
+	/* Large files are not highlighted */
+	if (sv->priv->large_file)
+		goto out;
+
 	language = gtk_source_language_manager_guess_language (gtk_source_language_manager_get_default (), filename, io_mime_type);
 	if (!language)
 	{
@@ -1217,10 +1217,14 @@ sdb_engine_timeout_trigger_signals (gpointer user_data)
 static void
 sdb_engine_ctags_output_callback_1 (AnjutaLauncher * launcher,
 								  AnjutaLauncherOutputType output_type,
-								  const gchar * chars, gpointer user_data)
+								  const gchar * const *lines, guint n_lines,
+								  gpointer user_data)
 {
 	SymbolDBEngine *dbe = (SymbolDBEngine *) user_data;
 	SymbolDBEnginePriv *priv;
+	gchar *chars, *chars_ptr;
+	gsize len;
+	guint i;
 
 	g_return_if_fail (user_data != NULL);
 	
@@ -1229,7 +1233,19 @@ sdb_engine_ctags_output_callback_1 (AnjutaLauncher * launcher,
 	if (priv->shutting_down == TRUE)
 		return;
 
-	g_thread_pool_push (priv->thread_pool, g_strdup (chars), NULL);
+	/* Pass all the lines read at once to the thread with a single copy */
+	len = 0;
+	for (i = 0; i < n_lines; i++)
+		len += strlen (lines[i]) + 1;
+	chars = chars_ptr = g_new (gchar, len + 1);
+	for (i = 0; i < n_lines; i++)
+	{
+		chars_ptr = g_stpcpy (chars_ptr, lines[i]);
+		*chars_ptr++ = '\n';
+	}
+	*chars_ptr = '\0';
+
+	g_thread_pool_push (priv->thread_pool, chars, NULL);
 	
 	/* signals monitor */
 	if (priv->timeout_trigger_handler <= 0)
@@ -1285,7 +1301,7 @@ sdb_engine_ctags_launcher_create (SymbolDBEngine * dbe)
 								  "--filter=yes --filter-terminator='"CTAGS_MARKER"'",
 								  priv->ctags_path);
 	DEBUG_PRINT ("Launching %s", exe_string);
-	anjuta_launcher_execute (priv->ctags_launcher,
+	anjuta_launcher_execute_lines (priv->ctags_launcher,
 								 exe_string, sdb_engine_ctags_output_callback_1, 
 								 dbe);
 	g_free (exe_string);
@@ -348,12 +348,92 @@ on_message_buffer_flush (IAnjutaMessageView *view, const gchar *msg_line,
 	g_free (line);
 }
 
+/* Create message view if needed */
+static void
+atp_output_context_create_view (ATPOutputContext *this)
+{
+	const gchar* str;
+
+	/* Check if the view has already been created */
+	if (this->created == FALSE)
+	{
+		IAnjutaMessageManager *man;
+		gchar* title  = this->execution->name;
+
+		man = anjuta_shell_get_interface (this->execution->plugin->shell,
+										  IAnjutaMessageManager, NULL);
+		if (this->view == NULL)
+		{
+			this->view = ianjuta_message_manager_add_view (man, title,
+														   ICON_FILE,
+														   NULL);
+			g_signal_connect (G_OBJECT (this->view), "buffer_flushed",
+						  G_CALLBACK (on_message_buffer_flush), this);
+			g_signal_connect (G_OBJECT (this->view), "message_clicked",
+						  G_CALLBACK (on_message_buffer_click), this);
+			g_object_add_weak_pointer (G_OBJECT (this->view),
+									   (gpointer *)(gpointer)&this->view);
+		}
+		else
+		{
+			ianjuta_message_view_clear (this->view, NULL);
+		}
+		if (this->execution->error.type == ATP_TOUT_SAME)
+		{
+			/* Same message used for all outputs */
+			str = "";
+		}
+		else if (this == &this->execution->output)
+		{
+			/* This is append to the tool name to give something
+			 * like "My tools (output)". It's used to name the message
+			 * pane where the output of the tool is send to
+			 */
+			str = _("(output)");
+		}
+		else
+		{
+			/* This is append to the tool name to give something
+			 * like "My tools (error)". It's used to name the message
+			 * pane where the errors of the tool is send to
+			 */
+			str = _("(error)");
+		}
+		title = g_strdup_printf ("%s %s", this->execution->name, str);
+		
+		ianjuta_message_manager_set_view_title (man, this->view,
+												title, NULL);
+		g_free (title);
+		this->created = TRUE;
+	}
+}
+
+/* Return TRUE if the output is displayed only in a message view */
+static gboolean
+atp_output_context_is_message (ATPOutputContext *this)
+{
+	if (this->type == ATP_TOUT_SAME)
+	{
+		/* Valid for error output only, get output type
+		 * from standard output */
+		this = &this->execution->output;
+	}
+
+	switch (this->type)
+	{
+	case ATP_TOUT_NULL:
+	case ATP_TOUT_COMMON_PANE:
+	case ATP_TOUT_NEW_PANE:
+		return TRUE;
+	default:
+		return FALSE;
+	}
+}
+
 /* Handle output for stdout and stderr */
 static gboolean
 atp_output_context_print (ATPOutputContext *this, const gchar* text)
 {
-	const gchar* str;
-
 	if (this->type == ATP_TOUT_SAME)
 	{
 		/* Valid for error output only, get output type
@@ -371,58 +451,7 @@ atp_output_context_print (ATPOutputContext *this, const gchar* text)
 		break;
 	case ATP_TOUT_COMMON_PANE:
 	case ATP_TOUT_NEW_PANE:
-		/* Check if the view has already been created */
-		if (this->created == FALSE)
-		{
-			IAnjutaMessageManager *man;
-			gchar* title  = this->execution->name;
-
-			man = anjuta_shell_get_interface (this->execution->plugin->shell,
-											  IAnjutaMessageManager, NULL);
-			if (this->view == NULL)
-			{
-				this->view = ianjuta_message_manager_add_view (man, title,
-															   ICON_FILE,
-															   NULL);
-				g_signal_connect (G_OBJECT (this->view), "buffer_flushed",
-							  G_CALLBACK (on_message_buffer_flush), this);
-				g_signal_connect (G_OBJECT (this->view), "message_clicked",
-							  G_CALLBACK (on_message_buffer_click), this);
-				g_object_add_weak_pointer (G_OBJECT (this->view),
-										   (gpointer *)(gpointer)&this->view);
-			}
-			else
-			{
-				ianjuta_message_view_clear (this->view, NULL);
-			}
-			if (this->execution->error.type == ATP_TOUT_SAME)
-			{
-				/* Same message used for all outputs */
-				str = "";
-			}
-			else if (this == &this->execution->output)
-			{
-				/* This is append to the tool name to give something
-				 * like "My tools (output)". It's used to name the message
-				 * pane where the output of the tool is send to
-				 */
-				str = _("(output)");
-			}
-			else
-			{
-				/* This is append to the tool name to give something
-				 * like "My tools (error)". It's used to name the message
-				 * pane where the errors of the tool is send to
-				 */
-				str = _("(error)");
-			}
-			title = g_strdup_printf ("%s %s", this->execution->name, str);
-			
-			ianjuta_message_manager_set_view_title (man, this->view,
-													title, NULL);
-			g_free (title);
-			this->created = TRUE;
-		}
+		atp_output_context_create_view (this);
 		/* Display message */
 		if (this->view)
 		{
@@ -450,6 +479,33 @@ atp_output_context_print (ATPOutputContext *this, const gchar* text)
 	return TRUE;
 }
 
+/* Handle complete lines for stdout and stderr */
+static gboolean
+atp_output_context_print_lines (ATPOutputContext *this,
+								const gchar * const *lines, guint n_lines)
+{
+	guint i;
+
+	if (this->type == ATP_TOUT_SAME)
+	{
+		/* Valid for error output only, get output type
+		 * from standard output */
+		this = &this->execution->output;
+	}
+
+	/* Lines are used only when the output goes in message views */
+	if (this->type == ATP_TOUT_NULL) return TRUE;
+
+	atp_output_context_create_view (this);
+	/* Display lines directly, they are already split */
+	for (i = 0; (i < n_lines) && (this->view != NULL); i++)
+	{
+		on_message_buffer_flush (this->view, lines[i], this);
+	}
+
+	return TRUE;
+}
+
 /* Write a small message at the beginning use only on stdout */
 static gboolean
 atp_output_context_print_command (ATPOutputContext *this, const gchar* command)
@@ -732,6 +788,25 @@ on_run_output (AnjutaLauncher* launcher, AnjutaLauncherOutputType type,
 	}
 }
 
+static void
+on_run_lines (AnjutaLauncher* launcher, AnjutaLauncherOutputType type,
+			  const gchar * const *lines, guint n_lines, gpointer user_data)
+{
+	ATPExecutionContext* this = (ATPExecutionContext*)user_data;
+
+	switch (type)
+	{
+	case ANJUTA_LAUNCHER_OUTPUT_STDOUT:
+		atp_output_context_print_lines (&this->output, lines, n_lines);
+		break;
+	case ANJUTA_LAUNCHER_OUTPUT_STDERR:
+		atp_output_context_print_lines (&this->error, lines, n_lines);
+		break;
+	case ANJUTA_LAUNCHER_OUTPUT_PTY:
+		break;
+	}
+}
+
 static ATPExecutionContext*
 atp_execution_context_reuse (ATPExecutionContext* this, const gchar *name,
 							 ATPOutputType output, ATPOutputType error)
@@ -817,8 +892,16 @@ atp_execution_context_execute (ATPExecutionContext* this,
 		prev_dir = anjuta_util_get_current_dir();
 		chdir (this->directory);
 	}
-	/* Execute */
-	anjuta_launcher_execute (this->launcher, command, on_run_output, this);
+	/* Execute, message views need only complete lines */
+	if (atp_output_context_is_message (&this->output) &&
+		atp_output_context_is_message (&this->error))
+	{
+		anjuta_launcher_execute_lines (this->launcher, command, on_run_lines, this);
+	}
+	else
+	{
+		anjuta_launcher_execute (this->launcher, command, on_run_output, this);
+	}
 	/* Restore previous current directory */
 	if (this->directory != NULL)
 	{